@@ -0,0 +1,69 @@
+#pragma once
+#include <crypto++/drbg.h>
+#include <crypto++/osrng.h>
+#include <crypto++/sha.h>
+
+#include <array>
+#include <cstddef>
+
+namespace shaiya::crypto
+{
+    /**
+     * A cryptographically secure random number generator for the calling thread. Each thread owns a Hash_DRBG, which is
+     * seeded once from the operating system when the thread first uses it, so generating keys and blinding values
+     * neither reseeds from the operating system each time nor contends on a shared generator.
+     */
+    class SecureRandom
+    {
+    public:
+        /**
+         * Gets the generator for the calling thread.
+         * @return  The generator.
+         */
+        static CryptoPP::RandomNumberGenerator& the()
+        {
+            static thread_local SecureRandom random;
+            return random.drbg_;
+        }
+
+    private:
+        /**
+         * The number of bytes of entropy used to instantiate a generator.
+         */
+        static constexpr size_t ENTROPY_SIZE = 32;
+
+        /**
+         * The number of bytes of the nonce used to instantiate a generator.
+         */
+        static constexpr size_t NONCE_SIZE = 16;
+
+        /**
+         * Seeds the generator for the calling thread.
+         */
+        SecureRandom(): seed_(generateSeed()), drbg_(seed_.data(), ENTROPY_SIZE, seed_.data() + ENTROPY_SIZE, NONCE_SIZE)
+        {
+            seed_.fill(0);
+        }
+
+        /**
+         * Generates the entropy and nonce of a generator, from the operating system.
+         * @return  The seed.
+         */
+        static std::array<CryptoPP::byte, ENTROPY_SIZE + NONCE_SIZE> generateSeed()
+        {
+            std::array<CryptoPP::byte, ENTROPY_SIZE + NONCE_SIZE> seed{ 0 };
+            CryptoPP::OS_GenerateRandomBlock(false, seed.data(), seed.size());
+            return seed;
+        }
+
+        /**
+         * The seed of the generator, which is wiped once the generator has been instantiated.
+         */
+        std::array<CryptoPP::byte, ENTROPY_SIZE + NONCE_SIZE> seed_;
+
+        /**
+         * The generator.
+         */
+        CryptoPP::Hash_DRBG<CryptoPP::SHA256> drbg_;
+    };
+}
@@ -0,0 +1,315 @@
+#pragma once
+#include <shaiya/common/db/QueryResult.hpp>
+
+#include <boost/asio.hpp>
+#include <pqxx/pqxx>
+
+#include <chrono>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Forward declaration of the libpq connection
+struct pg_conn;
+
+namespace shaiya::database
+{
+    /**
+     * A database service that executes queries without blocking the calling thread. Each connection is put in libpq's
+     * non-blocking mode, and its socket is watched by an asio event loop, so a single thread can drive every in-flight
+     * query. Query completions are delivered through an asio completion token, which allows callers to receive the
+     * result with a callback, a future or an awaitable.
+     *
+     * A connection that breaks, or whose query exceeds the query timeout, is closed and reopened in the background with
+     * an exponential backoff, without blocking the event loop. Its prepared statements are prepared again before it
+     * executes any other query. While no connection is open, queued queries fail straight away rather than waiting.
+     */
+    class AsyncDatabaseService
+    {
+    public:
+        /**
+         * The signature of a query completion.
+         */
+        using Signature = void(std::exception_ptr, QueryResult);
+
+        /**
+         * Initialises the database service, and starts the event loop thread.
+         * @param address       The database address
+         * @param database      The database name
+         * @param username      The name of the user
+         * @param password      The password of the user
+         * @param connections   The number of connections to open
+         * @param queryTimeout  The time a query may take before its connection is presumed to have failed
+         */
+        AsyncDatabaseService(const std::string& address, const std::string& database, const std::string& username,
+                             const std::string& password, size_t connections,
+                             std::chrono::milliseconds queryTimeout = std::chrono::milliseconds(10000));
+
+        /**
+         * Stops the event loop thread, fails the queries that haven't completed, and closes the connections.
+         */
+        ~AsyncDatabaseService();
+
+        /**
+         * Prepares a statement on every connection. This blocks, and must be called before any queries are executed. The
+         * statement is remembered, so it can be prepared again on connections that are reopened.
+         * @param name          The name of the statement
+         * @param statement     The statement body.
+         */
+        void prepare(const std::string& name, const std::string& statement);
+
+        /**
+         * Executes a prepared statement.
+         * @param name      The name of the statement
+         * @param params    The statement parameters, in their text format
+         * @param token     The completion token, such as a callback, boost::asio::use_future or boost::asio::use_awaitable
+         * @return          The result of initiating the operation, as determined by the completion token
+         */
+        template<typename CompletionToken>
+        auto execute(std::string name, std::vector<std::string> params, CompletionToken&& token)
+        {
+            auto initiation = [this](auto handler, std::string name, std::vector<std::string> params) {
+                // The completion is delivered on the executor associated with the handler, such as the executor
+                // of a coroutine, or on this service's event loop if the handler doesn't have one.
+                auto executor = boost::asio::get_associated_executor(handler, context_.get_executor());
+                auto shared   = std::make_shared<decltype(handler)>(std::move(handler));
+                auto complete = [shared, executor](std::exception_ptr error, QueryResult result) {
+                    boost::asio::post(executor, [shared, error, result = std::move(result)]() mutable {
+                        (*shared)(error, std::move(result));
+                    });
+                };
+                submit({ std::move(name), std::move(params), std::move(complete) });
+            };
+            return boost::asio::async_initiate<CompletionToken, Signature>(initiation, token, std::move(name),
+                                                                           std::move(params));
+        }
+
+        /**
+         * Converts values to the text format of statement parameters.
+         * @tparam Args The types of the values.
+         * @param args  The values.
+         * @return      The statement parameters.
+         */
+        template<typename... Args>
+        static std::vector<std::string> params(const Args&... args)
+        {
+            return { pqxx::to_string(args)... };
+        }
+
+    private:
+        /**
+         * A query that is waiting to be executed, or is being executed.
+         */
+        struct Query
+        {
+            /**
+             * The name of the prepared statement.
+             */
+            std::string name;
+
+            /**
+             * The statement parameters.
+             */
+            std::vector<std::string> params;
+
+            /**
+             * The function that delivers the completion of the query.
+             */
+            std::function<Signature> complete;
+
+            /**
+             * The body of the statement to prepare, which is only set when this query prepares a statement.
+             */
+            std::string statement;
+        };
+
+        /**
+         * A connection in non-blocking mode, with the socket that asio waits on.
+         */
+        struct Connection
+        {
+            /**
+             * Initialises the connection.
+             * @param context   The event loop.
+             */
+            explicit Connection(boost::asio::io_context& context): socket(context), timer(context)
+            {
+            }
+
+            /**
+             * The libpq connection.
+             */
+            pg_conn* conn{ nullptr };
+
+            /**
+             * A duplicate of the connection's socket, which asio owns and watches for readiness.
+             */
+            boost::asio::posix::stream_descriptor socket;
+
+            /**
+             * The timer of the active query's deadline, or of the delay before the connection is reopened.
+             */
+            boost::asio::steady_timer timer;
+
+            /**
+             * If the connection is open, and may execute queries.
+             */
+            bool open{ false };
+
+            /**
+             * Incremented whenever a query is sent, or the connection is reset or reopened. The socket and timer
+             * callbacks compare it to know that they belong to an earlier query, or an earlier incarnation of the
+             * connection, and are stale.
+             */
+            size_t generation{ 0 };
+
+            /**
+             * The delay before the next attempt to reopen the connection.
+             */
+            std::chrono::milliseconds backoff{ 0 };
+
+            /**
+             * The statements that must be prepared on the connection before it executes any other query.
+             */
+            std::deque<Query> setup;
+
+            /**
+             * The query that is being executed on this connection.
+             */
+            std::unique_ptr<Query> active;
+
+            /**
+             * The result of the active query.
+             */
+            QueryResult result;
+
+            /**
+             * The error of the active query, if it failed.
+             */
+            std::string error;
+        };
+
+        /**
+         * Queues a query, to be executed on the next idle connection.
+         * @param query The query.
+         */
+        void submit(Query query);
+
+        /**
+         * Starts executing queued queries on the idle connections. This must be called on the event loop.
+         */
+        void dispatch();
+
+        /**
+         * Sends the active query of a connection.
+         * @param connection    The connection.
+         */
+        void send(Connection& connection);
+
+        /**
+         * Flushes the outgoing data of a connection, and waits for the result once it has been sent.
+         * @param connection    The connection.
+         */
+        void flush(Connection& connection);
+
+        /**
+         * Waits for a connection's socket to become readable, and consumes the results that have arrived.
+         * @param connection    The connection.
+         */
+        void receive(Connection& connection);
+
+        /**
+         * Completes the active query of a connection, and starts the next queued query.
+         * @param connection    The connection.
+         */
+        void complete(Connection& connection);
+
+        /**
+         * Fails the active query of a connection, and resets the connection if it has broken.
+         * @param connection    The connection.
+         * @param error         The error message.
+         */
+        void fail(Connection& connection, const std::string& error);
+
+        /**
+         * Fails every queued query, if no connection is open to execute them. This must be called on the event loop.
+         */
+        void failQueuedIfDisconnected();
+
+        /**
+         * Closes a connection, and schedules it to be reopened after its backoff delay.
+         * @param connection    The connection.
+         */
+        void reset(Connection& connection);
+
+        /**
+         * Starts reopening a connection, without blocking the event loop.
+         * @param connection    The connection.
+         */
+        void reconnect(Connection& connection);
+
+        /**
+         * Waits for the socket of a connection that is being reopened to become ready, and then advances the reopening.
+         * @param connection    The connection.
+         * @param writing       If the socket must become writable, rather than readable.
+         */
+        void poll(Connection& connection, bool writing);
+
+        /**
+         * Opens a connection, and puts it in non-blocking mode. This blocks, and is only used on startup.
+         * @param connection    The connection.
+         */
+        void open(Connection& connection);
+
+        /**
+         * Marks a connection as open, and queues the remembered statements to be prepared on it.
+         * @param connection    The connection.
+         */
+        void opened(Connection& connection);
+
+        /**
+         * The connection string.
+         */
+        std::string connectionString_;
+
+        /**
+         * The time a query may take before its connection is presumed to have failed.
+         */
+        std::chrono::milliseconds queryTimeout_;
+
+        /**
+         * The prepared statements, by name, which are prepared again on reopened connections.
+         */
+        std::vector<std::pair<std::string, std::string>> statements_;
+
+        /**
+         * The event loop.
+         */
+        boost::asio::io_context context_;
+
+        /**
+         * Keeps the event loop running while it has no work.
+         */
+        boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work_;
+
+        /**
+         * The connections.
+         */
+        std::vector<std::unique_ptr<Connection>> connections_;
+
+        /**
+         * The queries that are waiting for an idle connection.
+         */
+        std::deque<Query> queue_;
+
+        /**
+         * The thread that runs the event loop.
+         */
+        std::thread thread_;
+    };
+}
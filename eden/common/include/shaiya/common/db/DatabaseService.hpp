@@ -1,13 +1,50 @@
 #pragma once
+#include <shaiya/common/util/LatencyHistogram.hpp>
 
+#include <chrono>
 #include <condition_variable>
+#include <deque>
+#include <memory>
 #include <mutex>
 #include <pqxx/pqxx>
-#include <queue>
+#include <shared_mutex>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace shaiya::database
 {
+    /**
+     * The sizing and timeout options of the database connection pool.
+     */
+    struct PoolOptions
+    {
+        /**
+         * The number of connections that are kept open, even while they are idle.
+         */
+        size_t minConnections{ 4 };
+
+        /**
+         * The maximum number of connections that may be open at once.
+         */
+        size_t maxConnections{ 16 };
+
+        /**
+         * The maximum time to wait for a connection to become available.
+         */
+        std::chrono::milliseconds checkoutTimeout{ 5000 };
+
+        /**
+         * The time a connection may be idle before it is health-checked on checkout.
+         */
+        std::chrono::milliseconds healthCheckInterval{ 30000 };
+
+        /**
+         * The time a connection above the minimum may be idle before it is closed.
+         */
+        std::chrono::milliseconds idleTimeout{ 60000 };
+    };
+
     /**
      * The database service is a utility class which provides access to the PostgreSQL
      * database connection.
@@ -21,29 +58,126 @@ namespace shaiya::database
          * @param database  The database name
          * @param username  The name of the user
          * @param password  The password of the user
+         * @param options   The connection pool options
          */
         DatabaseService(const std::string& address, const std::string& database, const std::string& username,
-                        const std::string& password);
+                        const std::string& password, PoolOptions options = {});
 
         /**
-         * Prepares a statement
+         * Prepares a statement. The statement is prepared on every connection, including connections that are opened
+         * later.
          * @param name          The name of the statement
          * @param statement     The statement body.
          */
         void prepare(const std::string& name, const std::string& statement);
 
         /**
-         * Creates a new connection
-         * @return  The connection
+         * Checks out a connection, waiting for up to the checkout timeout of the pool.
+         * @return  The connection, which is returned to the pool when it is released
          */
         std::shared_ptr<pqxx::connection> connection();
 
-    public:
         /**
-         * Initialises the connection pool
+         * Checks out a connection.
+         * @param timeout   The maximum time to wait for a connection to become available
+         * @return          The connection, which is returned to the pool when it is released
+         */
+        std::shared_ptr<pqxx::connection> connection(std::chrono::milliseconds timeout);
+
+        /**
+         * Executes a prepared statement, and records its latency.
+         * @param tx    The transaction to execute the statement in
+         * @param name  The name of the statement
+         * @param args  The statement parameters
+         * @return      The result
+         */
+        template<typename... Args>
+        pqxx::result execute(pqxx::transaction_base& tx, const std::string& name, Args&&... args)
+        {
+            auto start  = std::chrono::steady_clock::now();
+            auto result = tx.exec_prepared(name, std::forward<Args>(args)...);
+            record(name, std::chrono::steady_clock::now() - start);
+            return result;
+        }
+
+        /**
+         * Records the latency of a statement.
+         * @param name      The name of the statement
+         * @param latency   The latency
+         */
+        void record(const std::string& name, std::chrono::nanoseconds latency);
+
+        /**
+         * Summarises the state of the pool, and the latency of each statement.
+         * @return  The summary
+         */
+        std::string report();
+
+    private:
+        /**
+         * A connection that is owned by the pool.
+         */
+        struct PooledConnection
+        {
+            /**
+             * The connection.
+             */
+            std::unique_ptr<pqxx::connection> connection;
+
+            /**
+             * The number of statements that have been prepared on this connection.
+             */
+            size_t prepared{ 0 };
+
+            /**
+             * The time at which this connection was last returned to the pool.
+             */
+            std::chrono::steady_clock::time_point idleSince{ std::chrono::steady_clock::now() };
+        };
+
+        /**
+         * Opens a new connection.
+         * @return  The connection
+         */
+        std::unique_ptr<PooledConnection> open();
+
+        /**
+         * Checks if an idle connection can still be used. Connections that have been idle for longer than the health
+         * check interval are probed with a trivial query.
+         * @param pooled    The connection
+         * @return          If the connection is healthy
+         */
+        bool healthy(PooledConnection& pooled);
+
+        /**
+         * Prepares the statements that haven't yet been prepared on a connection. This must be called while holding the
+         * pool mutex.
+         * @param pooled    The connection
+         */
+        void prepareStatements(PooledConnection& pooled);
+
+        /**
+         * Closes the idle connections above the minimum pool size that have been idle for longer than the idle timeout.
+         * This must be called while holding the pool mutex.
+         */
+        void reapIdleConnections();
+
+        /**
+         * Gets the latency histogram of a statement, creating it if necessary.
+         * @param name  The name of the statement
+         * @return      The histogram
+         */
+        LatencyHistogram& histogram(const std::string& name);
+
+        /**
+         * The connection string
          */
-        void createPool(const std::string& address, const std::string& database, const std::string& username,
-                        const std::string& password);
+        std::string connectionString_;
+
+        /**
+         * The connection pool options
+         */
+        PoolOptions options_;
 
         /**
          * The mutex for accessing the connection pool
@@ -56,8 +190,43 @@ namespace shaiya::database
         std::condition_variable condition_;
 
         /**
-         * The pool of active connections
+         * The idle connections, with the most recently returned connection at the front
+         */
+        std::deque<std::unique_ptr<PooledConnection>> idle_;
+
+        /**
+         * The number of connections that are open, or being opened
+         */
+        size_t open_{ 0 };
+
+        /**
+         * The statements that are prepared on every connection, in the order they were registered
+         */
+        std::vector<std::pair<std::string, std::string>> statements_;
+
+        /**
+         * The number of checkouts that timed out
+         */
+        size_t timeouts_{ 0 };
+
+        /**
+         * The number of broken connections that were replaced
+         */
+        size_t reconnects_{ 0 };
+
+        /**
+         * The time spent waiting to check out a connection
+         */
+        LatencyHistogram checkoutWait_;
+
+        /**
+         * The mutex for accessing the statement latency histograms
+         */
+        std::shared_mutex histogramMutex_;
+
+        /**
+         * The latency histogram of each statement, keyed by the statement name
          */
-        std::queue<pqxx::connection*> pool_;
+        std::unordered_map<std::string, std::unique_ptr<LatencyHistogram>> histograms_;
     };
-}
\ No newline at end of file
+}
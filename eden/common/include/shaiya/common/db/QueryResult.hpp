@@ -0,0 +1,82 @@
+#pragma once
+#include <pqxx/pqxx>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+// Forward declaration of the libpq result
+struct pg_result;
+
+namespace shaiya::database
+{
+    /**
+     * The rows returned by an asynchronous query. The result is reference counted, so it can be cheaply passed between
+     * threads and completion handlers.
+     */
+    class QueryResult
+    {
+    public:
+        /**
+         * Initialises an empty result.
+         */
+        QueryResult() = default;
+
+        /**
+         * Takes ownership of a libpq result.
+         * @param result    The libpq result.
+         */
+        explicit QueryResult(pg_result* result);
+
+        /**
+         * Gets the number of rows.
+         * @return  The number of rows.
+         */
+        [[nodiscard]] size_t size() const;
+
+        /**
+         * Checks if there are no rows.
+         * @return  If there are no rows.
+         */
+        [[nodiscard]] bool empty() const
+        {
+            return size() == 0;
+        }
+
+        /**
+         * Checks if a field is null.
+         * @param row       The row index.
+         * @param column    The column name.
+         * @return          If the field is null.
+         */
+        [[nodiscard]] bool isNull(size_t row, const std::string& column) const;
+
+        /**
+         * Gets the value of a field.
+         * @tparam T        The type to convert the value to.
+         * @param row       The row index.
+         * @param column    The column name.
+         * @return          The value.
+         */
+        template<typename T>
+        [[nodiscard]] T get(size_t row, const std::string& column) const
+        {
+            return pqxx::from_string<T>(value(row, column));
+        }
+
+    private:
+        /**
+         * Gets the text value of a field. An exception is thrown if the field doesn't exist, or is null.
+         * @param row       The row index.
+         * @param column    The column name.
+         * @return          The text value.
+         */
+        [[nodiscard]] std::string_view value(size_t row, const std::string& column) const;
+
+        /**
+         * The libpq result.
+         */
+        std::shared_ptr<pg_result> result_;
+    };
+}
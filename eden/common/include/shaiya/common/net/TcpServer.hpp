@@ -4,12 +4,34 @@
 #include <boost/asio.hpp>
 #include <glog/logging.h>
 
+#include <algorithm>
+#include <deque>
+#include <thread>
 #include <type_traits>
+#include <vector>
 
 namespace shaiya::net
 {
     /**
-     * A simple TCP server that handles the processing of inbound network events.
+     * The options of the sockets that a TcpServer listens on.
+     */
+    struct ListenerOptions
+    {
+        /**
+         * The number of acceptors. Each acceptor owns its own socket and io context, and runs on its own thread.
+         */
+        size_t acceptors{ 1 };
+
+        /**
+         * If the sockets are bound with SO_REUSEPORT, so the kernel spreads the connections to the port between them.
+         * This allows several processes to listen on the same port, and is always enabled with more than one acceptor.
+         */
+        bool reusePort{ false };
+    };
+
+    /**
+     * A simple TCP server that handles the processing of inbound network events. The server may listen with several
+     * acceptors on the same port, in which case a session is handled on the thread of the acceptor that accepted it.
      * @tparam T    The session type.
      */
     template<typename T>
@@ -21,10 +43,25 @@ namespace shaiya::net
         /**
          * Initialises this TcpServer to handle incoming network events on a specific
          * local port.
-         * @param port  The port to operate on.
+         * @param port      The port to operate on.
+         * @param options   The options of the listening sockets.
          */
-        explicit TcpServer(uint16_t port): acceptor_(ctx_, boost::asio::ip::tcp::endpoint(boost::asio::ip::tcp::v4(), port))
+        explicit TcpServer(uint16_t port, ListenerOptions options = {})
         {
+            using boost::asio::ip::tcp;
+
+            auto reusePort = options.reusePort || options.acceptors > 1;
+            tcp::endpoint endpoint(tcp::v4(), port);
+            for (size_t i = 0; i < std::max<size_t>(options.acceptors, 1); i++)
+            {
+                auto& acceptor = listeners_.emplace_back().acceptor;
+                acceptor.open(endpoint.protocol());
+                acceptor.set_option(tcp::acceptor::reuse_address(true));
+                if (reusePort)
+                    acceptor.set_option(ReusePort(true));
+                acceptor.bind(endpoint);
+                acceptor.listen();
+            }
         }
 
         /**
@@ -32,22 +69,64 @@ namespace shaiya::net
          */
         ~TcpServer()
         {
-            acceptor_.close();
+            for (auto&& listener: listeners_)
+                listener.ctx.stop();
+
+            for (auto&& thread: threads_)
+                thread.join();
+
+            for (auto&& listener: listeners_)
+                listener.acceptor.close();
         }
 
         /**
-         * Starts this server, and begins accepting connections.
+         * Starts this server, and begins accepting connections. The first acceptor runs on the calling thread, and
+         * every other acceptor runs on a thread of its own.
          */
         void start()
         {
-            auto endpoint = acceptor_.local_endpoint();
-            LOG(INFO) << "NioServer listening on " << endpoint.address().to_string() << ":" << endpoint.port();
+            auto endpoint = listeners_.front().acceptor.local_endpoint();
+            LOG(INFO) << "NioServer listening on " << endpoint.address().to_string() << ":" << endpoint.port() << " with "
+                      << listeners_.size() << " acceptor(s)";
+
+            for (auto&& listener: listeners_)
+                acceptConnection(listener);
+
+            for (size_t i = 1; i < listeners_.size(); i++)
+                threads_.emplace_back([this, i]() { listeners_.at(i).ctx.run(); });
 
-            acceptConnection();
-            ctx_.run();
+            listeners_.front().ctx.run();
         }
 
     private:
+        /**
+         * The socket option that allows several sockets to bind to the same port.
+         */
+        using ReusePort = boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+
+        /**
+         * An acceptor, and the io context that it and its sessions run on.
+         */
+        struct Listener
+        {
+            /**
+             * Initialises a listener with a closed acceptor.
+             */
+            Listener(): acceptor(ctx)
+            {
+            }
+
+            /**
+             * The worker context of the acceptor.
+             */
+            boost::asio::io_context ctx;
+
+            /**
+             * The connection acceptor.
+             */
+            boost::asio::ip::tcp::acceptor acceptor;
+        };
+
         /**
          * Creates a session for the specified type
          * @param ioContext The worker context
@@ -57,11 +136,13 @@ namespace shaiya::net
 
         /**
          * Begins accepting a new incoming connection.
+         * @param listener  The listener to accept the connection on.
          */
-        void acceptConnection()
+        void acceptConnection(Listener& listener)
         {
-            auto session = createSession(ctx_);
-            acceptor_.async_accept(session->socket(), [this, session](const boost::system::error_code& error) {
+            auto session = createSession(listener.ctx);
+            auto& acceptor = listener.acceptor;
+            acceptor.async_accept(session->socket(), [this, &listener, session](const boost::system::error_code& error) {
                 if (error)
                 {
                     session->close();
@@ -72,18 +153,18 @@ namespace shaiya::net
                     session->read();
                 }
 
-                acceptConnection();
+                acceptConnection(listener);
             });
         }
 
         /**
-         * The worker context to use for this server.
+         * The listeners of this server.
          */
-        boost::asio::io_context ctx_;
+        std::deque<Listener> listeners_;
 
         /**
-         * The connection acceptor for this server.
+         * The threads that run the listeners other than the first.
          */
-        boost::asio::ip::tcp::acceptor acceptor_;
+        std::vector<std::thread> threads_;
     };
 }
\ No newline at end of file
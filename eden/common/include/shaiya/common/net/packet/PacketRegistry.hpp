@@ -3,6 +3,10 @@
 #include <shaiya/common/net/packet/ExecutionType.hpp>
 #include <shaiya/common/net/packet/Packet.hpp>
 #include <shaiya/common/util/Async.hpp>
+#include <shaiya/common/util/Coroutine.hpp>
+
+#include <boost/asio/co_spawn.hpp>
+#include <glog/logging.h>
 
 namespace shaiya::net
 {
@@ -67,6 +71,42 @@ namespace shaiya::net
             };
         }
 
+        /**
+         * Registers a packet handler that is a coroutine. The handler is spawned on the executor of the session's socket,
+         * and may suspend on database queries, remote calls or offloaded work without holding a thread. The session is
+         * kept alive until the handler has completed.
+         * @tparam Opcode   The opcode of the packet.
+         * @tparam T        The packet type to convert the data to.
+         * @param func      The handler coroutine.
+         */
+        template<size_t Opcode, typename T>
+        void registerCoroutineHandler(const std::function<boost::asio::awaitable<void>(Session&, const T&)>& func)
+        {
+            handlers_[Opcode] = [func](Session& session, size_t length, const char* payload) {
+                // The coroutine owns its copy of the packet, as the session's buffer is reused once this returns.
+                auto packet   = toPacket<T>(payload, length);
+                auto self     = session.shared_from_this();
+                auto executor = session.socket().get_executor();
+
+                auto handler = [func, self, packet = std::move(packet)]() -> boost::asio::awaitable<void> {
+                    co_await func(*self, packet);
+                };
+                auto completion = [self](std::exception_ptr error) {
+                    try
+                    {
+                        if (error)
+                            std::rethrow_exception(error);
+                    }
+                    catch (const std::exception& e)
+                    {
+                        LOG(ERROR) << "Exception occurred in a packet handler for " << self->remoteAddress() << ": "
+                                   << e.what();
+                    }
+                };
+                boost::asio::co_spawn(executor, std::move(handler), std::move(completion));
+            };
+        }
+
         /**
          * Gets the registry singleton.
          * @return  The packet registry.
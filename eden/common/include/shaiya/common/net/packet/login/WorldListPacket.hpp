@@ -50,10 +50,10 @@ namespace shaiya::net
     } PACKED;
 
     /**
-     * Represents the Shaiya world list packet.
+     * Represents the header of the Shaiya world list packet. The header is followed by the number of world list entries
+     * that it specifies.
      */
-    template<size_t Count>
-    struct WorldListPacket
+    struct WorldListHeader
     {
         /**
          * The opcode of the world list packet.
@@ -64,10 +64,5 @@ namespace shaiya::net
          * The number of world servers
          */
         uint8_t count{ 0 };
-
-        /**
-         * The world server entries
-         */
-        std::array<WorldListEntry, Count> servers;
     } PACKED;
 }
\ No newline at end of file
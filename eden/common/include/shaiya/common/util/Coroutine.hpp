@@ -0,0 +1,85 @@
+#pragma once
+#include <utility>  // Boost 1.74's awaitable header uses std::exchange without including <utility>
+
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/this_coro.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <boost/asio/use_awaitable.hpp>
+
+#include <exception>
+#include <type_traits>
+#include <variant>
+
+namespace shaiya
+{
+    /**
+     * Gets the thread pool that runs blocking work on behalf of coroutines.
+     * @return  The thread pool.
+     */
+    inline boost::asio::thread_pool& offloadPool()
+    {
+        static boost::asio::thread_pool pool;
+        return pool;
+    }
+
+    /**
+     * Runs a blocking function on a thread pool, and resumes the calling coroutine on its own executor once the
+     * function has returned.
+     * @tparam F    The function type.
+     * @param pool  The thread pool to run the function on.
+     * @param fn    The function.
+     * @return      The value returned by the function.
+     */
+    template<typename F>
+    boost::asio::awaitable<std::invoke_result_t<F>> offload(boost::asio::thread_pool& pool, F fn)
+    {
+        using Result    = std::invoke_result_t<F>;
+        using Value     = std::conditional_t<std::is_void_v<Result>, std::monostate, Result>;
+        using Signature = void(std::exception_ptr, Value);
+
+        auto executor = co_await boost::asio::this_coro::executor;
+        auto initiate = [&pool, executor, fn = std::move(fn)](auto handler) mutable {
+            boost::asio::post(pool, [executor, fn = std::move(fn), handler = std::move(handler)]() mutable {
+                std::exception_ptr error;
+                Value value{};
+                try
+                {
+                    if constexpr (std::is_void_v<Result>)
+                        fn();
+                    else
+                        value = fn();
+                }
+                catch (...)
+                {
+                    error = std::current_exception();
+                }
+
+                boost::asio::post(executor, [handler = std::move(handler), error, value = std::move(value)]() mutable {
+                    handler(error, std::move(value));
+                });
+            });
+        };
+
+        auto& token = boost::asio::use_awaitable;
+        [[maybe_unused]] auto value =
+            co_await boost::asio::async_initiate<decltype(token), Signature>(std::move(initiate), token);
+        if constexpr (!std::is_void_v<Result>)
+            co_return value;
+    }
+
+    /**
+     * Runs a blocking function on the offload pool, and resumes the calling coroutine on its own executor once the
+     * function has returned. This keeps blocking calls that don't yet have an asynchronous equivalent off the network
+     * thread.
+     * @tparam F    The function type.
+     * @param fn    The function.
+     * @return      The value returned by the function.
+     */
+    template<typename F>
+    boost::asio::awaitable<std::invoke_result_t<F>> offload(F fn)
+    {
+        return offload(offloadPool(), std::move(fn));
+    }
+}
@@ -0,0 +1,132 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+namespace shaiya
+{
+    /**
+     * A lock-free histogram of latencies. Samples are counted in buckets with exponentially growing upper bounds, which
+     * is precise enough to report percentiles while only taking a fixed amount of memory.
+     */
+    class LatencyHistogram
+    {
+    public:
+        /**
+         * The upper bounds of the buckets, in microseconds. Samples above the last bound are counted in an overflow bucket.
+         */
+        static constexpr std::array<int64_t, 16> BOUNDS = { 50,     100,    250,    500,     1000,    2500,
+                                                            5000,   10000,  25000,  50000,   100000,  250000,
+                                                            500000, 1000000, 2500000, 5000000 };
+
+        /**
+         * Records a sample.
+         * @param latency   The latency.
+         */
+        void record(std::chrono::nanoseconds latency)
+        {
+            auto micros = std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+
+            size_t bucket = 0;
+            while (bucket < BOUNDS.size() && micros > BOUNDS.at(bucket))
+                bucket++;
+
+            buckets_.at(bucket)++;
+            count_++;
+            total_ += micros;
+
+            auto max = max_.load();
+            while (micros > max && !max_.compare_exchange_weak(max, micros))
+                ;
+        }
+
+        /**
+         * Gets the number of recorded samples.
+         * @return  The number of samples.
+         */
+        [[nodiscard]] uint64_t count() const
+        {
+            return count_;
+        }
+
+        /**
+         * Gets the mean latency.
+         * @return  The mean latency.
+         */
+        [[nodiscard]] std::chrono::microseconds mean() const
+        {
+            auto count = count_.load();
+            return std::chrono::microseconds(count ? total_.load() / static_cast<int64_t>(count) : 0);
+        }
+
+        /**
+         * Gets the highest recorded latency.
+         * @return  The highest latency.
+         */
+        [[nodiscard]] std::chrono::microseconds max() const
+        {
+            return std::chrono::microseconds(max_.load());
+        }
+
+        /**
+         * Gets an upper bound of a percentile of the recorded latencies. The bound is the upper bound of the bucket that
+         * the percentile falls in, or the highest recorded latency if it falls in the overflow bucket.
+         * @param percentile    The percentile, between 0 and 1.
+         * @return              The upper bound of the percentile.
+         */
+        [[nodiscard]] std::chrono::microseconds percentile(double percentile) const
+        {
+            auto count = count_.load();
+            if (count == 0)
+                return std::chrono::microseconds(0);
+
+            auto target     = static_cast<uint64_t>(percentile * static_cast<double>(count));
+            uint64_t passed = 0;
+            for (size_t i = 0; i < BOUNDS.size(); i++)
+            {
+                passed += buckets_.at(i);
+                if (passed > target)
+                    return std::chrono::microseconds(std::min(BOUNDS.at(i), max_.load()));
+            }
+            return max();
+        }
+
+        /**
+         * Summarises the recorded latencies, as their count, mean, median, 99th percentile and maximum.
+         * @return  The summary
+         */
+        [[nodiscard]] std::string describe() const
+        {
+            std::stringstream stream;
+            stream << count() << " samples, mean " << mean().count() << "us, p50 " << percentile(0.5).count()
+                   << "us, p99 " << percentile(0.99).count() << "us, max " << max().count() << "us";
+            return stream.str();
+        }
+
+    private:
+        /**
+         * The number of samples in each bucket, with the overflow bucket last.
+         */
+        std::array<std::atomic<uint64_t>, BOUNDS.size() + 1> buckets_{};
+
+        /**
+         * The number of samples.
+         */
+        std::atomic<uint64_t> count_{ 0 };
+
+        /**
+         * The sum of the samples, in microseconds.
+         */
+        std::atomic<int64_t> total_{ 0 };
+
+        /**
+         * The highest sample, in microseconds.
+         */
+        std::atomic<int64_t> max_{ 0 };
+    };
+}
@@ -20,12 +20,13 @@ namespace shaiya
         }
 
         /**
-         * Gets the PRNG singleton.
+         * Gets the PRNG instance for the calling thread. Each thread owns its own generator, as the world may run its
+         * tasks across several worker threads.
          * @return  The prng.
          */
         static Prng& the()
         {
-            static Prng prng;
+            static thread_local Prng prng;
             return prng;
         }
 
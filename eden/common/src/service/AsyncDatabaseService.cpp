@@ -0,0 +1,422 @@
+#include <shaiya/common/db/AsyncDatabaseService.hpp>
+
+#include <boost/format.hpp>
+#include <glog/logging.h>
+#include <libpq-fe.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <unistd.h>
+
+using namespace shaiya::database;
+
+/**
+ * The delay before the first attempt to reopen a broken connection.
+ */
+constexpr auto MIN_RECONNECT_DELAY = std::chrono::milliseconds(100);
+
+/**
+ * The maximum delay between attempts to reopen a broken connection.
+ */
+constexpr auto MAX_RECONNECT_DELAY = std::chrono::milliseconds(10000);
+
+/**
+ * Initialises the database service, and starts the event loop thread.
+ * @param address       The database address
+ * @param database      The database name
+ * @param username      The name of the user
+ * @param password      The password of the user
+ * @param connections   The number of connections to open
+ * @param queryTimeout  The time a query may take before its connection is presumed to have failed
+ */
+AsyncDatabaseService::AsyncDatabaseService(const std::string& address, const std::string& database,
+                                           const std::string& username, const std::string& password, size_t connections,
+                                           std::chrono::milliseconds queryTimeout)
+    : queryTimeout_(queryTimeout), work_(context_.get_executor())
+{
+    auto fmt = boost::format("host=%1% dbname=%2% user=%3% password=%4%") % address % database % username % password;
+    connectionString_ = fmt.str();
+
+    for (size_t i = 0; i < std::max<size_t>(connections, 1); i++)
+    {
+        auto connection = std::make_unique<Connection>(context_);
+        open(*connection);
+        connections_.push_back(std::move(connection));
+    }
+
+    thread_ = std::thread([this]() { context_.run(); });
+}
+
+/**
+ * Stops the event loop thread, fails the queries that haven't completed, and closes the connections.
+ */
+AsyncDatabaseService::~AsyncDatabaseService()
+{
+    work_.reset();
+    context_.stop();
+    thread_.join();
+
+    auto error = std::make_exception_ptr(std::runtime_error("The database service has stopped"));
+    for (auto&& connection: connections_)
+    {
+        if (connection->active)
+            connection->active->complete(error, {});
+
+        boost::system::error_code ignored;
+        connection->socket.close(ignored);
+        PQfinish(connection->conn);
+    }
+
+    for (auto&& query: queue_)
+        query.complete(error, {});
+}
+
+/**
+ * Prepares a statement on every connection. This blocks, and must be called before any queries are executed. The
+ * statement is remembered, so it can be prepared again on connections that are reopened.
+ * @param name          The name of the statement
+ * @param statement     The statement body.
+ */
+void AsyncDatabaseService::prepare(const std::string& name, const std::string& statement)
+{
+    statements_.emplace_back(name, statement);
+    for (auto&& connection: connections_)
+    {
+        // The connection is in non-blocking mode, so send the statement and wait for each result
+        if (!PQsendPrepare(connection->conn, name.c_str(), statement.c_str(), 0, nullptr))
+            throw std::runtime_error(PQerrorMessage(connection->conn));
+        while (PQflush(connection->conn) == 1)
+            connection->socket.wait(boost::asio::posix::stream_descriptor::wait_write);
+
+        std::string error;
+        while (auto* result = PQgetResult(connection->conn))
+        {
+            if (PQresultStatus(result) != PGRES_COMMAND_OK)
+                error = PQresultErrorMessage(result);
+            PQclear(result);
+        }
+
+        if (!error.empty())
+            throw std::runtime_error("Failed to prepare " + name + ": " + error);
+    }
+}
+
+/**
+ * Queues a query, to be executed on the next idle connection.
+ * @param query The query.
+ */
+void AsyncDatabaseService::submit(Query query)
+{
+    boost::asio::post(context_, [this, query = std::move(query)]() mutable {
+        queue_.push_back(std::move(query));
+        dispatch();
+    });
+}
+
+/**
+ * Starts executing queued queries on the idle connections. This must be called on the event loop.
+ */
+void AsyncDatabaseService::dispatch()
+{
+    for (auto&& connection: connections_)
+    {
+        if (!connection->open || connection->active)
+            continue;
+
+        // A reopened connection prepares its statements before it takes any queued query
+        auto& source = connection->setup.empty() ? queue_ : connection->setup;
+        if (source.empty())
+            continue;
+
+        connection->active = std::make_unique<Query>(std::move(source.front()));
+        source.pop_front();
+        send(*connection);
+    }
+    failQueuedIfDisconnected();
+}
+
+/**
+ * Sends the active query of a connection.
+ * @param connection    The connection.
+ */
+void AsyncDatabaseService::send(Connection& connection)
+{
+    auto& query = *connection.active;
+
+    // Presume the connection has failed if the query takes too long
+    auto generation = ++connection.generation;
+    connection.timer.expires_after(queryTimeout_);
+    connection.timer.async_wait([this, &connection, generation](const boost::system::error_code& error) {
+        if (error || generation != connection.generation)
+            return;
+        connection.error = "The query exceeded the timeout";
+        reset(connection);
+        complete(connection);
+    });
+
+    if (!query.statement.empty())
+    {
+        if (!PQsendPrepare(connection.conn, query.name.c_str(), query.statement.c_str(), 0, nullptr))
+            return fail(connection, PQerrorMessage(connection.conn));
+        return flush(connection);
+    }
+
+    std::vector<const char*> values;
+    values.reserve(query.params.size());
+    for (auto&& param: query.params)
+        values.push_back(param.c_str());
+
+    if (!PQsendQueryPrepared(connection.conn, query.name.c_str(), static_cast<int>(values.size()), values.data(), nullptr,
+                             nullptr, 0))
+        return fail(connection, PQerrorMessage(connection.conn));
+    flush(connection);
+}
+
+/**
+ * Flushes the outgoing data of a connection, and waits for the result once it has been sent.
+ * @param connection    The connection.
+ */
+void AsyncDatabaseService::flush(Connection& connection)
+{
+    auto status = PQflush(connection.conn);
+    if (status == -1)
+        return fail(connection, PQerrorMessage(connection.conn));
+    if (status == 0)
+        return receive(connection);
+
+    // Not all of the data could be sent, so wait until the socket is writable again
+    auto generation = connection.generation;
+    connection.socket.async_wait(boost::asio::posix::stream_descriptor::wait_write,
+                                 [this, &connection, generation](const boost::system::error_code& error) {
+                                     if (generation != connection.generation)
+                                         return;
+                                     if (error)
+                                         return fail(connection, error.message());
+                                     flush(connection);
+                                 });
+}
+
+/**
+ * Waits for a connection's socket to become readable, and consumes the results that have arrived.
+ * @param connection    The connection.
+ */
+void AsyncDatabaseService::receive(Connection& connection)
+{
+    auto generation = connection.generation;
+    connection.socket.async_wait(
+        boost::asio::posix::stream_descriptor::wait_read,
+        [this, &connection, generation](const boost::system::error_code& error) {
+            if (generation != connection.generation)
+                return;
+            if (error)
+                return fail(connection, error.message());
+            if (!PQconsumeInput(connection.conn))
+                return fail(connection, PQerrorMessage(connection.conn));
+
+            // Read every result that has fully arrived. A null result marks the end of the query.
+            while (!PQisBusy(connection.conn))
+            {
+                auto* result = PQgetResult(connection.conn);
+                if (!result)
+                    return complete(connection);
+
+                auto status = PQresultStatus(result);
+                if (status == PGRES_TUPLES_OK || status == PGRES_COMMAND_OK)
+                {
+                    connection.result = QueryResult(result);
+                }
+                else
+                {
+                    connection.error = PQresultErrorMessage(result);
+                    PQclear(result);
+                }
+            }
+            receive(connection);
+        });
+}
+
+/**
+ * Completes the active query of a connection, and starts the next queued query.
+ * @param connection    The connection.
+ */
+void AsyncDatabaseService::complete(Connection& connection)
+{
+    // The timer of a closed connection is counting down to its reopening, rather than the query's deadline
+    if (connection.open)
+        connection.timer.cancel();
+
+    auto query  = std::move(connection.active);
+    auto result = std::move(connection.result);
+    auto error  = std::move(connection.error);
+    connection.result = {};
+    connection.error.clear();
+
+    if (error.empty())
+        query->complete(nullptr, std::move(result));
+    else
+        query->complete(std::make_exception_ptr(std::runtime_error(error)), {});
+    dispatch();
+}
+
+/**
+ * Fails the active query of a connection, and resets the connection if it has broken.
+ * @param connection    The connection.
+ * @param error         The error message.
+ */
+void AsyncDatabaseService::fail(Connection& connection, const std::string& error)
+{
+    if (PQstatus(connection.conn) == CONNECTION_BAD)
+    {
+        LOG(INFO) << "Resetting a broken asynchronous database connection: " << error;
+        reset(connection);
+    }
+
+    connection.error = error;
+    complete(connection);
+}
+
+/**
+ * Fails every queued query, if no connection is open to execute them. This must be called on the event loop.
+ */
+void AsyncDatabaseService::failQueuedIfDisconnected()
+{
+    auto open = std::any_of(connections_.begin(), connections_.end(), [](auto& connection) { return connection->open; });
+    if (open || queue_.empty())
+        return;
+
+    auto queue = std::move(queue_);
+    queue_.clear();
+
+    auto error = std::make_exception_ptr(std::runtime_error("No database connection is available"));
+    for (auto&& query: queue)
+        query.complete(error, {});
+}
+
+/**
+ * Closes a connection, and schedules it to be reopened after its backoff delay.
+ * @param connection    The connection.
+ */
+void AsyncDatabaseService::reset(Connection& connection)
+{
+    connection.open = false;
+    connection.generation++;
+    connection.setup.clear();
+
+    boost::system::error_code ignored;
+    connection.socket.close(ignored);
+    PQfinish(connection.conn);
+    connection.conn = nullptr;
+
+    // Wait a little longer after each failed attempt, so a database outage isn't met with a flood of connections
+    connection.backoff = std::clamp(connection.backoff * 2, MIN_RECONNECT_DELAY, MAX_RECONNECT_DELAY);
+    connection.timer.expires_after(connection.backoff);
+
+    auto generation = connection.generation;
+    connection.timer.async_wait([this, &connection, generation](const boost::system::error_code& error) {
+        if (!error && generation == connection.generation)
+            reconnect(connection);
+    });
+}
+
+/**
+ * Starts reopening a connection, without blocking the event loop.
+ * @param connection    The connection.
+ */
+void AsyncDatabaseService::reconnect(Connection& connection)
+{
+    auto generation = ++connection.generation;
+    connection.conn = PQconnectStart(connectionString_.c_str());
+    if (!connection.conn || PQstatus(connection.conn) == CONNECTION_BAD)
+    {
+        LOG(INFO) << "Failed to start reopening an asynchronous database connection.";
+        return reset(connection);
+    }
+
+    // Give up on this attempt if the database doesn't answer in time
+    connection.timer.expires_after(queryTimeout_);
+    connection.timer.async_wait([this, &connection, generation](const boost::system::error_code& error) {
+        if (!error && generation == connection.generation)
+            reset(connection);
+    });
+
+    // A connection that has just been started waits until its socket is writable
+    poll(connection, true);
+}
+
+/**
+ * Waits for the socket of a connection that is being reopened to become ready, and then advances the reopening.
+ * @param connection    The connection.
+ * @param writing       If the socket must become writable, rather than readable.
+ */
+void AsyncDatabaseService::poll(Connection& connection, bool writing)
+{
+    using boost::asio::posix::stream_descriptor;
+
+    // The socket may change between the steps of opening a connection, so asio is given the current one each time
+    boost::system::error_code ignored;
+    connection.socket.close(ignored);
+    connection.socket.assign(::dup(PQsocket(connection.conn)));
+
+    auto generation = connection.generation;
+    auto type       = writing ? stream_descriptor::wait_write : stream_descriptor::wait_read;
+    connection.socket.async_wait(type, [this, &connection, generation](const boost::system::error_code& error) {
+        if (generation != connection.generation)
+            return;
+        if (error)
+            return reset(connection);
+
+        switch (PQconnectPoll(connection.conn))
+        {
+            case PGRES_POLLING_OK:
+                if (PQsetnonblocking(connection.conn, 1) != 0)
+                    return reset(connection);
+                opened(connection);
+                return dispatch();
+            case PGRES_POLLING_READING:
+                return poll(connection, false);
+            case PGRES_POLLING_WRITING:
+                return poll(connection, true);
+            default:
+                LOG(INFO) << "Failed to reopen an asynchronous database connection: " << PQerrorMessage(connection.conn);
+                return reset(connection);
+        }
+    });
+}
+
+/**
+ * Opens a connection, and puts it in non-blocking mode. This blocks, and is only used on startup.
+ * @param connection    The connection.
+ */
+void AsyncDatabaseService::open(Connection& connection)
+{
+    connection.conn = PQconnectdb(connectionString_.c_str());
+    if (PQstatus(connection.conn) != CONNECTION_OK)
+        throw std::runtime_error(PQerrorMessage(connection.conn));
+    if (PQsetnonblocking(connection.conn, 1) != 0)
+        throw std::runtime_error(PQerrorMessage(connection.conn));
+
+    // asio owns a duplicate of the socket, so closing it doesn't close the connection's socket
+    connection.socket.assign(::dup(PQsocket(connection.conn)));
+    connection.open = true;
+}
+
+/**
+ * Marks a connection as open, and queues the remembered statements to be prepared on it.
+ * @param connection    The connection.
+ */
+void AsyncDatabaseService::opened(Connection& connection)
+{
+    LOG(INFO) << "Reopened an asynchronous database connection.";
+    connection.open    = true;
+    connection.backoff = std::chrono::milliseconds(0);
+    connection.timer.cancel();
+
+    for (auto&& [name, statement]: statements_)
+    {
+        auto complete = [name = name](std::exception_ptr error, QueryResult) {
+            if (error)
+                LOG(ERROR) << "Failed to prepare " << name << " on a reopened asynchronous database connection.";
+        };
+        connection.setup.push_back({ name, {}, std::move(complete), statement });
+    }
+}
@@ -3,12 +3,11 @@
 #include <boost/format.hpp>
 #include <glog/logging.h>
 
-using namespace shaiya::database;
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
 
-/**
- * The number of active connections in the connection pool.
- */
-constexpr auto POOL_SIZE = 10;
+using namespace shaiya::database;
 
 /**
  * Initialises the database service
@@ -16,68 +15,275 @@ constexpr auto POOL_SIZE = 10;
  * @param database  The database name
  * @param username  The name of the user
  * @param password  The password of the user
+ * @param options   The connection pool options
  */
 DatabaseService::DatabaseService(const std::string& address, const std::string& database, const std::string& username,
-                                 const std::string& password)
+                                 const std::string& password, PoolOptions options)
+    : options_(options)
 {
-    createPool(address, database, username, password);
+    auto fmt = boost::format("host=%1% dbname=%2% user=%3% password=%4%") % address % database % username % password;
+    connectionString_ = fmt.str();
+
+    // The pool always keeps at least one connection
+    options_.minConnections = std::max<size_t>(options_.minConnections, 1);
+    options_.maxConnections = std::max(options_.maxConnections, options_.minConnections);
+
+    // Open the minimum number of connections
+    std::lock_guard lock{ mutex_ };
+    for (size_t i = 0; i < options_.minConnections; i++)
+    {
+        idle_.push_back(open());
+        open_++;
+    }
 }
 
 /**
- * Initialises the connection pool
- * @param address   The address of the database server
- * @param database  The name of the database
- * @param username  The user to connect with
- * @param password  The password of the user
+ * Prepares a statement. The statement is prepared on every connection, including connections that are opened
+ * later.
+ * @param name          The name of the statement
+ * @param statement     The statement body.
  */
-void DatabaseService::createPool(const std::string& address, const std::string& database, const std::string& username,
-                                 const std::string& password)
+void DatabaseService::prepare(const std::string& name, const std::string& statement)
 {
+    histogram(name);
+
+    // Prepare the statement on the idle connections. Connections that are checked out prepare it on their next checkout.
     std::lock_guard lock{ mutex_ };
+    statements_.emplace_back(name, statement);
+    for (auto&& pooled: idle_)
+        prepareStatements(*pooled);
+}
 
-    auto fmt = boost::format("host=%1% dbname=%2% user=%3% password=%4%") % address % database % username % password;
-    auto connectionString = fmt.str();
+/**
+ * Checks out a connection, waiting for up to the checkout timeout of the pool.
+ * @return  The connection, which is returned to the pool when it is released
+ */
+std::shared_ptr<pqxx::connection> DatabaseService::connection()
+{
+    return connection(options_.checkoutTimeout);
+}
+
+/**
+ * Checks out a connection.
+ * @param timeout   The maximum time to wait for a connection to become available
+ * @return          The connection, which is returned to the pool when it is released
+ */
+std::shared_ptr<pqxx::connection> DatabaseService::connection(std::chrono::milliseconds timeout)
+{
+    using namespace std::chrono;
+    auto start    = steady_clock::now();
+    auto deadline = start + timeout;
 
-    for (size_t i = 0; i < POOL_SIZE; i++)
+    std::unique_lock lock{ mutex_ };
+    reapIdleConnections();
+
+    std::unique_ptr<PooledConnection> pooled;
+    while (!pooled)
     {
-        auto* con = new pqxx::connection(connectionString);
-        pool_.emplace(con);
+        // Prefer the most recently used idle connection
+        if (!idle_.empty())
+        {
+            pooled = std::move(idle_.front());
+            idle_.pop_front();
+
+            // Replace the connection if it's broken. The health check may query the database, so the lock isn't held.
+            lock.unlock();
+            auto broken = !healthy(*pooled);
+            lock.lock();
+            if (broken)
+            {
+                LOG(INFO) << "Replacing a broken database connection.";
+                pooled.reset();
+                open_--;
+                reconnects_++;
+            }
+            continue;
+        }
+
+        // Grow the pool if it isn't full
+        if (open_ < options_.maxConnections)
+        {
+            open_++;
+            lock.unlock();
+            try
+            {
+                pooled = open();
+            }
+            catch (const std::exception& e)
+            {
+                lock.lock();
+                open_--;
+                condition_.notify_one();
+                throw;
+            }
+            lock.lock();
+            continue;
+        }
+
+        // Wait for a connection to be returned
+        if (condition_.wait_until(lock, deadline) == std::cv_status::timeout && idle_.empty())
+        {
+            timeouts_++;
+            lock.unlock();
+            LOG(INFO) << "Timed out after " << timeout.count() << "ms waiting for a database connection. " << report();
+            throw std::runtime_error("Timed out waiting for a database connection");
+        }
     }
+
+    // Catch the connection up on any statements that were prepared while it was checked out
+    std::vector<std::pair<std::string, std::string>> pending(statements_.begin() + pooled->prepared, statements_.end());
+    lock.unlock();
+    try
+    {
+        for (auto&& [name, statement]: pending)
+            pooled->connection->prepare(name, statement);
+        pooled->prepared += pending.size();
+    }
+    catch (const std::exception& e)
+    {
+        lock.lock();
+        open_--;
+        condition_.notify_one();
+        throw;
+    }
+    checkoutWait_.record(steady_clock::now() - start);
+
+    // Return the connection to the pool when it's released, unless it has broken
+    auto* raw = pooled.release();
+    return std::shared_ptr<pqxx::connection>(raw->connection.get(), [this, raw](auto*) {
+        std::unique_ptr<PooledConnection> pooled(raw);
+        std::lock_guard lock{ mutex_ };
+        if (pooled->connection->is_open())
+        {
+            pooled->idleSince = std::chrono::steady_clock::now();
+            idle_.push_front(std::move(pooled));
+        }
+        else
+        {
+            open_--;
+            reconnects_++;
+        }
+        condition_.notify_one();
+    });
 }
 
 /**
- * Prepares a statement
- * @param name          The name of the statement
- * @param statement     The statement body.
+ * Records the latency of a statement.
+ * @param name      The name of the statement
+ * @param latency   The latency
  */
-void DatabaseService::prepare(const std::string& name, const std::string& statement)
+void DatabaseService::record(const std::string& name, std::chrono::nanoseconds latency)
+{
+    histogram(name).record(latency);
+}
+
+/**
+ * Summarises the state of the pool, and the latency of each statement.
+ * @return  The summary
+ */
+std::string DatabaseService::report()
 {
-    for (size_t i = 0; i < pool_.size(); i++)
+    std::stringstream stream;
     {
-        auto con = connection();
-        con->prepare(name, statement);
+        std::lock_guard lock{ mutex_ };
+        stream << "Database pool: " << open_ << "/" << options_.maxConnections << " open, " << idle_.size() << " idle, "
+               << timeouts_ << " timeouts, " << reconnects_ << " reconnects. Checkout wait: ";
     }
+    stream << checkoutWait_.describe() << ".";
+
+    std::shared_lock lock{ histogramMutex_ };
+    for (auto&& [name, histogram]: histograms_)
+    {
+        if (histogram->count() == 0)
+            continue;
+
+        stream << " " << name << ": " << histogram->describe() << ".";
+    }
+    return stream.str();
 }
 
 /**
- * Creates a new connection
+ * Opens a new connection.
  * @return  The connection
  */
-std::shared_ptr<pqxx::connection> DatabaseService::connection()
+std::unique_ptr<DatabaseService::PooledConnection> DatabaseService::open()
 {
-    std::unique_lock lock{ mutex_ };
+    auto pooled        = std::make_unique<PooledConnection>();
+    pooled->connection = std::make_unique<pqxx::connection>(connectionString_);
+    return pooled;
+}
+
+/**
+ * Checks if an idle connection can still be used. Connections that have been idle for longer than the health
+ * check interval are probed with a trivial query.
+ * @param pooled    The connection
+ * @return          If the connection is healthy
+ */
+bool DatabaseService::healthy(PooledConnection& pooled)
+{
+    if (!pooled.connection->is_open())
+        return false;
+    if (std::chrono::steady_clock::now() - pooled.idleSince < options_.healthCheckInterval)
+        return true;
+
+    try
+    {
+        pqxx::nontransaction tx(*pooled.connection);
+        tx.exec("SELECT 1;");
+        return true;
+    }
+    catch (const std::exception& e)
+    {
+        LOG(INFO) << "Database connection failed its health check: " << e.what();
+    }
+    return false;
+}
 
-    while (pool_.empty())
+/**
+ * Prepares the statements that haven't yet been prepared on a connection. This must be called while holding the pool
+ * mutex.
+ * @param pooled    The connection
+ */
+void DatabaseService::prepareStatements(PooledConnection& pooled)
+{
+    for (; pooled.prepared < statements_.size(); pooled.prepared++)
     {
-        condition_.wait(lock);
+        auto& [name, statement] = statements_.at(pooled.prepared);
+        pooled.connection->prepare(name, statement);
     }
+}
 
-    auto connection = pool_.front();
-    pool_.pop();
+/**
+ * Closes the idle connections above the minimum pool size that have been idle for longer than the idle timeout.
+ * This must be called while holding the pool mutex.
+ */
+void DatabaseService::reapIdleConnections()
+{
+    auto now = std::chrono::steady_clock::now();
+    while (open_ > options_.minConnections && !idle_.empty() && now - idle_.back()->idleSince > options_.idleTimeout)
+    {
+        idle_.pop_back();
+        open_--;
+    }
+}
 
-    return std::shared_ptr<pqxx::connection>(connection, [this](auto* con) {
-        std::unique_lock lock{ mutex_ };
-        pool_.push(con);
-        condition_.notify_one();
-    });
-}
\ No newline at end of file
+/**
+ * Gets the latency histogram of a statement, creating it if necessary.
+ * @param name  The name of the statement
+ * @return      The histogram
+ */
+shaiya::LatencyHistogram& DatabaseService::histogram(const std::string& name)
+{
+    {
+        std::shared_lock lock{ histogramMutex_ };
+        auto pos = histograms_.find(name);
+        if (pos != histograms_.end())
+            return *pos->second;
+    }
+
+    std::unique_lock lock{ histogramMutex_ };
+    auto& histogram = histograms_[name];
+    if (!histogram)
+        histogram = std::make_unique<LatencyHistogram>();
+    return *histogram;
+}
@@ -0,0 +1,53 @@
+#include <shaiya/common/db/QueryResult.hpp>
+
+#include <libpq-fe.h>
+
+#include <stdexcept>
+
+using namespace shaiya::database;
+
+/**
+ * Takes ownership of a libpq result.
+ * @param result    The libpq result.
+ */
+QueryResult::QueryResult(pg_result* result): result_(result, PQclear)
+{
+}
+
+/**
+ * Gets the number of rows.
+ * @return  The number of rows.
+ */
+size_t QueryResult::size() const
+{
+    return result_ ? PQntuples(result_.get()) : 0;
+}
+
+/**
+ * Checks if a field is null.
+ * @param row       The row index.
+ * @param column    The column name.
+ * @return          If the field is null.
+ */
+bool QueryResult::isNull(size_t row, const std::string& column) const
+{
+    auto index = result_ ? PQfnumber(result_.get(), column.c_str()) : -1;
+    if (index < 0 || row >= size())
+        throw std::out_of_range("No field " + column + " in row " + std::to_string(row));
+    return PQgetisnull(result_.get(), row, index);
+}
+
+/**
+ * Gets the text value of a field. An exception is thrown if the field doesn't exist, or is null.
+ * @param row       The row index.
+ * @param column    The column name.
+ * @return          The text value.
+ */
+std::string_view QueryResult::value(size_t row, const std::string& column) const
+{
+    if (isNull(row, column))
+        throw std::invalid_argument("Field " + column + " in row " + std::to_string(row) + " is null");
+
+    auto index = PQfnumber(result_.get(), column.c_str());
+    return { PQgetvalue(result_.get(), row, index), static_cast<size_t>(PQgetlength(result_.get(), row, index)) };
+}
@@ -12,6 +12,7 @@ namespace shaiya::client
 namespace shaiya::database
 {
     class DatabaseService;
+    class AsyncDatabaseService;
 }
 
 namespace shaiya::net
@@ -50,6 +51,11 @@ namespace shaiya::game
     class Map;
     class MapCell;
     class MapRepository;
+    struct MapTile;
+    class SpatialQuery;
+    class SpatialIndex;
+    class GridSpatialIndex;
+    class SparseSpatialIndex;
 
     // Commands
     class Command;
@@ -66,21 +72,36 @@ namespace shaiya::game
     class Scheduler;
     class ScheduledTask;
     class HealthNormalizationTask;
+    class PlayerPersistenceTask;
+    class LoadController;
+    struct TickPhases;
 
     // Synchronization
     class ClientSynchronizer;
     class ParallelClientSynchronizer;
+    class SyncBudget;
+    struct SyncPolicy;
     class CharacterSynchronizationTask;
     class MapSynchronizationTask;
     class NpcSynchronizationTask;
 
     // Serializers
     class PlayerSerializer;
+    class PlayerPrefetcher;
     class DatabasePlayerSerializer;
+    class BinaryPlayerSerializer;
+    class MemoryPlayerSerializer;
+    struct CharacterData;
+    struct PlayerSnapshot;
 
     // Services
     class ServiceContext;
     class CharacterScreenService;
     class GameWorldService;
+    class PersistenceService;
+    class PlayerDirectory;
+    struct PlayerEntry;
     class WorldApiService;
+    class ZoneDirectory;
+    struct Zone;
 }
\ No newline at end of file
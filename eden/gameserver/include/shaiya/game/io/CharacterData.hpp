@@ -0,0 +1,189 @@
+#pragma once
+#include <shaiya/common/DataTypes.hpp>
+#include <shaiya/game/Forward.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace shaiya::game
+{
+    /**
+     * The persisted state of a player character, as read from storage. The data is read away from the world thread, and
+     * then applied to the character on the world thread.
+     */
+    struct CharacterData
+    {
+        /**
+         * An item that is stored in one of the character's containers.
+         */
+        struct StoredItem
+        {
+            /**
+             * The id of the item definition.
+             */
+            uint32_t itemId{ 0 };
+
+            /**
+             * The slot that the item is in.
+             */
+            size_t slot{ 0 };
+
+            /**
+             * The quantity of the item.
+             */
+            size_t count{ 1 };
+        };
+
+        /**
+         * Copies the current state of a player character. This should only be called from the world thread.
+         * @param player    The player character.
+         * @return          The character data.
+         */
+        static CharacterData of(Player& player);
+
+        /**
+         * Decodes the data of a character.
+         * @param bytes     The encoded data.
+         * @param length    The length of the encoded data.
+         * @param data      The decoded character data.
+         * @return          If the data was decoded successfully.
+         */
+        static bool decode(const char* bytes, size_t length, CharacterData& data);
+
+        /**
+         * Encodes this data in a versioned binary format, which is used for character files and for handing a character
+         * off to another zone.
+         * @return  The encoded data.
+         */
+        [[nodiscard]] std::string encode() const;
+
+        /**
+         * Updates this data with the state held by a snapshot of the same character. The snapshot's item changes are
+         * applied to the stored items.
+         * @param snapshot  The snapshot.
+         */
+        void update(const PlayerSnapshot& snapshot);
+
+        /**
+         * The name of the character.
+         */
+        std::string name;
+
+        /**
+         * The race of the character.
+         */
+        ShaiyaRace race{};
+
+        /**
+         * The class of the character.
+         */
+        ShaiyaClass job{};
+
+        /**
+         * The gender of the character.
+         */
+        ShaiyaGender gender{};
+
+        /**
+         * The face of the character.
+         */
+        size_t face{ 0 };
+
+        /**
+         * The hair of the character.
+         */
+        size_t hair{ 0 };
+
+        /**
+         * The height of the character.
+         */
+        size_t height{ 0 };
+
+        /**
+         * The map the character is on.
+         */
+        uint16_t map{ 0 };
+
+        /**
+         * The x coordinate of the character.
+         */
+        float x{ 0 };
+
+        /**
+         * The y coordinate of the character.
+         */
+        float y{ 0 };
+
+        /**
+         * The z coordinate of the character.
+         */
+        float z{ 0 };
+
+        /**
+         * The number of unspent statpoints.
+         */
+        size_t statpoints{ 0 };
+
+        /**
+         * The base strength.
+         */
+        int32_t strength{ 0 };
+
+        /**
+         * The base dexterity.
+         */
+        int32_t dexterity{ 0 };
+
+        /**
+         * The base reaction.
+         */
+        int32_t reaction{ 0 };
+
+        /**
+         * The base intelligence.
+         */
+        int32_t intelligence{ 0 };
+
+        /**
+         * The base wisdom.
+         */
+        int32_t wisdom{ 0 };
+
+        /**
+         * The base luck.
+         */
+        int32_t luck{ 0 };
+
+        /**
+         * The current hitpoints.
+         */
+        int32_t hitpoints{ 0 };
+
+        /**
+         * The current mana.
+         */
+        int32_t mana{ 0 };
+
+        /**
+         * The current stamina.
+         */
+        int32_t stamina{ 0 };
+
+        /**
+         * The amount of gold in the inventory.
+         */
+        size_t gold{ 0 };
+
+        /**
+         * The items in the character's inventory.
+         */
+        std::vector<StoredItem> inventory;
+
+        /**
+         * The items that the character has equipped.
+         */
+        std::vector<StoredItem> equipment;
+    };
+}
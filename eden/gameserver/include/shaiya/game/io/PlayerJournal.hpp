@@ -0,0 +1,118 @@
+#pragma once
+#include <shaiya/game/io/PlayerSnapshot.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace shaiya::game
+{
+    /**
+     * An append-only journal of player snapshots, which keeps the state of player characters durable between database
+     * saves. The journal is split into numbered segments. Snapshots are appended to the open segment, which is rotated
+     * before each database save, so that the sealed segments can be deleted once the save has succeeded. If the server
+     * stops before that, the sealed segments are replayed into the database on the next startup.
+     */
+    class PlayerJournal
+    {
+    public:
+        /**
+         * Opens the journal, and starts a new segment after any existing segments.
+         * @param directory The directory that holds the journal segments.
+         */
+        explicit PlayerJournal(const std::string& directory);
+
+        /**
+         * Closes the open segment.
+         */
+        ~PlayerJournal();
+
+        /**
+         * Reads the snapshots from the segments that existed when the journal was opened, in the order they were
+         * appended. A segment that ends with a torn or corrupt record, such as from a crash during a write, is read up
+         * to that record.
+         * @return  The snapshots.
+         */
+        [[nodiscard]] std::vector<PlayerSnapshot> replay() const;
+
+        /**
+         * Appends a group of snapshots to the open segment. The snapshots are not durable until the journal is synced.
+         * @param snapshots The snapshots.
+         */
+        void append(const std::vector<PlayerSnapshot>& snapshots);
+
+        /**
+         * Flushes the appended snapshots to disk.
+         */
+        void sync();
+
+        /**
+         * Seals the open segment, and starts a new one. If nothing has been appended to the open segment, it is kept.
+         * @return  The id of the last sealed segment.
+         */
+        size_t rotate();
+
+        /**
+         * Deletes the sealed segments, up to and including a segment id.
+         * @param sealed    The id of the last segment to delete.
+         */
+        void compact(size_t sealed);
+
+    private:
+        /**
+         * Opens the segment with the current id.
+         */
+        void open();
+
+        /**
+         * Gets the path of a segment.
+         * @param id    The segment id.
+         * @return      The path.
+         */
+        [[nodiscard]] boost::filesystem::path segment(size_t id) const;
+
+        /**
+         * Gets the ids of the segments on disk, in ascending order.
+         * @return  The segment ids.
+         */
+        [[nodiscard]] std::vector<size_t> segments() const;
+
+        /**
+         * Encodes a snapshot as a journal record, and appends it to a buffer.
+         * @param snapshot  The snapshot.
+         * @param buffer    The buffer.
+         */
+        static void encode(const PlayerSnapshot& snapshot, std::string& buffer);
+
+        /**
+         * Decodes the payload of a journal record.
+         * @param data      The payload.
+         * @param length    The length of the payload.
+         * @param snapshot  The decoded snapshot.
+         * @return          If the payload was decoded successfully.
+         */
+        static bool decode(const char* data, size_t length, PlayerSnapshot& snapshot);
+
+        /**
+         * The directory that holds the journal segments.
+         */
+        boost::filesystem::path directory_;
+
+        /**
+         * The id of the open segment.
+         */
+        size_t current_{ 0 };
+
+        /**
+         * The file descriptor of the open segment.
+         */
+        int fd_{ -1 };
+
+        /**
+         * The number of bytes appended to the open segment.
+         */
+        size_t written_{ 0 };
+    };
+}
@@ -0,0 +1,163 @@
+#pragma once
+#include <shaiya/game/Forward.hpp>
+#include <shaiya/game/io/CharacterData.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace shaiya::game
+{
+    /**
+     * Reads the data of a character in the background while its player is still on the character screen, so the data
+     * is already warm by the time the character is selected. Prefetched data is only used while it is fresh, and is
+     * discarded when the character logs out. Characters are read through the persistence service, so a prefetch
+     * includes the snapshots of the character that haven't been saved yet.
+     */
+    class PlayerPrefetcher
+    {
+    public:
+        /**
+         * The function that receives the data of a character, once a prefetch that was claimed has finished.
+         */
+        using Callback = std::function<void(std::optional<CharacterData>)>;
+
+        /**
+         * Initialises this prefetcher.
+         * @param persistence   The persistence service used to read the characters.
+         * @param ttl           The time that prefetched data stays fresh for.
+         */
+        PlayerPrefetcher(PersistenceService& persistence, std::chrono::milliseconds ttl);
+
+        /**
+         * Starts reading the data of a character in the background, unless it is already prefetched.
+         * @param id    The id of the character.
+         */
+        void prefetch(size_t id);
+
+        /**
+         * Claims the prefetched data of a character. If the data has been read, it is returned straight away, and if
+         * it is still being read, the callback receives it once the read finishes.
+         * @param id        The id of the character.
+         * @param data      The prefetched data, if it has already been read.
+         * @param callback  The callback that receives the data, if it is still being read.
+         * @return          If the character was prefetched, and the data was claimed.
+         */
+        bool claim(size_t id, std::optional<CharacterData>& data, Callback callback);
+
+        /**
+         * Discards the prefetched data of a character, as its persisted state is about to change.
+         * @param id    The id of the character.
+         */
+        void invalidate(size_t id);
+
+        /**
+         * Gets the number of selections that used prefetched data.
+         * @return  The number of hits.
+         */
+        [[nodiscard]] size_t hits() const
+        {
+            return hits_;
+        }
+
+        /**
+         * Gets the number of prefetches that expired or were discarded before being claimed.
+         * @return  The number of wasted prefetches.
+         */
+        [[nodiscard]] size_t wasted() const
+        {
+            return wasted_;
+        }
+
+        /**
+         * Summarises how many prefetches were used, and how many were wasted.
+         * @return  The summary
+         */
+        [[nodiscard]] std::string report() const;
+
+    private:
+        /**
+         * A prefetch of a character.
+         */
+        struct Entry
+        {
+            /**
+             * The token that identifies this prefetch, so a read that finishes after the entry was discarded is
+             * ignored.
+             */
+            size_t token{ 0 };
+
+            /**
+             * If the read has finished.
+             */
+            bool ready{ false };
+
+            /**
+             * The data that was read.
+             */
+            std::optional<CharacterData> data;
+
+            /**
+             * The time at which the read finished.
+             */
+            std::chrono::steady_clock::time_point readAt;
+
+            /**
+             * The callback of a claim that is waiting for the read to finish.
+             */
+            Callback callback;
+        };
+
+        /**
+         * Reads the data of a character, and completes its prefetch.
+         * @param id    The id of the character.
+         * @param token The token of the prefetch.
+         */
+        void read(size_t id, size_t token);
+
+        /**
+         * Discards the prefetches that have expired without being claimed. This must be called while holding the
+         * mutex.
+         */
+        void expire();
+
+        /**
+         * The persistence service used to read the characters.
+         */
+        PersistenceService& persistence_;
+
+        /**
+         * The time that prefetched data stays fresh for.
+         */
+        std::chrono::milliseconds ttl_;
+
+        /**
+         * The prefetches, keyed by character id.
+         */
+        std::unordered_map<size_t, Entry> entries_;
+
+        /**
+         * The token of the next prefetch.
+         */
+        size_t nextToken_{ 1 };
+
+        /**
+         * The number of selections that used prefetched data.
+         */
+        std::atomic<size_t> hits_{ 0 };
+
+        /**
+         * The number of prefetches that expired or were discarded before being claimed.
+         */
+        std::atomic<size_t> wasted_{ 0 };
+
+        /**
+         * The mutex used for locking access to the prefetches.
+         */
+        std::mutex mutex_;
+    };
+}
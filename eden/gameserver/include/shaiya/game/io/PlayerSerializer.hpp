@@ -1,25 +1,104 @@
 #pragma once
+#include <shaiya/common/net/packet/game/CharacterList.hpp>
 #include <shaiya/game/Forward.hpp>
+#include <shaiya/game/io/CharacterData.hpp>
+#include <shaiya/game/io/PlayerSnapshot.hpp>
+
+#include <optional>
+#include <vector>
 
 namespace shaiya::game
 {
     /**
-     * An interface that is designed to serialize and deserialize player characters.
+     * Serializes and deserializes player characters. Implementations provide the storage, by reading character data and
+     * saving snapshots, while applying the data to a character is shared.
      */
     class PlayerSerializer
     {
     public:
+        /**
+         * Initialises this serializer.
+         * @param itemDefs  The item definitions.
+         */
+        explicit PlayerSerializer(const shaiya::client::ItemSData& itemDefs);
+
+        /**
+         * Initialises this serializer, with a prototype for the characters that don't exist in storage yet.
+         * @param itemDefs  The item definitions.
+         * @param prototype The prototype of a new character.
+         */
+        PlayerSerializer(const shaiya::client::ItemSData& itemDefs, CharacterData prototype);
+
+        /**
+         * Destroys this serializer.
+         */
+        virtual ~PlayerSerializer() = default;
+
         /**
          * Loads a player character.
          * @param character The character to load.
          * @return          If the character was loaded successfully.
          */
-        virtual bool load(Player& player) = 0;
+        bool load(Player& player);
+
+        /**
+         * Reads the persisted state of a player character. This may be called from any thread.
+         * @param id    The id of the character.
+         * @return      The character data, or an empty optional if the character couldn't be read.
+         */
+        virtual std::optional<CharacterData> read(size_t id) = 0;
+
+        /**
+         * Applies previously read character data to a player character. This should only be called from the world thread.
+         * @param player    The player character.
+         * @param data      The character data.
+         */
+        virtual void apply(Player& player, const CharacterData& data);
 
         /**
          * Saves a player character.
          * @param character The character to save.
          */
-        virtual void save(Player& player) = 0;
+        void save(Player& player);
+
+        /**
+         * Saves a batch of player snapshots.
+         * @param snapshots The snapshots to save.
+         * @return          If the snapshots were saved successfully.
+         */
+        virtual bool save(const std::vector<PlayerSnapshot>& snapshots) = 0;
+
+        /**
+         * Adds a character that was created on the character screen, when this serializer is the only storage of
+         * characters. The character is created from the prototype, with the chosen name, race, class and appearance.
+         * @param entry The character list entry of the new character.
+         * @return      The id of the new character, or an empty optional if this serializer can't add characters.
+         */
+        virtual std::optional<size_t> add(const shaiya::net::CharacterListEntry& entry);
+
+    protected:
+        /**
+         * Creates the data of a character that doesn't exist in storage yet, from the prototype.
+         * @param id    The id of the character.
+         * @return      The character data.
+         */
+        [[nodiscard]] CharacterData create(size_t id) const;
+
+        /**
+         * Creates the data of a character that was created on the character screen, from the prototype.
+         * @param entry The character list entry of the new character.
+         * @return      The character data.
+         */
+        [[nodiscard]] CharacterData create(const shaiya::net::CharacterListEntry& entry) const;
+
+        /**
+         * The item definitions.
+         */
+        const shaiya::client::ItemSData& itemDefs_;
+
+        /**
+         * The prototype of a new character.
+         */
+        CharacterData prototype_;
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,152 @@
+#pragma once
+#include <shaiya/game/Forward.hpp>
+#include <shaiya/game/model/item/container/ItemContainer.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace shaiya::game
+{
+    /**
+     * An immutable copy of the persisted state of a player character. Snapshots are taken on the world thread, and can
+     * then be safely saved on any other thread.
+     */
+    struct PlayerSnapshot
+    {
+        /**
+         * Takes a snapshot of a player character. This should only be called from the world thread. The change journals of
+         * the character's inventory and equipment are drained into the snapshot, so every snapshot that is taken must be
+         * saved.
+         * @param player    The player character.
+         * @return          The snapshot.
+         */
+        static PlayerSnapshot of(Player& player);
+
+        /**
+         * Checks if this snapshot holds the same state as another snapshot. The time at which the snapshots were taken
+         * is not compared.
+         * @param other The other snapshot.
+         * @return      If the snapshots hold the same state.
+         */
+        [[nodiscard]] bool sameStateAs(const PlayerSnapshot& other) const;
+
+        /**
+         * Checks if this snapshot can be saved, which requires the character's position to be finite.
+         * @return  If the snapshot is valid.
+         */
+        [[nodiscard]] bool valid() const;
+
+        /**
+         * Checks if this snapshot holds any inventory or equipment changes.
+         * @return  If there are item changes to save.
+         */
+        [[nodiscard]] bool hasItemChanges() const
+        {
+            return !inventoryChanges.empty() || !equipmentChanges.empty();
+        }
+
+        /**
+         * Carries over the item changes of an older snapshot of the same character, for the slots that haven't changed
+         * again since. This is used when a newer snapshot replaces an older one before the older one was saved.
+         * @param older The older snapshot.
+         */
+        void inheritChanges(const PlayerSnapshot& older);
+
+        /**
+         * The id of the character.
+         */
+        size_t id{ 0 };
+
+        /**
+         * The map the character is on.
+         */
+        uint16_t map{ 0 };
+
+        /**
+         * The x coordinate of the character.
+         */
+        float x{ 0 };
+
+        /**
+         * The y coordinate of the character.
+         */
+        float y{ 0 };
+
+        /**
+         * The z coordinate of the character.
+         */
+        float z{ 0 };
+
+        /**
+         * The number of unspent statpoints.
+         */
+        uint32_t statpoints{ 0 };
+
+        /**
+         * The base strength.
+         */
+        int32_t strength{ 0 };
+
+        /**
+         * The base dexterity.
+         */
+        int32_t dexterity{ 0 };
+
+        /**
+         * The base reaction.
+         */
+        int32_t reaction{ 0 };
+
+        /**
+         * The base intelligence.
+         */
+        int32_t intelligence{ 0 };
+
+        /**
+         * The base wisdom.
+         */
+        int32_t wisdom{ 0 };
+
+        /**
+         * The base luck.
+         */
+        int32_t luck{ 0 };
+
+        /**
+         * The current hitpoints.
+         */
+        uint32_t hitpoints{ 0 };
+
+        /**
+         * The current mana.
+         */
+        uint32_t mana{ 0 };
+
+        /**
+         * The current stamina.
+         */
+        uint32_t stamina{ 0 };
+
+        /**
+         * The amount of gold in the inventory.
+         */
+        size_t gold{ 0 };
+
+        /**
+         * The inventory slots that changed since the previous snapshot.
+         */
+        std::vector<ItemDelta> inventoryChanges;
+
+        /**
+         * The equipment slots that changed since the previous snapshot.
+         */
+        std::vector<ItemDelta> equipmentChanges;
+
+        /**
+         * The time at which this snapshot was taken.
+         */
+        std::chrono::steady_clock::time_point takenAt;
+    };
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <shaiya/game/Forward.hpp>
+#include <shaiya/game/io/PlayerSerializer.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <mutex>
+#include <string>
+
+namespace shaiya::game
+{
+    /**
+     * Saves and loads player characters as versioned binary files, with one file per character. A character is read by
+     * mapping its file into memory and decoding it in place, which keeps the cost of a load close to that of a single
+     * read. This is intended for load tests and benchmarks that run without a database, so the files are replaced
+     * atomically but are not synced to disk.
+     */
+    class BinaryPlayerSerializer: public PlayerSerializer
+    {
+    public:
+        /**
+         * Initialises this character serializer.
+         * @param itemDefs  The item definitions.
+         * @param directory The directory that holds the character files.
+         * @param prototype The prototype of a new character.
+         */
+        BinaryPlayerSerializer(const shaiya::client::ItemSData& itemDefs, const std::string& directory,
+                               CharacterData prototype);
+
+        // Saving a single player is shared with the other serializers
+        using PlayerSerializer::save;
+
+        /**
+         * Reads the state of a character from its file, or creates it from the prototype if it doesn't have a file.
+         * @param id    The id of the character.
+         * @return      The character data, or an empty optional if the file couldn't be read.
+         */
+        std::optional<CharacterData> read(size_t id) override;
+
+        /**
+         * Saves a batch of player snapshots, by updating the file of each character.
+         * @param snapshots The snapshots to save.
+         * @return          If the snapshots were saved successfully.
+         */
+        bool save(const std::vector<PlayerSnapshot>& snapshots) override;
+
+        /**
+         * Adds a character that was created on the character screen, with an id above those of the existing character
+         * files.
+         * @param entry The character list entry of the new character.
+         * @return      The id of the new character, or an empty optional if its file couldn't be written.
+         */
+        std::optional<size_t> add(const shaiya::net::CharacterListEntry& entry) override;
+
+    private:
+        /**
+         * Gets the path of a character's file.
+         * @param id    The id of the character.
+         * @return      The path.
+         */
+        [[nodiscard]] boost::filesystem::path path(size_t id) const;
+
+        /**
+         * Writes the data of a character to its file. The data is written to a temporary file first, which then replaces
+         * the character's file, so a reader never sees a partially written file.
+         * @param id    The id of the character.
+         * @param data  The character data.
+         */
+        void write(size_t id, const CharacterData& data) const;
+
+        /**
+         * The directory that holds the character files.
+         */
+        boost::filesystem::path directory_;
+
+        /**
+         * The id of the next character that is added, which is above the ids of the existing character files.
+         */
+        size_t nextId_{ 1 };
+
+        /**
+         * The mutex that serialises saves, as each save reads and then rewrites a file.
+         */
+        std::mutex mutex_;
+    };
+}
@@ -16,21 +16,27 @@ namespace shaiya::game
          * @param itemDefs      The item definitions.
          * @param worldId       The id of this world server.
          */
-        DatabasePlayerSerializer(shaiya::database::DatabaseService& db, shaiya::client::ItemSData& itemDefs,
-                                    size_t worldId);
+        DatabasePlayerSerializer(shaiya::database::DatabaseService& db, const shaiya::client::ItemSData& itemDefs,
+                                 size_t worldId);
+
+        // Saving a single player is shared with the other serializers
+        using PlayerSerializer::save;
 
         /**
-         * Loads a player character.
-         * @param character The character to load.
-         * @return          If the character was loaded successfully.
+         * Reads the details, inventory and equipment of a character in a single transaction. The three queries are
+         * pipelined, so they are sent to the database in a single round trip.
+         * @param id    The id of the character.
+         * @return      The character data, or an empty optional if the character couldn't be read.
          */
-        bool load(Player& player) override;
+        std::optional<CharacterData> read(size_t id) override;
 
         /**
-         * Saves a player character.
-         * @param character The character to save.
+         * Saves a batch of player snapshots, with a single multi-row update per statement. Only the inventory and
+         * equipment slots that changed since the previous snapshot are written.
+         * @param snapshots The snapshots to save.
+         * @return          If the snapshots were saved successfully.
          */
-        void save(Player& player) override;
+        bool save(const std::vector<PlayerSnapshot>& snapshots) override;
 
     private:
         /**
@@ -38,28 +44,9 @@ namespace shaiya::game
          */
         shaiya::database::DatabaseService& db_;
 
-        /**
-         * The item definitions.
-         */
-        shaiya::client::ItemSData& itemDefs_;
-
         /**
          * The id of this world server.
          */
         size_t worldId_;
-
-        /**
-         * Loads the inventory of this character.
-         * @param character The character.
-         * @return          If the inventory was successfully loaded.
-         */
-        bool loadInventory(Player& player);
-
-        /**
-         * Loads the equipment of this character.
-         * @param character The character.
-         * @return          If the equipment was successfully loaded.
-         */
-        bool loadEquipment(Player& player);
     };
 }
\ No newline at end of file
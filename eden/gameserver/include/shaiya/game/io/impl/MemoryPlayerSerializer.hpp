@@ -0,0 +1,64 @@
+#pragma once
+#include <shaiya/game/Forward.hpp>
+#include <shaiya/game/io/PlayerSerializer.hpp>
+
+#include <mutex>
+#include <unordered_map>
+
+namespace shaiya::game
+{
+    /**
+     * Keeps player characters in memory, for load tests and benchmarks that measure the world without any storage
+     * latency. Characters that haven't been saved yet are created from a prototype, and nothing outlives the process.
+     */
+    class MemoryPlayerSerializer: public PlayerSerializer
+    {
+    public:
+        /**
+         * Initialises this character serializer.
+         * @param itemDefs  The item definitions.
+         * @param prototype The prototype of a new character.
+         */
+        MemoryPlayerSerializer(const shaiya::client::ItemSData& itemDefs, CharacterData prototype);
+
+        // Saving a single player is shared with the other serializers
+        using PlayerSerializer::save;
+
+        /**
+         * Reads the state of a character, or creates it from the prototype if it hasn't been saved.
+         * @param id    The id of the character.
+         * @return      The character data.
+         */
+        std::optional<CharacterData> read(size_t id) override;
+
+        /**
+         * Saves a batch of player snapshots.
+         * @param snapshots The snapshots to save.
+         * @return          If the snapshots were saved successfully.
+         */
+        bool save(const std::vector<PlayerSnapshot>& snapshots) override;
+
+        /**
+         * Adds a character that was created on the character screen, with an id that no other character has.
+         * @param entry The character list entry of the new character.
+         * @return      The id of the new character.
+         */
+        std::optional<size_t> add(const shaiya::net::CharacterListEntry& entry) override;
+
+    private:
+        /**
+         * The saved characters, keyed by id.
+         */
+        std::unordered_map<size_t, CharacterData> characters_;
+
+        /**
+         * The id to try for the next character that is added.
+         */
+        size_t nextId_{ 1 };
+
+        /**
+         * The mutex used for locking access to the saved characters.
+         */
+        std::mutex mutex_;
+    };
+}
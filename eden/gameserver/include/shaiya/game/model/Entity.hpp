@@ -77,7 +77,8 @@ namespace shaiya::game
         void setMotion(uint8_t motion);
 
         /**
-         * Checks if this entity can be observed by another.
+         * Checks if this entity can be observed by another. The client synchronizer tests the entities that a
+         * character observes in a single batch with SpatialQuery::select instead, so this is used for one-off checks.
          * @param other The entity trying to observe this entity.
          * @return      If the other entity can observe us.
          */
@@ -51,7 +51,7 @@ namespace shaiya::game
         [[nodiscard]] Position translate(float x, float y, float z) const;
 
         /**
-         * Checks if a position is within distance of another.
+         * Checks if a position is within distance of another, on the horizontal plane.
          * @param other     The other position.
          * @param distance  The distance.
          * @return          If the other position is in distance of this position.
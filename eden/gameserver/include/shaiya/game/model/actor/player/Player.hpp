@@ -7,6 +7,7 @@
 #include <shaiya/game/model/actor/player/Appearance.hpp>
 #include <shaiya/game/model/actor/player/request/RequestManager.hpp>
 
+#include <unordered_set>
 #include <vector>
 
 namespace shaiya::game
@@ -34,6 +35,24 @@ namespace shaiya::game
          */
         void activate() override;
 
+        /**
+         * Attaches this character to a new session, after it was resumed by a reconnecting client. The entities that
+         * the previous session observed are forgotten, so the new session receives its viewport from scratch.
+         * @param session   The new session.
+         */
+        void attach(shaiya::net::GameSession& session);
+
+        /**
+         * Detaches this character from its session, once the session has disconnected. The character must not be
+         * synchronised or sent its state until it is attached to a new session.
+         */
+        void detach();
+
+        /**
+         * Sends the state of this character to its session, such as its details, items and stats.
+         */
+        void sendState();
+
         /**
          * Sets the movement state of a character.
          * @param movementState The new movement state.
@@ -117,13 +136,41 @@ namespace shaiya::game
             return observedEntities_;
         }
 
+        /**
+         * Gets the observed entities whose movement updates have been deferred to a later tick.
+         * @return  The entities with pending movement.
+         */
+        [[nodiscard]] std::unordered_set<const Entity*>& pendingMovement()
+        {
+            return pendingMovement_;
+        }
+
         /**
          * Gets the session for this character.
          * @return  The session.
          */
         [[nodiscard]] shaiya::net::GameSession& session() const
         {
-            return session_;
+            return *session_;
+        }
+
+        /**
+         * Checks if this character is attached to a session.
+         * @return  If the character has a session.
+         */
+        [[nodiscard]] bool attached() const
+        {
+            return session_ != nullptr;
+        }
+
+        /**
+         * Gets the id of the account that owns this character. Unlike the session, this remains valid after the
+         * session has disconnected.
+         * @return  The account id.
+         */
+        [[nodiscard]] uint32_t userId() const
+        {
+            return userId_;
         }
 
         /**
@@ -148,7 +195,12 @@ namespace shaiya::game
         /**
          * The game session instance.
          */
-        shaiya::net::GameSession& session_;
+        shaiya::net::GameSession* session_;
+
+        /**
+         * The id of the account that owns this character.
+         */
+        uint32_t userId_{ 0 };
 
         /**
          * The number of unused stat points the character has available to them.
@@ -190,6 +242,11 @@ namespace shaiya::game
          */
         std::vector<std::shared_ptr<Entity>> observedEntities_;
 
+        /**
+         * The observed entities whose movement updates have been deferred to a later tick.
+         */
+        std::unordered_set<const Entity*> pendingMovement_;
+
         /**
          * This character's action bar.
          */
@@ -1,6 +1,7 @@
 #pragma once
 #include <shaiya/game/Forward.hpp>
 
+#include <cstdint>
 #include <memory>
 #include <tuple>
 #include <vector>
@@ -9,6 +10,54 @@ namespace shaiya::game
 {
     typedef std::tuple<std::shared_ptr<Item>, std::shared_ptr<Item>> ItemPair;  // A pair of items, represented as a tuple.
 
+    /**
+     * The types of change that can be made to a slot of a container.
+     */
+    enum class ItemChangeType
+    {
+        Added,
+        Removed,
+        QuantityChanged,
+        Moved
+    };
+
+    /**
+     * A change that was made to a slot of a container.
+     */
+    struct ItemChange
+    {
+        /**
+         * The type of change.
+         */
+        ItemChangeType type{ ItemChangeType::Added };
+
+        /**
+         * The slot that was changed.
+         */
+        size_t slot{ 0 };
+    };
+
+    /**
+     * The state of a changed slot, as it should be persisted. An item id of zero means the slot is now empty.
+     */
+    struct ItemDelta
+    {
+        /**
+         * The slot.
+         */
+        size_t slot{ 0 };
+
+        /**
+         * The id of the item definition in the slot.
+         */
+        uint32_t itemId{ 0 };
+
+        /**
+         * The quantity of the item in the slot.
+         */
+        size_t count{ 0 };
+    };
+
     /**
      * A container of items in the world.
      */
@@ -155,6 +204,26 @@ namespace shaiya::game
             return (page * pageSize_) + slot;
         }
 
+        /**
+         * Compacts the change journal into the current state of each slot that was changed, and clears the journal.
+         * @return  The state of the changed slots, in the order they were first changed.
+         */
+        std::vector<ItemDelta> takeChanges();
+
+        /**
+         * Clears the change journal, such as after the container has been populated from storage.
+         */
+        void clearChanges();
+
+        /**
+         * Gets the changes that have been made to this container since the journal was last cleared.
+         * @return  The change journal.
+         */
+        [[nodiscard]] const std::vector<ItemChange>& changes() const
+        {
+            return changes_;
+        }
+
         /**
          * Get the vector of items in this container.
          * @return  The vector of items.
@@ -165,6 +234,13 @@ namespace shaiya::game
         }
 
     protected:
+        /**
+         * Records a change to a slot in the change journal.
+         * @param type  The type of change.
+         * @param slot  The slot.
+         */
+        void record(ItemChangeType type, size_t slot);
+
         /**
          * The vector of items held by this container.
          */
@@ -175,6 +251,11 @@ namespace shaiya::game
          */
         std::vector<std::shared_ptr<ContainerEventListener>> listeners_;
 
+        /**
+         * The changes made to this container since the journal was last cleared.
+         */
+        std::vector<ItemChange> changes_;
+
     private:
         /**
          * The number of virtual "pages" in this container.
@@ -2,6 +2,7 @@
 #include <shaiya/common/client/map/World.hpp>
 #include <shaiya/game/Forward.hpp>
 #include <shaiya/game/model/EntityType.hpp>
+#include <shaiya/game/model/map/index/SpatialIndex.hpp>
 
 #include <fstream>
 #include <memory>
@@ -86,6 +87,39 @@ namespace shaiya::game
          */
         [[nodiscard]] std::vector<std::shared_ptr<MapCell>> getNeighbouringCells(Position& position) const;
 
+        /**
+         * Gets the entities inside a spatial query, such as the targets of an area of effect skill.
+         * @param query The spatial query.
+         * @return      The entities inside the query.
+         */
+        [[nodiscard]] std::vector<std::shared_ptr<Entity>> query(const SpatialQuery& query) const;
+
+        /**
+         * Gets the index of the tile that owns a position. A tile is a stripe of cell columns that may be simulated in
+         * parallel with the other tiles of this map.
+         * @param position  The position.
+         * @return          The tile index.
+         */
+        [[nodiscard]] size_t tileIndex(Position& position) const;
+
+        /**
+         * Gets the number of tiles that this map is partitioned into.
+         * @return  The tile count.
+         */
+        [[nodiscard]] size_t tileCount() const
+        {
+            return tileCount_;
+        }
+
+        /**
+         * Gets the spatial index of this map.
+         * @return  The spatial index.
+         */
+        [[nodiscard]] const SpatialIndex& index() const
+        {
+            return *index_;
+        }
+
         /**
          * Gets the heightmap for this map.
          * @return  The heightmap.
@@ -114,20 +148,6 @@ namespace shaiya::game
         }
 
     private:
-        /**
-         * Get a cell in the map based on a position.
-         * @param position  The position.
-         * @return          The map cell.
-         */
-        [[nodiscard]] std::shared_ptr<MapCell> getCell(Position& position) const;
-
-        /**
-         * Get a cell index  based on a position.
-         * @param position  The position.
-         * @return          The map cell.
-         */
-        [[nodiscard]] size_t getCellIndex(Position& position) const;
-
         /**
          * Adjusts a position to fit into the boundaries of this map.
          * @param position  The position to adjust.
@@ -150,19 +170,19 @@ namespace shaiya::game
         size_t size_{ 0 };
 
         /**
-         * The number of cell rows.
+         * The number of cell columns in a single tile.
          */
-        size_t rowCount_{ 0 };
+        size_t tileColumns_{ 0 };
 
         /**
-         * The number of cell columns.
+         * The number of tiles.
          */
-        size_t columnCount_{ 0 };
+        size_t tileCount_{ 1 };
 
         /**
-         * The cells of this map.
+         * The spatial index containing the entities of this map.
          */
-        std::vector<std::shared_ptr<MapCell>> cells_;
+        std::unique_ptr<SpatialIndex> index_;
 
         /**
          * The world file for this map.
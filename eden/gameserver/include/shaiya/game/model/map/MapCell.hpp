@@ -16,8 +16,9 @@ namespace shaiya::game
         /**
          * Adds an entity to this cell.
          * @param entity    The entity to add.
+         * @param position  The position of the entity.
          */
-        void addEntity(std::shared_ptr<Entity> entity);
+        void addEntity(std::shared_ptr<Entity> entity, const Position& position);
 
         /**
          * Removes an entity from this cell.
@@ -34,10 +35,43 @@ namespace shaiya::game
             return entities_;
         }
 
+        /**
+         * Appends the entities of this cell that are inside a query.
+         * @param query The spatial query.
+         * @param out   The vector to append the entities to.
+         */
+        void query(const SpatialQuery& query, std::vector<std::shared_ptr<Entity>>& out) const;
+
+        /**
+         * Checks if this cell contains no entities.
+         * @return  If the cell is empty.
+         */
+        [[nodiscard]] bool empty() const
+        {
+            return entities_.empty();
+        }
+
+        /**
+         * Gets an estimate of the heap memory used by this cell, including its shared allocation.
+         * @return  The memory usage, in bytes.
+         */
+        [[nodiscard]] size_t memoryUsage() const;
+
     private:
         /**
          * The entities that exist inside this cell.
          */
         std::vector<std::shared_ptr<Entity>> entities_;
+
+        /**
+         * The x coordinates of the entities, in the same order as the entities. The coordinates are kept as a separate
+         * array so that spatial queries can test several entities at once.
+         */
+        std::vector<float> xs_;
+
+        /**
+         * The z coordinates of the entities, in the same order as the entities.
+         */
+        std::vector<float> zs_;
     };
 }
\ No newline at end of file
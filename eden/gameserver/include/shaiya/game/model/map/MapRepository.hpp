@@ -1,6 +1,7 @@
 #pragma once
 #include <shaiya/game/Forward.hpp>
 
+#include <functional>
 #include <map>
 #include <memory>
 
@@ -14,10 +15,11 @@ namespace shaiya::game
     public:
         /**
          * Loads the map repository.
-         * @param path  The path to the world's map files.
-         * @param world The game world service.
+         * @param path      The path to the world's map files.
+         * @param world     The game world service.
+         * @param filter    The filter that decides which maps are loaded, by their id.
          */
-        void load(const std::string& path, GameWorldService& world);
+        void load(const std::string& path, GameWorldService& world, const std::function<bool(uint16_t)>& filter);
 
         /**
          * Gets a map for a specified id.
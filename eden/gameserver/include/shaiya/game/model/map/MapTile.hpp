@@ -0,0 +1,71 @@
+#pragma once
+#include <shaiya/game/model/map/Map.hpp>
+
+#include <algorithm>
+#include <compare>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace shaiya::game
+{
+    /**
+     * Identifies a tile of a map. A tile is a stripe of map cells that is owned by a single worker thread for the duration
+     * of a parallel phase of the world tick. Entities near the border of a tile are still visible to the neighbouring tiles,
+     * as observation reads the cells within the observable radius regardless of which tile owns them.
+     */
+    struct MapTile
+    {
+        /**
+         * The id of the map.
+         */
+        uint16_t map{ 0 };
+
+        /**
+         * The index of the tile within the map.
+         */
+        size_t index{ 0 };
+
+        /**
+         * Compares this tile to another, ordering them by their map id and then their index.
+         * @param other The other tile.
+         * @return      The ordering of the two tiles.
+         */
+        auto operator<=>(const MapTile& other) const = default;
+    };
+
+    /**
+     * Partitions a range of entities by the map tile that owns them. The tiles are ordered by their map id and index, and
+     * the entities of each tile are ordered by their id, so that the partition is deterministic between ticks.
+     * @tparam T        The entity type.
+     * @param entities  The entities to partition. Null and inactive entities are skipped.
+     * @return          The entities of each occupied tile.
+     */
+    template<typename T, typename Range>
+    std::vector<std::vector<std::shared_ptr<T>>> partitionByTile(const Range& entities)
+    {
+        std::map<MapTile, std::vector<std::shared_ptr<T>>> tiles;
+        for (auto&& entity: entities)
+        {
+            if (!entity || !entity->active())
+                continue;
+
+            auto map = entity->map();
+            if (!map)
+                continue;
+
+            MapTile tile{ .map = map->id(), .index = map->tileIndex(entity->position()) };
+            tiles[tile].push_back(entity);
+        }
+
+        // Flatten the tiles into their entity vectors
+        std::vector<std::vector<std::shared_ptr<T>>> partition;
+        partition.reserve(tiles.size());
+        for (auto&& [tile, members]: tiles)
+        {
+            std::sort(members.begin(), members.end(), [](auto& a, auto& b) { return a->id() < b->id(); });
+            partition.push_back(std::move(members));
+        }
+        return partition;
+    }
+}
@@ -0,0 +1,172 @@
+#pragma once
+#include <shaiya/game/model/Position.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace shaiya::game
+{
+    /**
+     * A region of a map that entities can be queried against, such as the area of effect of a skill or the aggro range of
+     * a mob. All shapes are tested on the horizontal plane, using squared distances.
+     */
+    class SpatialQuery
+    {
+    public:
+        /**
+         * Creates a query for the entities within a radius of a position.
+         * @param center    The center of the circle.
+         * @param radius    The radius.
+         * @return          The query.
+         */
+        static SpatialQuery circle(const Position& center, float radius);
+
+        /**
+         * Creates a query for the entities within an axis-aligned rectangle.
+         * @param bottomLeft    The bottom-left corner.
+         * @param topRight      The top-right corner.
+         * @return              The query.
+         */
+        static SpatialQuery rectangle(const Position& bottomLeft, const Position& topRight);
+
+        /**
+         * Creates a query for the entities within a cone.
+         * @param origin    The origin of the cone.
+         * @param towards   A position that the cone is facing.
+         * @param radius    The length of the cone.
+         * @param angle     The full angle of the cone, in degrees.
+         * @return          The query.
+         */
+        static SpatialQuery cone(const Position& origin, const Position& towards, float radius, float angle);
+
+        /**
+         * Creates a query for the entities within the viewport of a position.
+         * @param center    The position of the observer.
+         * @return          The query.
+         */
+        static SpatialQuery viewport(const Position& center);
+
+        /**
+         * Checks if a position is inside this query.
+         * @param position  The position.
+         * @return          If the position is inside the query.
+         */
+        [[nodiscard]] bool contains(const Position& position) const;
+
+        /**
+         * Checks if a set of coordinates is inside this query. The map is not checked.
+         * @param x The x coordinate.
+         * @param z The z coordinate.
+         * @return  If the coordinates are inside the query.
+         */
+        [[nodiscard]] bool contains(float x, float z) const;
+
+        /**
+         * Selects the coordinates that are inside this query, from a structure-of-arrays set of coordinates.
+         * @param xs    The x coordinates.
+         * @param zs    The z coordinates.
+         * @param count The number of coordinates.
+         * @param out   The output indices, which must have room for at least count elements.
+         * @return      The number of selected indices.
+         */
+        size_t select(const float* xs, const float* zs, size_t count, uint32_t* out) const;
+
+        /**
+         * Gets the bottom-left corner of the bounding box of this query.
+         * @return  The bottom-left corner.
+         */
+        [[nodiscard]] Position min() const
+        {
+            return Position(map_, minX_, 0, minZ_);
+        }
+
+        /**
+         * Gets the top-right corner of the bounding box of this query.
+         * @return  The top-right corner.
+         */
+        [[nodiscard]] Position max() const
+        {
+            return Position(map_, maxX_, 0, maxZ_);
+        }
+
+        /**
+         * Gets the id of the map this query is on.
+         * @return  The map id.
+         */
+        [[nodiscard]] uint16_t map() const
+        {
+            return map_;
+        }
+
+    private:
+        /**
+         * The shape of a query.
+         */
+        enum class Shape
+        {
+            Circle,
+            Rectangle,
+            Cone
+        };
+
+        /**
+         * The shape of this query.
+         */
+        Shape shape_{ Shape::Circle };
+
+        /**
+         * The id of the map.
+         */
+        uint16_t map_{ 0 };
+
+        /**
+         * The x coordinate of the center or origin of the query.
+         */
+        float x_{ 0 };
+
+        /**
+         * The z coordinate of the center or origin of the query.
+         */
+        float z_{ 0 };
+
+        /**
+         * The squared radius of a circle or cone.
+         */
+        float radiusSquared_{ 0 };
+
+        /**
+         * The x component of the normalised direction of a cone.
+         */
+        float directionX_{ 0 };
+
+        /**
+         * The z component of the normalised direction of a cone.
+         */
+        float directionZ_{ 0 };
+
+        /**
+         * The cosine of half the angle of a cone.
+         */
+        float cosine_{ 0 };
+
+        /**
+         * The minimum x coordinate of the bounding box.
+         */
+        float minX_{ 0 };
+
+        /**
+         * The minimum z coordinate of the bounding box.
+         */
+        float minZ_{ 0 };
+
+        /**
+         * The maximum x coordinate of the bounding box.
+         */
+        float maxX_{ 0 };
+
+        /**
+         * The maximum z coordinate of the bounding box.
+         */
+        float maxZ_{ 0 };
+    };
+}
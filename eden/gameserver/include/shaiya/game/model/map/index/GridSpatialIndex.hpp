@@ -0,0 +1,62 @@
+#pragma once
+#include <shaiya/game/model/map/index/SpatialIndex.hpp>
+
+namespace shaiya::game
+{
+    /**
+     * A spatial index that allocates every cell of the map up front. Lookups are a single array access, which makes this
+     * the best fit for open fields where entities are spread over most of the map.
+     */
+    class GridSpatialIndex: public SpatialIndex
+    {
+    public:
+        /**
+         * Initialises this index, and allocates the cells.
+         * @param size  The size of the map.
+         */
+        explicit GridSpatialIndex(size_t size);
+
+        /**
+         * Adds an entity to the cell containing a position.
+         * @param entity    The entity to add.
+         * @param position  The position of the entity.
+         */
+        void add(const std::shared_ptr<Entity>& entity, const Position& position) override;
+
+        /**
+         * Removes an entity from the cell containing a position.
+         * @param entity    The entity to remove.
+         * @param position  The position of the entity.
+         */
+        void remove(const std::shared_ptr<Entity>& entity, const Position& position) override;
+
+        /**
+         * Gets the number of cells that are currently allocated by this index.
+         * @return  The cell count.
+         */
+        [[nodiscard]] size_t cellCount() const override
+        {
+            return cells_.size();
+        }
+
+        /**
+         * Gets an estimate of the heap memory used by this index, including its cells.
+         * @return  The memory usage, in bytes.
+         */
+        [[nodiscard]] size_t memoryUsage() const override;
+
+    protected:
+        /**
+         * Gets the cells within a set of bounds.
+         * @param bounds    The cell bounds.
+         * @return          The cells.
+         */
+        [[nodiscard]] std::vector<std::shared_ptr<MapCell>> cells(const CellBounds& bounds) const override;
+
+    private:
+        /**
+         * The cells of the map.
+         */
+        std::vector<std::shared_ptr<MapCell>> cells_;
+    };
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <shaiya/game/model/map/index/SpatialIndex.hpp>
+
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace shaiya::game
+{
+    /**
+     * A spatial index that only allocates the cells that are occupied, keyed by their position in the grid. Cells are
+     * released once they become empty, which keeps the footprint of small dungeons and sparsely populated maps
+     * proportional to their population rather than their size.
+     */
+    class SparseSpatialIndex: public SpatialIndex
+    {
+    public:
+        /**
+         * Initialises this index.
+         * @param size  The size of the map.
+         */
+        explicit SparseSpatialIndex(size_t size);
+
+        /**
+         * Adds an entity to the cell containing a position, allocating the cell if needed.
+         * @param entity    The entity to add.
+         * @param position  The position of the entity.
+         */
+        void add(const std::shared_ptr<Entity>& entity, const Position& position) override;
+
+        /**
+         * Removes an entity from the cell containing a position, releasing the cell if it is now empty.
+         * @param entity    The entity to remove.
+         * @param position  The position of the entity.
+         */
+        void remove(const std::shared_ptr<Entity>& entity, const Position& position) override;
+
+        /**
+         * Gets the number of cells that are currently allocated by this index.
+         * @return  The cell count.
+         */
+        [[nodiscard]] size_t cellCount() const override;
+
+        /**
+         * Gets an estimate of the heap memory used by this index, including its cells.
+         * @return  The memory usage, in bytes.
+         */
+        [[nodiscard]] size_t memoryUsage() const override;
+
+    protected:
+        /**
+         * Gets the occupied cells within a set of bounds.
+         * @param bounds    The cell bounds.
+         * @return          The cells.
+         */
+        [[nodiscard]] std::vector<std::shared_ptr<MapCell>> cells(const CellBounds& bounds) const override;
+
+    private:
+        /**
+         * The occupied cells, keyed by their cell key.
+         */
+        std::unordered_map<size_t, std::shared_ptr<MapCell>> cells_;
+
+        /**
+         * The mutex protecting the cells. Entities in different map tiles may be moved in parallel, which would otherwise
+         * race on the cell table.
+         */
+        mutable std::shared_mutex mutex_;
+    };
+}
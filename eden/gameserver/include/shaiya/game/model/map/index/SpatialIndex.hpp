@@ -0,0 +1,164 @@
+#pragma once
+#include <shaiya/game/Forward.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace shaiya::game
+{
+    /**
+     * A spatial index partitions the entities of a map into 16x16 cells, so that localised events only need to search the
+     * cells surrounding a position. Implementations differ in how the cells are stored, but must all answer neighbourhood
+     * queries identically.
+     */
+    class SpatialIndex
+    {
+    public:
+        /**
+         * The size of a cell (16x16).
+         */
+        static constexpr size_t CELL_SIZE = 16;
+
+        /**
+         * The observable radius from a center cell.
+         */
+        static constexpr size_t OBSERVABLE_CELL_RADIUS = 3;
+
+        /**
+         * Initialises this index.
+         * @param size  The size of the map.
+         */
+        explicit SpatialIndex(size_t size);
+
+        /**
+         * Destroys this index.
+         */
+        virtual ~SpatialIndex() = default;
+
+        /**
+         * Adds an entity to the cell containing a position.
+         * @param entity    The entity to add.
+         * @param position  The position of the entity.
+         */
+        virtual void add(const std::shared_ptr<Entity>& entity, const Position& position) = 0;
+
+        /**
+         * Removes an entity from the cell containing a position.
+         * @param entity    The entity to remove.
+         * @param position  The position of the entity.
+         */
+        virtual void remove(const std::shared_ptr<Entity>& entity, const Position& position) = 0;
+
+        /**
+         * Gets the cells in a neighbouring radius of a position. Cells that don't exist are skipped.
+         * @param position  The position.
+         * @return          The neighbouring cells.
+         */
+        [[nodiscard]] std::vector<std::shared_ptr<MapCell>> neighbours(const Position& position) const;
+
+        /**
+         * Gets the cells that overlap a rectangular area. Cells that don't exist are skipped.
+         * @param bottomLeft    The bottom-left corner of the area.
+         * @param topRight      The top-right corner of the area.
+         * @return              The overlapping cells.
+         */
+        [[nodiscard]] std::vector<std::shared_ptr<MapCell>> cellsWithin(const Position& bottomLeft,
+                                                                        const Position& topRight) const;
+
+        /**
+         * Gets the number of cells that are currently allocated by this index.
+         * @return  The cell count.
+         */
+        [[nodiscard]] virtual size_t cellCount() const = 0;
+
+        /**
+         * Gets an estimate of the heap memory used by this index, including its cells.
+         * @return  The memory usage, in bytes.
+         */
+        [[nodiscard]] virtual size_t memoryUsage() const = 0;
+
+        /**
+         * Gets the row of the cell containing a position.
+         * @param position  The position.
+         * @return          The row.
+         */
+        [[nodiscard]] size_t row(const Position& position) const;
+
+        /**
+         * Gets the column of the cell containing a position.
+         * @param position  The position.
+         * @return          The column.
+         */
+        [[nodiscard]] size_t column(const Position& position) const;
+
+        /**
+         * Gets the number of cell rows.
+         * @return  The row count.
+         */
+        [[nodiscard]] size_t rowCount() const
+        {
+            return rowCount_;
+        }
+
+        /**
+         * Gets the number of cell columns.
+         * @return  The column count.
+         */
+        [[nodiscard]] size_t columnCount() const
+        {
+            return columnCount_;
+        }
+
+    protected:
+        /**
+         * The inclusive bounds of the cells within the observable radius of a position.
+         */
+        struct CellBounds
+        {
+            size_t minRow{ 0 };
+            size_t maxRow{ 0 };
+            size_t minColumn{ 0 };
+            size_t maxColumn{ 0 };
+        };
+
+        /**
+         * Gets the bounds of the cells within the observable radius of a position, clamped to the edges of the map.
+         * @param position  The position.
+         * @return          The cell bounds.
+         */
+        [[nodiscard]] CellBounds observableBounds(const Position& position) const;
+
+        /**
+         * Gets the cells within a set of bounds. Cells that don't exist are skipped.
+         * @param bounds    The cell bounds.
+         * @return          The cells.
+         */
+        [[nodiscard]] virtual std::vector<std::shared_ptr<MapCell>> cells(const CellBounds& bounds) const = 0;
+
+        /**
+         * Gets the key of a cell, which is unique for every cell of the map.
+         * @param row       The row.
+         * @param column    The column.
+         * @return          The cell key.
+         */
+        [[nodiscard]] size_t cellKey(size_t row, size_t column) const
+        {
+            return row + (column * rowCount_);
+        }
+
+        /**
+         * The size of the map.
+         */
+        size_t size_{ 0 };
+
+        /**
+         * The number of cell rows.
+         */
+        size_t rowCount_{ 0 };
+
+        /**
+         * The number of cell columns.
+         */
+        size_t columnCount_{ 0 };
+    };
+}
@@ -7,12 +7,18 @@
 #include <glog/logging.h>
 
 #include <array>
+#include <atomic>
 #include <crypto++/aes.h>
 #include <crypto++/modes.h>
 #include <deque>
 #include <mutex>
 #include <vector>
 
+namespace gameapi
+{
+    class SessionTransferRequest;
+}
+
 namespace shaiya::net
 {
     /**
@@ -46,10 +52,54 @@ namespace shaiya::net
             }
 
             Session::write((const char*)data, length);
+            bytesWritten_ += length;
             delete[] data;
             return *this;
         }
 
+        /**
+         * Gets the total number of bytes written to this session.
+         * @return  The bytes written.
+         */
+        [[nodiscard]] uint64_t bytesWritten() const
+        {
+            return bytesWritten_;
+        }
+
+        /**
+         * Records that a movement update was deferred to a later tick by the synchronization policy.
+         */
+        void recordDeferredUpdate()
+        {
+            deferredUpdates_++;
+        }
+
+        /**
+         * Records that a movement update was superseded by a newer one before it could be sent.
+         */
+        void recordDroppedUpdate()
+        {
+            droppedUpdates_++;
+        }
+
+        /**
+         * Gets the number of movement updates that were deferred to a later tick.
+         * @return  The deferred update count.
+         */
+        [[nodiscard]] uint64_t deferredUpdates() const
+        {
+            return deferredUpdates_;
+        }
+
+        /**
+         * Gets the number of movement updates that were superseded before they could be sent.
+         * @return  The dropped update count.
+         */
+        [[nodiscard]] uint64_t droppedUpdates() const
+        {
+            return droppedUpdates_;
+        }
+
         /**
          * This gets executed when the game session is accepted and connected to the server.
          */
@@ -70,8 +120,10 @@ namespace shaiya::net
 
         /**
          * Processes the queue of packets that are yet to be processed.
+         * @param limit The maximum number of packets to process, or 0 to process every queued packet. Packets beyond the
+         *              limit remain queued for the next tick.
          */
-        void processQueue();
+        void processQueue(size_t limit = 0);
 
         /**
          * Sets the user id for this session.
@@ -85,6 +137,22 @@ namespace shaiya::net
          */
         void setFaction(ShaiyaFaction faction);
 
+        /**
+         * Sets the session transfer that this session was accepted with.
+         * @param transfer  The session transfer.
+         */
+        void setTransfer(std::shared_ptr<const gameapi::SessionTransferRequest> transfer);
+
+        /**
+         * Gets the session transfer that this session was accepted with, which is passed on when the session's player
+         * is handed off to another zone.
+         * @return  The session transfer, or null if the session hasn't completed its handshake.
+         */
+        [[nodiscard]] const std::shared_ptr<const gameapi::SessionTransferRequest>& transfer() const
+        {
+            return transfer_;
+        }
+
         /**
          * Gets the user id that this session was authenticated as.
          * @return  This session's user id
@@ -156,6 +224,11 @@ namespace shaiya::net
          */
         ShaiyaFaction faction_{ ShaiyaFaction::Neither };
 
+        /**
+         * The session transfer that this session was accepted with.
+         */
+        std::shared_ptr<const gameapi::SessionTransferRequest> transfer_;
+
         /**
          * The player associated with this session.
          */
@@ -200,5 +273,20 @@ namespace shaiya::net
          * The queue of packets that are yet to be processed.
          */
         std::deque<std::vector<char>> queuedPackets_;
+
+        /**
+         * The total number of bytes written to this session.
+         */
+        std::atomic<uint64_t> bytesWritten_{ 0 };
+
+        /**
+         * The number of movement updates that were deferred to a later tick.
+         */
+        std::atomic<uint64_t> deferredUpdates_{ 0 };
+
+        /**
+         * The number of movement updates that were superseded before they could be sent.
+         */
+        std::atomic<uint64_t> droppedUpdates_{ 0 };
     };
 }
\ No newline at end of file
@@ -0,0 +1,161 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace shaiya::game
+{
+    /**
+     * The degradation levels of the game world. Each level also applies the measures of the levels below it.
+     */
+    enum class LoadLevel : uint8_t
+    {
+        Normal        = 0,  // The world is keeping up with the tick rate.
+        ReducedSync   = 1,  // Far entities are synchronized less frequently.
+        DeferredTasks = 2,  // Non-urgent scheduled tasks run less frequently.
+        PacketCap     = 3,  // The number of packets processed per session per tick is capped.
+        DormantPaused = 4,  // Mobs with no players nearby stop wandering.
+    };
+
+    /**
+     * The time spent in each phase of a world tick.
+     */
+    struct TickPhases
+    {
+        /**
+         * The time spent finalising player registrations and unregistrations.
+         */
+        std::chrono::microseconds registrations{ 0 };
+
+        /**
+         * The time spent processing queued packets.
+         */
+        std::chrono::microseconds packets{ 0 };
+
+        /**
+         * The time spent pulsing scheduled tasks.
+         */
+        std::chrono::microseconds scheduler{ 0 };
+
+        /**
+         * The time spent synchronizing clients.
+         */
+        std::chrono::microseconds sync{ 0 };
+
+        /**
+         * Gets the total time spent in the tick.
+         * @return  The total time.
+         */
+        [[nodiscard]] std::chrono::microseconds total() const
+        {
+            return registrations + packets + scheduler + sync;
+        }
+    };
+
+    /**
+     * A feedback controller that sheds load when the world tick overruns its tick rate. The controller tracks a smoothed
+     * utilisation of the tick, and raises the degradation level while the world is under sustained pressure. Once the
+     * load has dropped for long enough, the level is lowered again one step at a time.
+     */
+    class LoadController
+    {
+    public:
+        /**
+         * Updates the controller with the measured phase times of the last tick.
+         * @param phases    The phase times.
+         * @param tickRate  The duration of a tick.
+         */
+        void update(const TickPhases& phases, std::chrono::milliseconds tickRate);
+
+        /**
+         * Gets the current degradation level.
+         * @return  The degradation level.
+         */
+        [[nodiscard]] LoadLevel level() const
+        {
+            return level_;
+        }
+
+        /**
+         * Gets the factor to multiply the synchronization interval of far entities by.
+         * @return  The interval scale.
+         */
+        [[nodiscard]] size_t syncIntervalScale() const;
+
+        /**
+         * Checks if non-urgent scheduled tasks should be deferred.
+         * @return  If tasks should be deferred.
+         */
+        [[nodiscard]] bool deferTasks() const
+        {
+            return level_ >= LoadLevel::DeferredTasks;
+        }
+
+        /**
+         * Gets the maximum number of packets to process for a session in a tick.
+         * @return  The packet cap, or 0 if the number of packets is unlimited.
+         */
+        [[nodiscard]] size_t packetCap() const;
+
+        /**
+         * Checks if dormant mobs should stop wandering.
+         * @return  If dormant mobs are paused.
+         */
+        [[nodiscard]] bool pauseDormant() const
+        {
+            return level_ >= LoadLevel::DormantPaused;
+        }
+
+        /**
+         * Gets a percentile of the time taken by the recent ticks. This may be called from any thread.
+         * @param percentile    The percentile, between 0 and 1.
+         * @return              The tick time.
+         */
+        [[nodiscard]] std::chrono::microseconds tickTime(double percentile) const;
+
+    private:
+        /**
+         * The number of recent ticks whose times are kept (12.8s at a 50ms tick rate).
+         */
+        static constexpr size_t TICK_HISTORY = 256;
+
+        /**
+         * Changes the degradation level.
+         * @param level     The new level.
+         * @param phases    The phase times of the tick that triggered the change.
+         */
+        void setLevel(LoadLevel level, const TickPhases& phases);
+
+        /**
+         * The smoothed utilisation of the tick, where 1.0 means the tick took exactly as long as the tick rate.
+         */
+        double utilisation_{ 0 };
+
+        /**
+         * The number of consecutive ticks spent above the escalation threshold.
+         */
+        size_t pressure_{ 0 };
+
+        /**
+         * The number of consecutive ticks spent below the recovery threshold.
+         */
+        size_t calm_{ 0 };
+
+        /**
+         * The current degradation level. This may be read by other threads, such as the world api.
+         */
+        std::atomic<LoadLevel> level_{ LoadLevel::Normal };
+
+        /**
+         * The times of the recent ticks in microseconds, as a ring buffer.
+         */
+        std::array<std::atomic<int64_t>, TICK_HISTORY> tickTimes_{};
+
+        /**
+         * The number of ticks that have been measured.
+         */
+        std::atomic<size_t> ticks_{ 0 };
+    };
+}
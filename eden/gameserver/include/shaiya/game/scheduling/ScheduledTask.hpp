@@ -33,6 +33,15 @@ namespace shaiya::game
          */
         void stop();
 
+        /**
+         * Checks if this task is urgent. Tasks that aren't urgent may be deferred while the world is overloaded.
+         * @return  If the task is urgent.
+         */
+        [[nodiscard]] virtual bool urgent() const
+        {
+            return true;
+        }
+
         /**
          * Checks if this task is running.
          * @return  If the task is running.
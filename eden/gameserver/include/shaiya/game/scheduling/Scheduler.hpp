@@ -25,7 +25,26 @@ namespace shaiya::game
          */
         void schedule(std::shared_ptr<ScheduledTask> task);
 
+        /**
+         * Sets whether non-urgent tasks should be deferred.
+         * @param deferring If tasks should be deferred.
+         */
+        void setDeferring(bool deferring)
+        {
+            deferring_ = deferring;
+        }
+
     private:
+        /**
+         * If non-urgent tasks are being deferred.
+         */
+        bool deferring_{ false };
+
+        /**
+         * The number of times this scheduler has been pulsed.
+         */
+        size_t pulses_{ 0 };
+
         /**
          * The pending tasks.
          */
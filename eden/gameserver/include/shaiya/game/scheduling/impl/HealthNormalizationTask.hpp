@@ -21,6 +21,15 @@ namespace shaiya::game
          */
         void execute(GameWorldService& world) override;
 
+        /**
+         * Checks if this task is urgent.
+         * @return  False, as this task may be deferred while the world is overloaded.
+         */
+        [[nodiscard]] bool urgent() const override
+        {
+            return false;
+        }
+
     private:
         /**
          * The actor who this task is to operate on.
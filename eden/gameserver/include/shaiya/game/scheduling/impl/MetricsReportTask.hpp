@@ -0,0 +1,40 @@
+#pragma once
+#include <shaiya/game/Forward.hpp>
+#include <shaiya/game/scheduling/ScheduledTask.hpp>
+
+namespace shaiya::game
+{
+    /**
+     * A task that periodically logs a summary of the world's services, such as the hit rates of their caches.
+     */
+    class MetricsReportTask: public ScheduledTask
+    {
+    public:
+        /**
+         * Initialise this task.
+         * @param context   The service context.
+         * @param interval  The interval between reports, in ticks.
+         */
+        MetricsReportTask(ServiceContext& context, size_t interval);
+
+        /**
+         * Handle the execution of this task.
+         */
+        void execute(GameWorldService& world) override;
+
+        /**
+         * Checks if this task is urgent.
+         * @return  False, as this task may be deferred while the world is overloaded.
+         */
+        [[nodiscard]] bool urgent() const override
+        {
+            return false;
+        }
+
+    private:
+        /**
+         * The service context.
+         */
+        ServiceContext& context_;
+    };
+}
\ No newline at end of file
@@ -19,5 +19,14 @@ namespace shaiya::game
          * Handle the execution of this task.
          */
         void execute(GameWorldService& world) override;
+
+        /**
+         * Checks if this task is urgent.
+         * @return  False, as this task may be deferred while the world is overloaded.
+         */
+        [[nodiscard]] bool urgent() const override
+        {
+            return false;
+        }
     };
 }
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+#include <shaiya/game/Forward.hpp>
+#include <shaiya/game/io/PlayerSnapshot.hpp>
+#include <shaiya/game/scheduling/ScheduledTask.hpp>
+
+#include <unordered_map>
+
+namespace shaiya::game
+{
+    /**
+     * A task that periodically snapshots the players whose state has changed, and submits them to be saved.
+     */
+    class PlayerPersistenceTask: public ScheduledTask
+    {
+    public:
+        /**
+         * Initialise this task.
+         * @param persistence   The persistence service.
+         * @param interval      The interval between snapshots, in ticks.
+         */
+        PlayerPersistenceTask(PersistenceService& persistence, size_t interval);
+
+        /**
+         * Handle the execution of this task.
+         */
+        void execute(GameWorldService& world) override;
+
+    private:
+        /**
+         * The persistence service.
+         */
+        PersistenceService& persistence_;
+
+        /**
+         * The last snapshot that was submitted for each player, keyed by character id.
+         */
+        std::unordered_map<size_t, PlayerSnapshot> submitted_;
+    };
+}
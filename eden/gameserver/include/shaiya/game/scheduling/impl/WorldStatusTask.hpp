@@ -0,0 +1,31 @@
+#pragma once
+#include <shaiya/game/Forward.hpp>
+#include <shaiya/game/scheduling/ScheduledTask.hpp>
+
+namespace shaiya::game
+{
+    /**
+     * A task that publishes the status of the world to the api service on every tick, which wakes the status streams
+     * whenever the status changes.
+     */
+    class WorldStatusTask: public ScheduledTask
+    {
+    public:
+        /**
+         * Initialise this task.
+         * @param api   The api service.
+         */
+        explicit WorldStatusTask(WorldApiService& api);
+
+        /**
+         * Handle the execution of this task.
+         */
+        void execute(GameWorldService& world) override;
+
+    private:
+        /**
+         * The api service.
+         */
+        WorldApiService& api_;
+    };
+}
\ No newline at end of file
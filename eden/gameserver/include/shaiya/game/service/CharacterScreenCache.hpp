@@ -0,0 +1,197 @@
+#pragma once
+#include <shaiya/common/DataTypes.hpp>
+#include <shaiya/common/net/packet/game/CharacterList.hpp>
+#include <shaiya/game/Forward.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace shaiya::game
+{
+    /**
+     * A per-account cache of the character screen. Each account's faction and character list are kept as the packets
+     * that are sent to the client, so a cached visit to the character screen doesn't touch the database. Entries are
+     * updated in place when the account changes its faction, creates a character, or saves a character on logout, and
+     * are evicted when the cache is full, in least recently used order, or once they have been idle for too long.
+     */
+    class CharacterScreenCache
+    {
+    public:
+        /**
+         * Initialises the cache.
+         * @param capacity  The maximum number of accounts to cache.
+         * @param ttl       The time an entry may be idle before it expires.
+         */
+        CharacterScreenCache(size_t capacity, std::chrono::seconds ttl);
+
+        /**
+         * Gets the cached faction of an account.
+         * @param userId    The id of the account.
+         * @return          The faction, or an empty optional if it isn't cached.
+         */
+        std::optional<ShaiyaFaction> faction(uint32_t userId);
+
+        /**
+         * Gets the cached character list of an account.
+         * @param userId    The id of the account.
+         * @return          The character list packets, or an empty optional if they aren't cached.
+         */
+        std::optional<std::vector<shaiya::net::CharacterListEntry>> characters(uint32_t userId);
+
+        /**
+         * Gets the id of the character that an account last played, if it logged out while the account was cached.
+         * @param userId    The id of the account.
+         * @return          The id of the character, or an empty optional if it isn't known.
+         */
+        std::optional<uint32_t> lastPlayed(uint32_t userId);
+
+        /**
+         * Caches the faction of an account.
+         * @param userId    The id of the account.
+         * @param faction   The faction.
+         */
+        void setFaction(uint32_t userId, ShaiyaFaction faction);
+
+        /**
+         * Caches the character list of an account.
+         * @param userId        The id of the account.
+         * @param characters    The character list packets.
+         */
+        void setCharacters(uint32_t userId, std::vector<shaiya::net::CharacterListEntry> characters);
+
+        /**
+         * Updates the cached character list entry of a character that was saved, if the account is cached, and
+         * records it as the account's last played character.
+         * @param userId    The id of the account.
+         * @param snapshot  The snapshot of the character.
+         */
+        void update(uint32_t userId, const PlayerSnapshot& snapshot);
+
+        /**
+         * Copies the state of a saved character onto its character list entry.
+         * @param character The character list entry.
+         * @param snapshot  The snapshot of the character.
+         */
+        static void apply(shaiya::net::CharacterListEntry& character, const PlayerSnapshot& snapshot);
+
+        /**
+         * Gets the number of lookups that were served from the cache.
+         * @return  The number of hits.
+         */
+        [[nodiscard]] size_t hits() const
+        {
+            return hits_;
+        }
+
+        /**
+         * Gets the number of lookups that had to go to the database.
+         * @return  The number of misses.
+         */
+        [[nodiscard]] size_t misses() const
+        {
+            return misses_;
+        }
+
+        /**
+         * Summarises the size of the cache, and how often it was hit.
+         * @return  The summary
+         */
+        [[nodiscard]] std::string report() const;
+
+    private:
+        /**
+         * The cached character screen of an account.
+         */
+        struct Entry
+        {
+            /**
+             * The faction of the account.
+             */
+            std::optional<ShaiyaFaction> faction;
+
+            /**
+             * The character list packets.
+             */
+            std::optional<std::vector<shaiya::net::CharacterListEntry>> characters;
+
+            /**
+             * The id of the character that was last played.
+             */
+            std::optional<uint32_t> lastPlayed;
+
+            /**
+             * The time at which the entry was last used.
+             */
+            std::chrono::steady_clock::time_point lastUsed;
+
+            /**
+             * The position of the account in the recency list.
+             */
+            std::list<uint32_t>::iterator recency;
+        };
+
+        /**
+         * Gets the live entry of an account, and marks it as the most recently used. This must be called while holding
+         * the mutex.
+         * @param userId    The id of the account.
+         * @return          The entry, or null if the account isn't cached or its entry has expired.
+         */
+        Entry* find(uint32_t userId);
+
+        /**
+         * Gets the entry of an account, creating it if it doesn't exist, and marks it as the most recently used. This
+         * must be called while holding the mutex.
+         * @param userId    The id of the account.
+         * @return          The entry.
+         */
+        Entry& obtain(uint32_t userId);
+
+        /**
+         * Removes the entry of an account. This must be called while holding the mutex.
+         * @param userId    The id of the account.
+         */
+        void remove(uint32_t userId);
+
+        /**
+         * The maximum number of accounts to cache.
+         */
+        size_t capacity_{ 0 };
+
+        /**
+         * The time an entry may be idle before it expires.
+         */
+        std::chrono::seconds ttl_;
+
+        /**
+         * The cached entries, keyed by account id.
+         */
+        std::unordered_map<uint32_t, Entry> entries_;
+
+        /**
+         * The cached account ids, from the most to the least recently used.
+         */
+        std::list<uint32_t> recency_;
+
+        /**
+         * The mutex used for locking access to the cache.
+         */
+        mutable std::mutex mutex_;
+
+        /**
+         * The number of lookups that were served from the cache.
+         */
+        std::atomic<size_t> hits_{ 0 };
+
+        /**
+         * The number of lookups that had to go to the database.
+         */
+        std::atomic<size_t> misses_{ 0 };
+    };
+}
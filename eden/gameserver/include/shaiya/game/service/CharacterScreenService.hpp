@@ -1,31 +1,44 @@
 #pragma once
 #include <shaiya/common/DataTypes.hpp>
-#include <shaiya/common/db/DatabaseService.hpp>
+#include <shaiya/common/db/AsyncDatabaseService.hpp>
 #include <shaiya/common/net/packet/game/CharacterCreation.hpp>
 #include <shaiya/common/net/packet/game/CharacterList.hpp>
+#include <shaiya/common/util/Coroutine.hpp>
 #include <shaiya/game/Forward.hpp>
+#include <shaiya/game/service/CharacterScreenCache.hpp>
+
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
 
 namespace shaiya::game
 {
     /**
      * A service that is responsible for handling character screen operations, such as displaying the character screen,
-     * selecting a new faction, and the creation, deletion and restoration of characters.
+     * selecting a new faction, and the creation, deletion and restoration of characters. Without a database, the
+     * factions and characters of the accounts are kept in memory, and don't outlive the process.
      */
     class CharacterScreenService
     {
     public:
         /**
          * Initialises the character screen service.
-         * @param db        The database service to use.
-         * @param worldId   The id of this world server.
+         * @param db            The asynchronous database service to use, or null to keep the accounts in memory.
+         * @param worldId       The id of this world server.
+         * @param cacheSize     The maximum number of accounts whose character screen is cached.
+         * @param cacheTtl      The time a cached character screen may be idle before it expires.
          */
-        explicit CharacterScreenService(shaiya::database::DatabaseService& db, uint32_t worldId);
+        CharacterScreenService(shaiya::database::AsyncDatabaseService* db, uint32_t worldId, size_t cacheSize,
+                               std::chrono::seconds cacheTtl);
 
         /**
-         * Displays the character screen for a session.
+         * Displays the character screen for a session. The faction and character list are served from the cache when
+         * possible, and are otherwise read from the database and cached. The character that the player is most likely
+         * to select is then prefetched.
          * @param session   The session.
          */
-        void display(shaiya::net::GameSession& session);
+        boost::asio::awaitable<void> display(shaiya::net::GameSession& session);
 
         /**
          * Sets the faction for a session.
@@ -33,7 +46,7 @@ namespace shaiya::game
          * @param faction   The selected faction.
          * @return          If the faction select failed.
          */
-        bool setFaction(shaiya::net::GameSession& session, ShaiyaFaction faction);
+        boost::asio::awaitable<bool> setFaction(shaiya::net::GameSession& session, ShaiyaFaction faction);
 
         /**
          * Attempts to create a new character for the session.
@@ -49,33 +62,93 @@ namespace shaiya::game
          * @param name      The name of the character
          * @return          The result of the character creation
          */
-        shaiya::net::CharacterCreateResult createCharacter(shaiya::net::GameSession& session, int slot, int race, int mode,
-                                                           int hair, int face, int height, int job, int gender,
-                                                           std::string name);
+        boost::asio::awaitable<shaiya::net::CharacterCreateResult> createCharacter(shaiya::net::GameSession& session,
+                                                                                   int slot, int race, int mode, int hair,
+                                                                                   int face, int height, int job, int gender,
+                                                                                   std::string name);
+
+        /**
+         * Updates the cached character screen of an account, after one of its characters has been saved on logout.
+         * @param userId    The id of the account.
+         * @param snapshot  The final snapshot of the character.
+         */
+        void characterSaved(uint32_t userId, const PlayerSnapshot& snapshot);
+
+        /**
+         * Gets the character screen cache.
+         * @return  The cache.
+         */
+        [[nodiscard]] const CharacterScreenCache& cache() const
+        {
+            return cache_;
+        }
 
     private:
         /**
-         * Gets the faction for a given session.
+         * The faction and characters of an account, when they are kept in memory rather than in a database.
+         */
+        struct Account
+        {
+            /**
+             * The faction of the account.
+             */
+            ShaiyaFaction faction{ ShaiyaFaction::Neither };
+
+            /**
+             * The characters of the account, by slot.
+             */
+            std::vector<shaiya::net::CharacterListEntry> characters;
+        };
+
+        /**
+         * Gets the faction for a given session from the database.
          * @param session   The session instance.
-         * @return          The session's faction.
+         * @return          The session's faction, or an empty optional if it couldn't be read.
          */
-        ShaiyaFaction getFaction(shaiya::net::GameSession& session);
+        boost::asio::awaitable<std::optional<ShaiyaFaction>> getFaction(shaiya::net::GameSession& session);
 
         /**
-         * Gets the list of characters for a session.
+         * Gets the list of characters for a session from the database.
          * @param session   The session instance.
-         * @return          The session's characters.
+         * @return          The session's characters, or an empty optional if they couldn't be read.
          */
-        std::vector<shaiya::net::CharacterListEntry> getCharacters(shaiya::net::GameSession& session);
+        boost::asio::awaitable<std::optional<std::vector<shaiya::net::CharacterListEntry>>>
+        getCharacters(shaiya::net::GameSession& session);
 
         /**
-         * The database service.
+         * Creates a character in memory, when there is no database. The character is added to the player serializer,
+         * which allocates its id.
+         * @param userId        The id of the account.
+         * @param character     The character.
+         * @param serializer    The player serializer.
+         * @return              The result of the character creation.
          */
-        shaiya::database::DatabaseService& db_;
+        shaiya::net::CharacterCreateResult createInMemory(uint32_t userId, shaiya::net::CharacterListEntry character,
+                                                          PlayerSerializer& serializer);
+
+        /**
+         * The asynchronous database service, which is null if the accounts are kept in memory.
+         */
+        shaiya::database::AsyncDatabaseService* db_{ nullptr };
 
         /**
          * The id of this world server.
          */
         uint32_t worldId_{ 0 };
+
+        /**
+         * The cache of each account's faction and character list.
+         */
+        CharacterScreenCache cache_;
+
+        /**
+         * The accounts that are kept in memory, keyed by account id.
+         */
+        std::unordered_map<uint32_t, Account> accounts_;
+
+        /**
+         * The mutex used for locking access to the accounts that are kept in memory.
+         */
+        std::mutex mutex_;
     };
 }
\ No newline at end of file
@@ -1,16 +1,24 @@
 #pragma once
 #include <shaiya/common/client/item/ItemSData.hpp>
 #include <shaiya/game/Forward.hpp>
+#include <shaiya/game/io/CharacterData.hpp>
 #include <shaiya/game/model/commands/CommandManager.hpp>
 #include <shaiya/game/model/map/MapRepository.hpp>
+#include <shaiya/game/scheduling/LoadController.hpp>
 #include <shaiya/game/scheduling/Scheduler.hpp>
+#include <shaiya/game/service/PlayerDirectory.hpp>
 #include <shaiya/game/util/EntityContainer.hpp>
 
 #include <boost/property_tree/ptree.hpp>
 
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <queue>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace shaiya::game
@@ -20,10 +28,16 @@ namespace shaiya::game
     public:
         /**
          * Initialise this game world service.
-         * @param db            The database service.
+         * @param db            The database service, or null if the players aren't stored in a database.
+         * @param charScreen    The character screen service, which is told about the characters that are saved.
          * @param worldId       The id of this world service.
          */
-        explicit GameWorldService(shaiya::database::DatabaseService& db, size_t worldId);
+        GameWorldService(shaiya::database::DatabaseService* db, CharacterScreenService& charScreen, size_t worldId);
+
+        /**
+         * Saves any player snapshots that are still pending.
+         */
+        ~GameWorldService();
 
         /**
          * Loads the game world service.
@@ -49,6 +63,25 @@ namespace shaiya::game
          */
         void unregisterPlayer(std::shared_ptr<Player> player);
 
+        /**
+         * Resumes a character that was parked when its account disconnected, by attaching it to the account's new
+         * session. The character returns to the world on the next tick, without reading it again.
+         * @param session   The new session of the account.
+         * @param id        The id of the selected character.
+         * @return          If the character was parked and has been resumed.
+         */
+        bool resume(shaiya::net::GameSession& session, size_t id);
+
+        /**
+         * Hands a player off to the zone that owns the map they are moving to, if this zone doesn't own it. The player
+         * is hidden and saved, and the handoff is only sent once the save has completed. Their client is disconnected
+         * once the other zone has answered, so it can reconnect and select the character there.
+         * @param player        The player.
+         * @param destination   The position that the player is moving to.
+         * @return              If the player is being handed off to another zone.
+         */
+        bool handoff(Player& player, const Position& destination);
+
         /**
          * Registers a ground item to this world.
          * @param item  The ground item instance.
@@ -95,6 +128,20 @@ namespace shaiya::game
          */
         void finaliseUnregistrations();
 
+        /**
+         * Submits a snapshot of a player to be saved straight away, rather than waiting for the next persistence task.
+         * This should be used after high-value changes, such as a completed trade.
+         * @param player    The player.
+         */
+        void persist(Player& player);
+
+        /**
+         * Starts reading a character's data in the background, while its player is still on the character screen. This
+         * does nothing unless prefetching is enabled.
+         * @param id    The id of the character.
+         */
+        void prefetch(size_t id);
+
         /**
          * Schedules a task to be executed in the future.
          * @param task  The task.
@@ -110,6 +157,15 @@ namespace shaiya::game
             return mapRepository_;
         }
 
+        /**
+         * Gets the directory of the zones that the maps are split between.
+         * @return  The zone directory.
+         */
+        [[nodiscard]] ZoneDirectory& zones() const
+        {
+            return *zones_;
+        }
+
         /**
          * Gets the command manager.
          * @return  The command manager.
@@ -128,6 +184,100 @@ namespace shaiya::game
             return itemDefs_;
         }
 
+        /**
+         * Gets the players that are connected to the game world.
+         * @return  The players.
+         */
+        [[nodiscard]] const std::vector<std::shared_ptr<Player>>& players() const
+        {
+            return directory_.players();
+        }
+
+        /**
+         * Gets the directory of the players that are connected to the game world. Its snapshot may be read from any
+         * thread, while the directory itself may only be used on the world thread.
+         * @return  The player directory.
+         */
+        [[nodiscard]] const PlayerDirectory& directory() const
+        {
+            return directory_;
+        }
+
+        /**
+         * Gets the number of players that are connected to the game world. This may be called from any thread.
+         * @return  The number of players.
+         */
+        [[nodiscard]] size_t playerCount() const
+        {
+            return playerCount_;
+        }
+
+        /**
+         * Gets the serializer that stores the player characters.
+         * @return  The player serializer.
+         */
+        [[nodiscard]] PlayerSerializer& playerSerializer()
+        {
+            return *playerSerializer_;
+        }
+
+        /**
+         * Gets the prefetcher of characters that are likely to be selected.
+         * @return  The prefetcher, or null if prefetching is disabled.
+         */
+        [[nodiscard]] const PlayerPrefetcher* prefetcher() const
+        {
+            return prefetcher_.get();
+        }
+
+        /**
+         * Gets the number of characters that are parked, waiting for their account to reconnect.
+         * @return  The number of parked characters.
+         */
+        [[nodiscard]] size_t parkedCount() const
+        {
+            return parkedCount_;
+        }
+
+        /**
+         * Gets the number of characters that were resumed by a reconnecting account.
+         * @return  The number of resumed characters.
+         */
+        [[nodiscard]] size_t resumed() const
+        {
+            return resumed_;
+        }
+
+        /**
+         * Gets the maximum number of players that this world is configured to hold.
+         * @return  The player capacity, or 0 if it isn't configured.
+         */
+        [[nodiscard]] size_t capacity() const
+        {
+            return capacity_;
+        }
+
+        /**
+         * Gets the number of player snapshots that are waiting to be saved.
+         * @return  The number of pending saves.
+         */
+        [[nodiscard]] size_t pendingSaves() const;
+
+        /**
+         * Summarises the connected and parked players, and how many parked characters were resumed.
+         * @return  The summary
+         */
+        [[nodiscard]] std::string report() const;
+
+        /**
+         * Gets the load controller, which sheds load when the world tick overruns.
+         * @return  The load controller.
+         */
+        [[nodiscard]] const LoadController& load() const
+        {
+            return loadController_;
+        }
+
         /**
          * Gets the mobs that are active in the game world.
          * @return  The mobs.
@@ -138,15 +288,41 @@ namespace shaiya::game
         }
 
     private:
+        /**
+         * A character that was parked when its account disconnected.
+         */
+        struct ParkedPlayer
+        {
+            /**
+             * The character.
+             */
+            std::shared_ptr<Player> player;
+
+            /**
+             * The time at which the character is forgotten, if its account hasn't reconnected.
+             */
+            std::chrono::steady_clock::time_point expiresAt;
+        };
+
         /**
          * If this service is running.
          */
         bool running_{ true };
 
         /**
-         * The database service.
+         * The database service, which is null if the players aren't stored in a database.
          */
-        shaiya::database::DatabaseService& db_;
+        shaiya::database::DatabaseService* db_{ nullptr };
+
+        /**
+         * The character screen service.
+         */
+        CharacterScreenService& charScreen_;
+
+        /**
+         * The id of this world service.
+         */
+        size_t worldId_;
 
         /**
          * The item data.
@@ -154,20 +330,70 @@ namespace shaiya::game
         shaiya::client::ItemSData itemDefs_;
 
         /**
-         * A vector containing the players that are connected to this game world.
+         * The players that are connected to this game world.
+         */
+        PlayerDirectory directory_;
+
+        /**
+         * The resumed characters that are waiting for their account's previous player to be unregistered.
+         */
+        std::vector<std::shared_ptr<Player>> deferredResumptions_;
+
+        /**
+         * The new characters that are waiting for their account's previous player to be unregistered.
+         */
+        std::vector<std::shared_ptr<Player>> deferredRegistrations_;
+
+        /**
+         * The number of players that are connected to this game world.
+         */
+        std::atomic<size_t> playerCount_{ 0 };
+
+        /**
+         * The maximum number of players that this world is configured to hold.
          */
-        std::vector<std::shared_ptr<Player>> players_;
+        size_t capacity_{ 0 };
 
         /**
          * The players that are pending registration
          */
         std::queue<std::shared_ptr<Player>> newPlayers_;
 
+        /**
+         * The players whose data has been read, and is waiting to be applied on the world thread
+         */
+        std::queue<std::pair<std::shared_ptr<Player>, std::optional<CharacterData>>> loadedPlayers_;
+
         /**
          * The players that are pending unregistration
          */
         std::queue<std::shared_ptr<Player>> oldPlayers_;
 
+        /**
+         * The parked players that have been resumed, and are waiting to return to the world
+         */
+        std::queue<std::shared_ptr<Player>> resumedPlayers_;
+
+        /**
+         * The characters that are parked, keyed by the user id of their account.
+         */
+        std::unordered_map<uint32_t, ParkedPlayer> parkedPlayers_;
+
+        /**
+         * The time that a character stays parked after its account disconnects, or zero if characters aren't parked.
+         */
+        std::chrono::milliseconds resumeWindow_{ 0 };
+
+        /**
+         * The number of characters that are parked.
+         */
+        std::atomic<size_t> parkedCount_{ 0 };
+
+        /**
+         * The number of characters that were resumed by a reconnecting account.
+         */
+        std::atomic<size_t> resumed_{ 0 };
+
         /**
          * A container that holds all of the ground items that exist in the world.
          */
@@ -193,6 +419,21 @@ namespace shaiya::game
          */
         std::unique_ptr<PlayerSerializer> playerSerializer_;
 
+        /**
+         * The write-behind persistence service, which saves player snapshots in batches.
+         */
+        std::unique_ptr<PersistenceService> persistence_;
+
+        /**
+         * The prefetcher of characters that are likely to be selected, which is null if prefetching is disabled.
+         */
+        std::unique_ptr<PlayerPrefetcher> prefetcher_;
+
+        /**
+         * The directory of the zones that the maps are split between.
+         */
+        std::unique_ptr<ZoneDirectory> zones_;
+
         /**
          * The map repository.
          */
@@ -203,6 +444,11 @@ namespace shaiya::game
          */
         Scheduler scheduler_;
 
+        /**
+         * The load controller.
+         */
+        LoadController loadController_;
+
         /**
          * The command manager.
          */
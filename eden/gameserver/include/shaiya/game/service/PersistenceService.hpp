@@ -0,0 +1,275 @@
+#pragma once
+#include <shaiya/game/Forward.hpp>
+#include <shaiya/game/io/CharacterData.hpp>
+#include <shaiya/game/io/PlayerJournal.hpp>
+#include <shaiya/game/io/PlayerSnapshot.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace shaiya::game
+{
+    /**
+     * A write-behind persistence service. Snapshots of player characters are submitted from the world thread, and are
+     * saved in batches by a background thread. If a character is submitted again before their previous snapshot has been
+     * saved, only the latest snapshot is kept, along with any item changes of the previous snapshot that it doesn't
+     * supersede.
+     *
+     * If a journal is configured, submitted snapshots are first appended to it by a journal thread, which syncs each
+     * group of snapshots with a single fsync. Once the snapshots are durable in the journal, the database only needs to
+     * be written at the flush interval, and each character is written at most once per flush.
+     */
+    class PersistenceService
+    {
+    public:
+        /**
+         * Initialises this service, replays any snapshots that were left in the journal, and starts the journal and
+         * flush threads. An exception is thrown if the journal can't be replayed into the database.
+         * @param serializer    The serializer used to save the snapshots.
+         * @param journalPath   The directory of the journal, or an empty string to save without a journal.
+         * @param flushInterval The interval between database saves, when a journal is used.
+         */
+        PersistenceService(PlayerSerializer& serializer, const std::string& journalPath,
+                           std::chrono::milliseconds flushInterval);
+
+        /**
+         * Stops the journal and flush threads, after saving any snapshots that are still pending.
+         */
+        ~PersistenceService();
+
+        /**
+         * Submits a batch of snapshots to be saved.
+         * @param snapshots The snapshots.
+         */
+        void submit(std::vector<PlayerSnapshot> snapshots);
+
+        /**
+         * Reads the latest state of a player character. The persisted state is read from the serializer, and the
+         * snapshots of the character that haven't been saved yet are applied on top of it, so a character that logs
+         * back in before their last snapshot is flushed doesn't lose it. This may be called from any thread.
+         * @param id    The id of the character.
+         * @return      The character data, or an empty optional if the character couldn't be read.
+         */
+        std::optional<CharacterData> read(size_t id);
+
+        /**
+         * Saves the final snapshot of a character straight away, and waits for it to be saved. The character's older
+         * snapshots that are still queued are dropped, and their item changes are inherited by the final snapshot, so
+         * nothing this service saves later can overwrite it. This must be called away from the world thread, once the
+         * character can no longer be snapshotted.
+         * @param snapshot  The final snapshot.
+         * @return          If the snapshot was saved. If it wasn't, it is queued to be saved like any other snapshot.
+         */
+        bool saveNow(PlayerSnapshot snapshot);
+
+        /**
+         * Gets the number of snapshots in the last batch that was flushed.
+         * @return  The batch size.
+         */
+        [[nodiscard]] size_t lastBatchSize() const
+        {
+            return lastBatchSize_;
+        }
+
+        /**
+         * Gets the save lag of the last batch that was flushed, which is the age of its oldest snapshot when it was saved.
+         * @return  The save lag.
+         */
+        [[nodiscard]] std::chrono::milliseconds lastSaveLag() const
+        {
+            return std::chrono::milliseconds(lastSaveLag_.load());
+        }
+
+        /**
+         * Gets the highest save lag that has been observed.
+         * @return  The highest save lag.
+         */
+        [[nodiscard]] std::chrono::milliseconds maxSaveLag() const
+        {
+            return std::chrono::milliseconds(maxSaveLag_.load());
+        }
+
+        /**
+         * Gets the number of snapshots that were quarantined because they could never be saved.
+         * @return  The number of quarantined snapshots.
+         */
+        [[nodiscard]] size_t quarantined() const
+        {
+            return quarantined_;
+        }
+
+        /**
+         * Gets the number of snapshots that are waiting to be saved.
+         * @return  The number of pending snapshots.
+         */
+        [[nodiscard]] size_t pending();
+
+    private:
+        /**
+         * Adds snapshots to a set of pending snapshots, replacing any older snapshot of the same character.
+         * @param pending   The pending snapshots, keyed by character id.
+         * @param snapshots The snapshots to add.
+         */
+        static void coalesce(std::unordered_map<size_t, PlayerSnapshot>& pending, std::vector<PlayerSnapshot>& snapshots);
+
+        /**
+         * Saves the snapshots that were left in the journal by a previous run, and deletes them from the journal.
+         */
+        void replay();
+
+        /**
+         * Appends the submitted snapshots to the journal until this service is stopped.
+         */
+        void journal();
+
+        /**
+         * Saves the pending snapshots until this service is stopped.
+         */
+        void run();
+
+        /**
+         * Seals the journal segments that hold the snapshots which have been queued to be saved.
+         * @return  The id of the last sealed segment, or zero if no segments were sealed.
+         */
+        size_t seal();
+
+        /**
+         * Saves a batch of snapshots. Snapshots that can never be saved are quarantined and removed from the batch,
+         * rather than failing the batch forever. If the batch fails as a whole, the characters are saved one at a time,
+         * and the ones that still fail are quarantined too, unless none of them could be saved, which means the
+         * database is unavailable.
+         * @param batch The batch of snapshots.
+         * @return      If the snapshots that remain in the batch were saved.
+         */
+        bool save(std::vector<PlayerSnapshot>& batch);
+
+        /**
+         * Sets aside snapshots that can never be saved, so they don't hold up the rest of the characters. They are
+         * appended to the quarantine journal, if there is one, so they can be inspected and repaired by hand.
+         * @param snapshots The snapshots.
+         */
+        void quarantine(const std::vector<PlayerSnapshot>& snapshots);
+
+        /**
+         * Saves a batch of snapshots, and records the batch metrics. If the batch fails to save, its snapshots are put
+         * back in the pending queue, unless a newer snapshot of the same character has since been submitted, in which
+         * case the newer snapshot inherits their unsaved item changes. Once the batch has been saved, the journal
+         * segments that it covers are deleted.
+         * @param batch     The batch of snapshots.
+         * @param sealed    The id of the last journal segment covered by the batch.
+         */
+        void flush(std::vector<PlayerSnapshot> batch, size_t sealed);
+
+        /**
+         * The serializer used to save the snapshots.
+         */
+        PlayerSerializer& serializer_;
+
+        /**
+         * The journal, which is null if the snapshots are saved without one.
+         */
+        std::unique_ptr<PlayerJournal> journal_;
+
+        /**
+         * The journal of the snapshots that could never be saved, which is null if the snapshots are saved without a
+         * journal.
+         */
+        std::unique_ptr<PlayerJournal> quarantine_;
+
+        /**
+         * The interval between database saves, when a journal is used.
+         */
+        std::chrono::milliseconds flushInterval_;
+
+        /**
+         * The snapshots that are waiting to be appended to the journal.
+         */
+        std::vector<PlayerSnapshot> unjournaled_;
+
+        /**
+         * The snapshots that are waiting to be saved, keyed by character id.
+         */
+        std::unordered_map<size_t, PlayerSnapshot> pending_;
+
+        /**
+         * The group of snapshots that is being appended to the journal, before it is queued to be saved.
+         */
+        std::vector<PlayerSnapshot> journaling_;
+
+        /**
+         * The batch of snapshots that is being saved, keyed by character id.
+         */
+        std::unordered_map<size_t, PlayerSnapshot> inflight_;
+
+        /**
+         * The final snapshots that are being saved straight away, keyed by character id.
+         */
+        std::unordered_map<size_t, PlayerSnapshot> urgent_;
+
+        /**
+         * The mutex used for locking access to the pending snapshots.
+         */
+        std::mutex mutex_;
+
+        /**
+         * The mutex that is held while the journal is written. A group of snapshots is moved to the pending queue
+         * before this is released, so a segment can't be sealed while it holds snapshots that aren't yet pending.
+         */
+        std::mutex journalMutex_;
+
+        /**
+         * The condition used to wake the journal and flush threads, and the callers waiting for a character's snapshots
+         * to leave the journal and flush threads.
+         */
+        std::condition_variable condition_;
+
+        /**
+         * If this service is accepting snapshots.
+         */
+        bool running_{ true };
+
+        /**
+         * If the flush thread is running.
+         */
+        bool saving_{ true };
+
+        /**
+         * The number of snapshots in the last batch that was flushed.
+         */
+        std::atomic<size_t> lastBatchSize_{ 0 };
+
+        /**
+         * The save lag of the last batch, in milliseconds.
+         */
+        std::atomic<int64_t> lastSaveLag_{ 0 };
+
+        /**
+         * The highest save lag that has been observed, in milliseconds.
+         */
+        std::atomic<int64_t> maxSaveLag_{ 0 };
+
+        /**
+         * The number of snapshots that were quarantined.
+         */
+        std::atomic<size_t> quarantined_{ 0 };
+
+        /**
+         * The thread that appends the submitted snapshots to the journal.
+         */
+        std::thread journalThread_;
+
+        /**
+         * The thread that saves the pending snapshots.
+         */
+        std::thread thread_;
+    };
+}
@@ -0,0 +1,195 @@
+#pragma once
+#include <shaiya/game/Forward.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace shaiya::game
+{
+    /**
+     * The details of a player that are published to other threads.
+     */
+    struct PlayerEntry
+    {
+        /**
+         * The id of the character.
+         */
+        size_t id{ 0 };
+
+        /**
+         * The name of the character, which is empty until its data has been loaded.
+         */
+        std::string name;
+
+        /**
+         * The id of the character's account.
+         */
+        uint32_t userId{ 0 };
+    };
+
+    /**
+     * The players that are connected to a game world, indexed by character id, lower-cased name and account id. The
+     * directory is only mutated on the world thread. Other threads read an immutable snapshot of it, which is replaced as
+     * a whole when the world publishes its changes, so they never lock against the world tick.
+     */
+    class PlayerDirectory
+    {
+    public:
+        /**
+         * An immutable view of the directory, which may be read from any thread.
+         */
+        struct Snapshot
+        {
+            /**
+             * Gets the player with a character id.
+             * @param id    The id of the character.
+             * @return      The player, or null if no such player is connected.
+             */
+            [[nodiscard]] const PlayerEntry* forId(size_t id) const;
+
+            /**
+             * Gets the player with a character name, ignoring its case.
+             * @param name  The name of the character.
+             * @return      The player, or null if no such player is connected.
+             */
+            [[nodiscard]] const PlayerEntry* forName(std::string_view name) const;
+
+            /**
+             * Gets the player of an account.
+             * @param userId    The id of the account.
+             * @return          The player, or null if the account has no connected player.
+             */
+            [[nodiscard]] const PlayerEntry* forUser(uint32_t userId) const;
+
+            /**
+             * The players, keyed by character id.
+             */
+            std::unordered_map<size_t, PlayerEntry> players;
+
+            /**
+             * The character ids, keyed by lower-cased character name.
+             */
+            std::unordered_map<std::string, size_t> names;
+
+            /**
+             * The character ids, keyed by account id.
+             */
+            std::unordered_map<uint32_t, size_t> users;
+        };
+
+        /**
+         * Initialises this directory, with an empty snapshot.
+         */
+        PlayerDirectory();
+
+        /**
+         * Adds a player to this directory. This must only be called on the world thread.
+         * @param player    The player.
+         * @return          If the player was added, or false if its character or account already has a player.
+         */
+        bool add(std::shared_ptr<Player> player);
+
+        /**
+         * Indexes the name of a player, once its data has been loaded. This must only be called on the world thread.
+         * @param player    The player.
+         */
+        void rename(const Player& player);
+
+        /**
+         * Removes a player from this directory. This must only be called on the world thread.
+         * @param player    The player.
+         */
+        void remove(const Player& player);
+
+        /**
+         * Gets the player with a character id. This must only be called on the world thread.
+         * @param id    The id of the character.
+         * @return      The player, or null if no such player is connected.
+         */
+        [[nodiscard]] std::shared_ptr<Player> forId(size_t id) const;
+
+        /**
+         * Gets the player with a character name, ignoring its case. This must only be called on the world thread.
+         * @param name  The name of the character.
+         * @return      The player, or null if no such player is connected.
+         */
+        [[nodiscard]] std::shared_ptr<Player> forName(std::string_view name) const;
+
+        /**
+         * Gets the player of an account. This must only be called on the world thread.
+         * @param userId    The id of the account.
+         * @return          The player, or null if the account has no connected player.
+         */
+        [[nodiscard]] std::shared_ptr<Player> forUser(uint32_t userId) const;
+
+        /**
+         * Publishes the changes made since the last call as a new snapshot. This must only be called on the world thread.
+         */
+        void publish();
+
+        /**
+         * Gets the latest published snapshot. This may be called from any thread.
+         * @return  The snapshot.
+         */
+        [[nodiscard]] std::shared_ptr<const Snapshot> snapshot() const
+        {
+            return snapshot_.load();
+        }
+
+        /**
+         * Gets the players, in no particular order. This must only be called on the world thread.
+         * @return  The players.
+         */
+        [[nodiscard]] const std::vector<std::shared_ptr<Player>>& players() const
+        {
+            return players_;
+        }
+
+        /**
+         * Gets the number of players.
+         * @return  The number of players.
+         */
+        [[nodiscard]] size_t size() const
+        {
+            return players_.size();
+        }
+
+    private:
+        /**
+         * Gets the index of a player in the vector of players.
+         * @param player    The player.
+         * @return          The index, or the size of the vector if the player isn't in this directory.
+         */
+        [[nodiscard]] size_t indexOf(const Player& player) const;
+
+        /**
+         * The players, which are kept contiguous so the world can iterate them each tick.
+         */
+        std::vector<std::shared_ptr<Player>> players_;
+
+        /**
+         * The current state of the directory, which is copied into the next snapshot.
+         */
+        Snapshot current_;
+
+        /**
+         * The indices of the players in the vector of players, keyed by character id.
+         */
+        std::unordered_map<size_t, size_t> indices_;
+
+        /**
+         * If the directory has changed since the last snapshot was published.
+         */
+        bool dirty_{ false };
+
+        /**
+         * The latest published snapshot.
+         */
+        std::atomic<std::shared_ptr<const Snapshot>> snapshot_;
+    };
+}
@@ -36,11 +36,22 @@ namespace shaiya::game
          */
         GameWorldService& getGameWorld();
 
+        /**
+         * Gets the database service.
+         * @return  The database service, or null if the players are stored without a database.
+         */
+        shaiya::database::DatabaseService* getDatabase();
+
     private:
         /**
-         * The database service instance.
+         * The database service instance, which is null if the players are stored without a database.
+         */
+        shaiya::database::DatabaseService* dbService_{ nullptr };
+
+        /**
+         * The asynchronous database service, which is null if the players are stored without a database.
          */
-        shaiya::database::DatabaseService* dbService_;
+        shaiya::database::AsyncDatabaseService* asyncDbService_{ nullptr };
 
         /**
          * The character screen service.
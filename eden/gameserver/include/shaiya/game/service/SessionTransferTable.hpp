@@ -0,0 +1,251 @@
+#pragma once
+#include <proto/GameApi.grpc.pb.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+
+namespace shaiya::game
+{
+    /**
+     * The session transfers that the login server has submitted, which are waiting for their client to connect. The
+     * transfers are held in a sharded hash map keyed by the client's identity, so submitting and taking a transfer
+     * only locks a single shard. Transfers whose client never arrives expire after a time to live, and an account
+     * that is already logged in to this world can't be transferred again until its session is released.
+     */
+    class SessionTransferTable
+    {
+    public:
+        /**
+         * The identity of a client, which it presents when it connects to the world.
+         */
+        using Identity = std::array<char, 16>;
+
+        /**
+         * Initialises this table, and starts the thread that expires transfers.
+         * @param ttl   The time a transfer waits for its client before it expires.
+         */
+        explicit SessionTransferTable(std::chrono::milliseconds ttl);
+
+        /**
+         * Stops the thread that expires transfers.
+         */
+        ~SessionTransferTable();
+
+        /**
+         * Submits a transfer. A pending transfer of the same account is replaced, as its client won't use it anymore.
+         * @param request   The transfer request.
+         * @return          The status of the transfer.
+         */
+        gameapi::SessionTransferStatus submit(const gameapi::SessionTransferRequest& request);
+
+        /**
+         * Takes the transfer of a client that has connected, and marks its account as logged in.
+         * @param identity  The identity of the client.
+         * @return          The transfer request, or null if there is no pending transfer for the identity.
+         */
+        std::unique_ptr<gameapi::SessionTransferRequest> take(const Identity& identity);
+
+        /**
+         * Releases an account that has logged out, so it can be transferred again.
+         * @param userId    The id of the account.
+         */
+        void release(uint32_t userId);
+
+        /**
+         * Gets the number of transfers that are waiting for their client.
+         * @return  The number of pending transfers.
+         */
+        [[nodiscard]] size_t pending() const
+        {
+            return pending_;
+        }
+
+        /**
+         * Gets the number of transfers that expired before their client connected.
+         * @return  The number of expired transfers.
+         */
+        [[nodiscard]] size_t expired() const
+        {
+            return expired_;
+        }
+
+        /**
+         * Gets the number of transfers that were rejected, because their account was already logged in.
+         * @return  The number of rejected transfers.
+         */
+        [[nodiscard]] size_t rejected() const
+        {
+            return rejected_;
+        }
+
+        /**
+         * Summarises the pending transfers, and how many expired or were rejected.
+         * @return  The summary
+         */
+        [[nodiscard]] std::string report() const;
+
+    private:
+        /**
+         * Hashes an identity.
+         */
+        struct IdentityHash
+        {
+            /**
+             * Hashes an identity.
+             * @param identity  The identity.
+             * @return          The hash.
+             */
+            size_t operator()(const Identity& identity) const
+            {
+                return std::hash<std::string_view>()(std::string_view(identity.data(), identity.size()));
+            }
+        };
+
+        /**
+         * A transfer that is waiting for its client.
+         */
+        struct Transfer
+        {
+            /**
+             * The transfer request.
+             */
+            std::unique_ptr<gameapi::SessionTransferRequest> request;
+
+            /**
+             * The time at which the transfer expires.
+             */
+            std::chrono::steady_clock::time_point expiresAt;
+        };
+
+        /**
+         * The state of an account that has a pending transfer, or is logged in.
+         */
+        struct Account
+        {
+            /**
+             * The identity of the account's pending transfer, or an empty optional if the account is logged in.
+             */
+            std::optional<Identity> pending;
+        };
+
+        /**
+         * A shard of the transfers.
+         */
+        struct TransferShard
+        {
+            /**
+             * The transfers, keyed by identity.
+             */
+            std::unordered_map<Identity, Transfer, IdentityHash> transfers;
+
+            /**
+             * The mutex used for locking access to the shard.
+             */
+            std::mutex mutex;
+        };
+
+        /**
+         * A shard of the accounts.
+         */
+        struct AccountShard
+        {
+            /**
+             * The accounts, keyed by user id.
+             */
+            std::unordered_map<uint32_t, Account> accounts;
+
+            /**
+             * The mutex used for locking access to the shard.
+             */
+            std::mutex mutex;
+        };
+
+        /**
+         * The number of shards.
+         */
+        static constexpr size_t SHARD_COUNT = 16;
+
+        /**
+         * Gets the shard that holds the transfer of an identity.
+         * @param identity  The identity.
+         * @return          The transfer shard.
+         */
+        TransferShard& shardFor(const Identity& identity);
+
+        /**
+         * Gets the shard that holds an account.
+         * @param userId    The id of the account.
+         * @return          The account shard.
+         */
+        AccountShard& shardFor(uint32_t userId);
+
+        /**
+         * Expires the transfers that have outlived their time to live, until this table is destroyed.
+         */
+        void run();
+
+        /**
+         * Expires the transfers that have outlived their time to live.
+         */
+        void expire();
+
+        /**
+         * The time a transfer waits for its client before it expires.
+         */
+        std::chrono::milliseconds ttl_;
+
+        /**
+         * The transfer shards. A transfer shard is only ever locked after its account shard, when both are needed.
+         */
+        std::array<TransferShard, SHARD_COUNT> transferShards_;
+
+        /**
+         * The account shards.
+         */
+        std::array<AccountShard, SHARD_COUNT> accountShards_;
+
+        /**
+         * The number of transfers that are waiting for their client.
+         */
+        std::atomic<size_t> pending_{ 0 };
+
+        /**
+         * The number of transfers that expired before their client connected.
+         */
+        std::atomic<size_t> expired_{ 0 };
+
+        /**
+         * The number of transfers that were rejected, because their account was already logged in.
+         */
+        std::atomic<size_t> rejected_{ 0 };
+
+        /**
+         * If the expiry thread is running.
+         */
+        bool running_{ true };
+
+        /**
+         * The mutex used for stopping the expiry thread.
+         */
+        std::mutex mutex_;
+
+        /**
+         * The condition used to wake the expiry thread when this table is destroyed.
+         */
+        std::condition_variable condition_;
+
+        /**
+         * The thread that expires transfers.
+         */
+        std::thread thread_;
+    };
+}
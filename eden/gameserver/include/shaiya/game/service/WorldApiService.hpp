@@ -1,19 +1,31 @@
 #pragma once
 #include <proto/GameApi.grpc.pb.h>
+#include <shaiya/game/Forward.hpp>
+#include <shaiya/game/service/SessionTransferTable.hpp>
 
 #include <grpc++/grpc++.h>
-#include <vector>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
 
 namespace shaiya::game
 {
     /**
      * The local world api service. This is primarily used by the login server for checking the world server's status,
      * and the number of players that are online, as well as reasoning about session transfers that we should expect to
-     * receive.
+     * receive. When the maps are split between zones, the other zones use it to hand their players off to this one.
      */
     class WorldApiService: public gameapi::GameService::Service
     {
     public:
+        /**
+         * Initialises this api service.
+         * @param world         The game world.
+         * @param transferTtl   The time a session transfer waits for its client before it expires.
+         */
+        WorldApiService(const GameWorldService& world, std::chrono::milliseconds transferTtl);
+
         /**
          * Starts this api service and listens for connections on a specified port.
          * @param port  The port to listen on.
@@ -30,6 +42,17 @@ namespace shaiya::game
         grpc::Status GetWorldStatus(grpc::ServerContext* context, const gameapi::Void* request,
                                     gameapi::WorldStatus* response) override;
 
+        /**
+         * Streams the status of this game world. A status is pushed whenever it changes, and at a regular interval
+         * otherwise, so the login server can tell the world is still alive. The stream ends when the client cancels it.
+         * @param context   The context of this server.
+         * @param request   The request, which for this case is just an empty message.
+         * @param writer    The writer for the stream of statuses.
+         * @return          The status of the request.
+         */
+        grpc::Status StreamWorldStatus(grpc::ServerContext* context, const gameapi::Void* request,
+                                       grpc::ServerWriter<gameapi::WorldStatus>* writer) override;
+
         /**
          * Handles an incoming session transfer request.
          * @param context   The context of this server.
@@ -41,16 +64,80 @@ namespace shaiya::game
                                            gameapi::SessionTransferResponse* response) override;
 
         /**
-         * Gets a transfer request for a given identity
+         * Handles a player that another zone is handing off to this one. The player's session is expected like a
+         * session transfer from the login server, and their character data is held until their client selects them.
+         * @param context   The context of this server.
+         * @param request   The handoff request.
+         * @param response  The handoff response, which is used to tell the other zone if we accepted it or not.
+         * @return          The status of the request.
+         */
+        grpc::Status HandoffPlayer(grpc::ServerContext* context, const gameapi::PlayerHandoffRequest* request,
+                                   gameapi::SessionTransferResponse* response) override;
+
+        /**
+         * Takes the transfer request for a given identity, and marks its account as logged in.
          * @param identity  The identity
-         * @return          The transfer request.
+         * @return          The transfer request, or null if there is no pending transfer for the identity.
+         */
+        std::unique_ptr<gameapi::SessionTransferRequest> getTransferForIdentity(const std::array<char, 16>& identity);
+
+        /**
+         * Releases an account that has logged out, so it can be transferred to this world again.
+         * @param userId    The id of the account.
+         */
+        void releaseTransfer(uint32_t userId);
+
+        /**
+         * Publishes the current status of the game world, and wakes the status streams if it has changed. This is
+         * called on the world thread, once per tick.
          */
-        std::unique_ptr<gameapi::SessionTransferRequest> getTransferForIdentity(std::array<char, 16> identity);
+        void publishStatus();
+
+        /**
+         * Gets the table of pending session transfers.
+         * @return  The session transfers.
+         */
+        [[nodiscard]] const SessionTransferTable& transfers() const
+        {
+            return transfers_;
+        }
 
     private:
         /**
-         * A vector containing the transfers that have been submitted but not yet handled.
+         * Populates the status of this game world.
+         * @param status    The status to populate.
+         */
+        void populateStatus(gameapi::WorldStatus& status) const;
+
+        /**
+         * The game world.
+         */
+        const GameWorldService& world_;
+
+        /**
+         * The transfers that have been submitted but not yet handled.
+         */
+        SessionTransferTable transfers_;
+
+        /**
+         * The mutex that guards the published status.
+         */
+        std::mutex statusMutex_;
+
+        /**
+         * The variable that the status streams wait on for the published status to change.
+         */
+        std::condition_variable statusChanged_;
+
+        /**
+         * The most recently published status.
+         */
+        gameapi::WorldStatus status_;
+
+        /**
+         * The version of the published status, which is incremented whenever it changes. No status has been published
+         * while this is 0.
          */
-        std::vector<gameapi::SessionTransferRequest*> pendingTransfers_;
+        size_t statusVersion_{ 0 };
     };
 }
\ No newline at end of file
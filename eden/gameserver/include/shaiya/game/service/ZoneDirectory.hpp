@@ -0,0 +1,211 @@
+#pragma once
+#include <proto/GameApi.grpc.pb.h>
+#include <shaiya/game/io/CharacterData.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <unordered_map>
+
+namespace shaiya::game
+{
+    /**
+     * Another game server process, which owns a subset of the maps.
+     */
+    struct Zone
+    {
+        /**
+         * The name of the zone.
+         */
+        std::string name;
+
+        /**
+         * The endpoint of the zone's world api.
+         */
+        std::string endpoint;
+
+        /**
+         * The ids of the maps that the zone owns.
+         */
+        std::set<uint16_t> maps;
+
+        /**
+         * The client of the zone's world api.
+         */
+        std::unique_ptr<gameapi::GameService::Stub> stub;
+    };
+
+    /**
+     * Knows which game server process owns each map, when the maps are split between several processes. A player that
+     * moves to a map owned by another zone is handed off to it, along with their character data and session keys, so
+     * the owning zone doesn't need to read the character again. The characters that other zones hand off to this one
+     * are held here until their client selects them, or until they expire.
+     */
+    class ZoneDirectory
+    {
+    public:
+        /**
+         * The function that receives the outcome of a handoff.
+         */
+        using HandoffCallback = std::function<void(bool accepted)>;
+
+        /**
+         * Initialises this directory.
+         * @param maps      The ids of the maps that this zone owns, or an empty set if it owns every map.
+         * @param deadline  The time another zone has to accept a handoff.
+         * @param ttl       The time a character that was handed off to this zone waits for its client.
+         */
+        ZoneDirectory(std::set<uint16_t> maps, std::chrono::milliseconds deadline, std::chrono::milliseconds ttl);
+
+        /**
+         * Adds a zone that owns some of the maps that this zone doesn't.
+         * @param name      The name of the zone.
+         * @param endpoint  The endpoint of the zone's world api.
+         * @param maps      The ids of the maps that the zone owns.
+         */
+        void addZone(std::string name, std::string endpoint, std::set<uint16_t> maps);
+
+        /**
+         * Checks if this zone owns a map.
+         * @param map   The id of the map.
+         * @return      If this zone owns the map.
+         */
+        [[nodiscard]] bool owns(uint16_t map) const;
+
+        /**
+         * Gets the zone that owns a map which this zone doesn't.
+         * @param map   The id of the map.
+         * @return      The owning zone, or null if this zone owns the map, or no zone does.
+         */
+        [[nodiscard]] const Zone* ownerOf(uint16_t map) const;
+
+        /**
+         * Hands a character off to another zone, without blocking.
+         * @param zone      The zone.
+         * @param request   The handoff request.
+         * @param callback  The callback that receives the outcome, which is invoked on another thread.
+         */
+        void handoff(const Zone& zone, gameapi::PlayerHandoffRequest request, HandoffCallback callback);
+
+        /**
+         * Holds the data of a character that another zone has handed off to this one.
+         * @param id    The id of the character.
+         * @param data  The character data.
+         */
+        void accept(size_t id, CharacterData data);
+
+        /**
+         * Claims the data of a character that was handed off to this zone.
+         * @param id    The id of the character.
+         * @return      The character data, or an empty optional if the character wasn't handed off, or has expired.
+         */
+        std::optional<CharacterData> claim(size_t id);
+
+        /**
+         * Gets the number of characters that this zone handed off to another zone.
+         * @return  The number of handoffs sent.
+         */
+        [[nodiscard]] size_t sent() const
+        {
+            return sent_;
+        }
+
+        /**
+         * Gets the number of handoffs that another zone rejected, or didn't answer in time.
+         * @return  The number of failed handoffs.
+         */
+        [[nodiscard]] size_t failed() const
+        {
+            return failed_;
+        }
+
+        /**
+         * Gets the number of characters that other zones handed off to this zone.
+         * @return  The number of handoffs received.
+         */
+        [[nodiscard]] size_t received() const
+        {
+            return received_;
+        }
+
+        /**
+         * Summarises the handoffs that this zone sent, and the ones it received.
+         * @return  The summary
+         */
+        [[nodiscard]] std::string report() const;
+
+    private:
+        /**
+         * A character that was handed off to this zone, and is waiting for its client.
+         */
+        struct Arrival
+        {
+            /**
+             * The character data.
+             */
+            CharacterData data;
+
+            /**
+             * The time at which the character is forgotten, if its client hasn't selected it.
+             */
+            std::chrono::steady_clock::time_point expiresAt;
+        };
+
+        /**
+         * Forgets the characters whose client didn't select them in time. This must be called while holding the mutex.
+         */
+        void expire();
+
+        /**
+         * The ids of the maps that this zone owns, or an empty set if it owns every map.
+         */
+        std::set<uint16_t> maps_;
+
+        /**
+         * The other zones.
+         */
+        std::deque<Zone> zones_;
+
+        /**
+         * The time another zone has to accept a handoff.
+         */
+        std::chrono::milliseconds deadline_;
+
+        /**
+         * The time a character that was handed off to this zone waits for its client.
+         */
+        std::chrono::milliseconds ttl_;
+
+        /**
+         * The characters that were handed off to this zone, keyed by character id.
+         */
+        std::unordered_map<size_t, Arrival> arrivals_;
+
+        /**
+         * The number of characters that this zone handed off to another zone.
+         */
+        std::atomic<size_t> sent_{ 0 };
+
+        /**
+         * The number of handoffs that another zone rejected, or didn't answer in time.
+         */
+        std::atomic<size_t> failed_{ 0 };
+
+        /**
+         * The number of characters that other zones handed off to this zone.
+         */
+        std::atomic<size_t> received_{ 0 };
+
+        /**
+         * The mutex used for locking access to the arrivals.
+         */
+        std::mutex mutex_;
+    };
+}
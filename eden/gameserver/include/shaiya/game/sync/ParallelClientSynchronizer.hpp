@@ -1,5 +1,6 @@
 #pragma once
 #include <shaiya/game/sync/ClientSynchronizer.hpp>
+#include <shaiya/game/sync/SyncPolicy.hpp>
 
 namespace shaiya::game
 {
@@ -10,6 +11,13 @@ namespace shaiya::game
     class ParallelClientSynchronizer: public ClientSynchronizer
     {
     public:
+        /**
+         * Initialises this synchronizer.
+         * @param policy    The level-of-detail policy.
+         * @param load      The load controller, which may reduce the frequency of far entity updates.
+         */
+        ParallelClientSynchronizer(SyncPolicy policy, const LoadController& load);
+
         /**
          * Synchronizes the state of the clients with the stat of the server.
          * @param players   The vector containing the player characters.
@@ -23,7 +31,23 @@ namespace shaiya::game
         /**
          * Synchronizes a player.
          * @param player     The player to synchronize
+         * @param policy     The level-of-detail policy for this tick.
+         */
+        void syncCharacter(Player& player, const SyncPolicy& policy);
+
+        /**
+         * The level-of-detail policy.
+         */
+        SyncPolicy policy_;
+
+        /**
+         * The load controller.
+         */
+        const LoadController& load_;
+
+        /**
+         * The number of ticks that have been synchronized.
          */
-        void syncCharacter(Player& player);
+        size_t tick_{ 0 };
     };
 }
\ No newline at end of file
@@ -0,0 +1,106 @@
+#pragma once
+#include <shaiya/game/Forward.hpp>
+#include <shaiya/game/model/EntityType.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace shaiya::game
+{
+    /**
+     * Decides which movement updates are sent to a character during a single tick. Movement updates are collected from the
+     * synchronization tasks, filtered by the level-of-detail policy, and then sent in order of priority until the byte
+     * budget of the character's session is spent. Updates that aren't sent are deferred to a later tick, at which point
+     * the entity's latest state is sent instead.
+     */
+    class SyncBudget
+    {
+    public:
+        /**
+         * Initialises the budget for a character.
+         * @param character The character being synchronized.
+         * @param policy    The synchronization policy.
+         * @param tick      The current tick.
+         */
+        SyncBudget(Player& character, const SyncPolicy& policy, size_t tick);
+
+        /**
+         * Checks if an entity has a movement update that was deferred from a previous tick.
+         * @param other The entity.
+         * @return      If the entity has a pending movement update.
+         */
+        [[nodiscard]] bool hasPendingMovement(const Entity& other) const;
+
+        /**
+         * Submits a movement update for an entity.
+         * @param other     The entity that moved.
+         * @param length    The expected length of the movement packet, which decides if it fits in the budget.
+         * @param send      The function that sends the latest movement of the entity.
+         */
+        void submitMovement(const Entity& other, size_t length, std::function<void()> send);
+
+        /**
+         * Sends the submitted movement updates in order of priority, deferring any that exceed the byte budget.
+         */
+        void flush();
+
+    private:
+        /**
+         * A movement update that is waiting to be sent.
+         */
+        struct Update
+        {
+            /**
+             * The priority of the update. Lower values are sent first.
+             */
+            float priority{ 0 };
+
+            /**
+             * The entity that moved.
+             */
+            const Entity* entity{ nullptr };
+
+            /**
+             * The expected length of the movement packet.
+             */
+            size_t length{ 0 };
+
+            /**
+             * The function that sends the movement packet.
+             */
+            std::function<void()> send;
+        };
+
+        /**
+         * Defers the movement update of an entity to a later tick.
+         * @param other The entity.
+         */
+        void defer(const Entity& other);
+
+        /**
+         * The character being synchronized.
+         */
+        Player& character_;
+
+        /**
+         * The synchronization policy.
+         */
+        const SyncPolicy& policy_;
+
+        /**
+         * The current tick.
+         */
+        size_t tick_{ 0 };
+
+        /**
+         * The number of bytes that had been written to the session before this tick's synchronization.
+         */
+        uint64_t startBytes_{ 0 };
+
+        /**
+         * The submitted movement updates.
+         */
+        std::vector<Update> updates_;
+    };
+}
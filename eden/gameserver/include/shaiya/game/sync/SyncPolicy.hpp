@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+
+namespace shaiya::game
+{
+    /**
+     * The level-of-detail policy used when synchronizing clients. Entities near a character have their movement sent
+     * every tick, while entities further away only have their latest movement sent every few ticks. The policy also limits
+     * the number of bytes that may be sent to a single client in a tick.
+     */
+    struct SyncPolicy
+    {
+        /**
+         * The distance within which an entity's movement is sent every tick.
+         */
+        float nearDistance{ 30 };
+
+        /**
+         * The interval, in ticks, at which the movement of entities beyond the near distance is sent.
+         */
+        size_t farInterval{ 4 };
+
+        /**
+         * The maximum number of bytes that may be sent to a client in a single tick. Viewport changes and appearance
+         * updates are always sent, and movement updates are deferred once the budget has been spent. A value of 0 means
+         * the budget is unlimited.
+         */
+        size_t byteBudget{ 0 };
+    };
+}
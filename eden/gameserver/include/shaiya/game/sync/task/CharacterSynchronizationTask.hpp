@@ -14,8 +14,9 @@ namespace shaiya::game
         /**
          * Initialise the synchronization task.
          * @param character The character we're currently synchronizing.
+         * @param budget    The budget for the character's movement updates.
          */
-        explicit CharacterSynchronizationTask(Player& character);
+        CharacterSynchronizationTask(Player& character, SyncBudget& budget);
 
         /**
          * Synchronizes the character.
@@ -69,5 +70,10 @@ namespace shaiya::game
          * The character we're currently synchronizing.
          */
         Player& character_;
+
+        /**
+         * The budget for the character's movement updates.
+         */
+        SyncBudget& budget_;
     };
 }
\ No newline at end of file
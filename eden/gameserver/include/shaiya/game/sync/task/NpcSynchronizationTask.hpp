@@ -13,8 +13,9 @@ namespace shaiya::game
         /**
          * Initialise the synchronization task.
          * @param character The character we're currently synchronizing.
+         * @param budget    The budget for the character's movement updates.
          */
-        explicit NpcSynchronizationTask(Player& character);
+        NpcSynchronizationTask(Player& character, SyncBudget& budget);
 
         /**
          * Synchronizes the character.
@@ -50,5 +51,10 @@ namespace shaiya::game
          * The character we're currently synchronizing.
          */
         Player& character_;
+
+        /**
+         * The budget for the character's movement updates.
+         */
+        SyncBudget& budget_;
     };
 }
\ No newline at end of file
@@ -14,9 +14,9 @@ int main(int argc, char** argv)
 {
     google::InitGoogleLogging(argv[0]);
 
-    // Parse the configuration file
+    // Parse the configuration file, which may be given on the command line so that several zones can share a machine
     boost::property_tree::ptree config;
-    boost::property_tree::ini_parser::read_ini("./data/config/Game.ini", config);
+    boost::property_tree::ini_parser::read_ini(argc > 1 ? argv[1] : "./data/config/Game.ini", config);
 
     // The service context
     shaiya::game::ServiceContext ctx(config);
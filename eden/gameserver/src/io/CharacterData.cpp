@@ -0,0 +1,251 @@
+#include <shaiya/game/io/CharacterData.hpp>
+#include <shaiya/game/io/PlayerSnapshot.hpp>
+#include <shaiya/game/model/actor/player/Player.hpp>
+#include <shaiya/game/model/item/Item.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+using namespace shaiya;
+using namespace shaiya::game;
+
+/**
+ * The magic number at the start of encoded character data.
+ */
+constexpr uint32_t ENCODING_MAGIC = 0x48434445;  // "EDCH"
+
+/**
+ * The version of the character data encoding.
+ */
+constexpr uint16_t ENCODING_VERSION = 1;
+
+/**
+ * Copies the current state of a player character. This should only be called from the world thread.
+ * @param player    The player character.
+ * @return          The character data.
+ */
+CharacterData CharacterData::of(Player& player)
+{
+    auto& pos        = player.position();
+    auto& stats      = player.stats();
+    auto& appearance = player.appearance();
+
+    CharacterData data;
+    data.name         = player.name();
+    data.race         = player.race();
+    data.job          = player.job();
+    data.gender       = appearance.gender();
+    data.face         = appearance.face();
+    data.hair         = appearance.hair();
+    data.height       = appearance.height();
+    data.map          = pos.map();
+    data.x            = pos.x();
+    data.y            = pos.y();
+    data.z            = pos.z();
+    data.statpoints   = player.statpoints();
+    data.strength     = stats.getBase(Stat::Strength);
+    data.dexterity    = stats.getBase(Stat::Dexterity);
+    data.reaction     = stats.getBase(Stat::Reaction);
+    data.intelligence = stats.getBase(Stat::Intelligence);
+    data.wisdom       = stats.getBase(Stat::Wisdom);
+    data.luck         = stats.getBase(Stat::Luck);
+    data.hitpoints    = static_cast<int32_t>(stats.currentHitpoints());
+    data.mana         = static_cast<int32_t>(stats.currentMana());
+    data.stamina      = static_cast<int32_t>(stats.currentStamina());
+    data.gold         = player.inventory().gold();
+
+    // The items are stored by the slot that they occupy
+    auto store = [](const ItemContainer& container, std::vector<StoredItem>& items) {
+        auto& slots = container.items();
+        for (size_t slot = 0; slot < slots.size(); slot++)
+        {
+            if (auto& item = slots.at(slot))
+                items.push_back({ item->itemId(), slot, item->quantity() });
+        }
+    };
+
+    store(player.inventory(), data.inventory);
+    store(player.equipment(), data.equipment);
+    return data;
+}
+
+/**
+ * Updates this data with the state held by a snapshot of the same character. The snapshot's item changes are
+ * applied to the stored items.
+ * @param snapshot  The snapshot.
+ */
+void CharacterData::update(const PlayerSnapshot& snapshot)
+{
+    map          = snapshot.map;
+    x            = snapshot.x;
+    y            = snapshot.y;
+    z            = snapshot.z;
+    statpoints   = snapshot.statpoints;
+    strength     = snapshot.strength;
+    dexterity    = snapshot.dexterity;
+    reaction     = snapshot.reaction;
+    intelligence = snapshot.intelligence;
+    wisdom       = snapshot.wisdom;
+    luck         = snapshot.luck;
+    hitpoints    = static_cast<int32_t>(snapshot.hitpoints);
+    mana         = static_cast<int32_t>(snapshot.mana);
+    stamina      = static_cast<int32_t>(snapshot.stamina);
+    gold         = snapshot.gold;
+
+    // Replace the stored item in each changed slot. An item id of zero means the slot is now empty.
+    auto applyChanges = [](std::vector<StoredItem>& items, const std::vector<ItemDelta>& deltas) {
+        for (auto&& delta: deltas)
+        {
+            auto slot = [&](auto& item) { return item.slot == delta.slot; };
+            items.erase(std::remove_if(items.begin(), items.end(), slot), items.end());
+
+            if (delta.itemId != 0)
+                items.push_back({ delta.itemId, delta.slot, delta.count });
+        }
+    };
+
+    applyChanges(inventory, snapshot.inventoryChanges);
+    applyChanges(equipment, snapshot.equipmentChanges);
+}
+
+/**
+ * Encodes this data in a versioned binary format, which is used for character files and for handing a character off to
+ * another zone.
+ * @return  The encoded data.
+ */
+std::string CharacterData::encode() const
+{
+    std::string bytes;
+    auto put      = [&](auto value) { bytes.append(reinterpret_cast<const char*>(&value), sizeof(value)); };
+    auto putItems = [&](const std::vector<CharacterData::StoredItem>& items) {
+        put(static_cast<uint32_t>(items.size()));
+        for (auto&& item: items)
+        {
+            put(static_cast<uint32_t>(item.itemId));
+            put(static_cast<uint32_t>(item.slot));
+            put(static_cast<uint32_t>(item.count));
+        }
+    };
+
+    put(ENCODING_MAGIC);
+    put(ENCODING_VERSION);
+    put(static_cast<uint16_t>(name.size()));
+    bytes.append(name);
+    put(static_cast<uint8_t>(race));
+    put(static_cast<uint8_t>(job));
+    put(static_cast<uint8_t>(gender));
+    put(static_cast<uint32_t>(face));
+    put(static_cast<uint32_t>(hair));
+    put(static_cast<uint32_t>(height));
+    put(map);
+    put(x);
+    put(y);
+    put(z);
+    put(static_cast<uint32_t>(statpoints));
+    put(strength);
+    put(dexterity);
+    put(reaction);
+    put(intelligence);
+    put(wisdom);
+    put(luck);
+    put(hitpoints);
+    put(mana);
+    put(stamina);
+    put(static_cast<uint64_t>(gold));
+    putItems(inventory);
+    putItems(equipment);
+    return bytes;
+}
+
+/**
+ * Decodes the data of a character.
+ * @param bytes     The encoded data.
+ * @param length    The length of the encoded data.
+ * @param data      The decoded character data.
+ * @return          If the data was decoded successfully.
+ */
+bool CharacterData::decode(const char* bytes, size_t length, CharacterData& data)
+{
+    size_t offset = 0;
+    bool valid    = true;
+
+    auto get = [&](auto& value) {
+        if (offset + sizeof(value) > length)
+        {
+            valid = false;
+            return;
+        }
+        std::memcpy(&value, bytes + offset, sizeof(value));
+        offset += sizeof(value);
+    };
+    auto getItems = [&](std::vector<CharacterData::StoredItem>& items) {
+        uint32_t count = 0;
+        get(count);
+        for (uint32_t i = 0; valid && i < count; i++)
+        {
+            uint32_t itemId   = 0;
+            uint32_t slot     = 0;
+            uint32_t quantity = 0;
+            get(itemId);
+            get(slot);
+            get(quantity);
+            items.push_back({ itemId, slot, quantity });
+        }
+    };
+
+    uint32_t magic   = 0;
+    uint16_t version = 0;
+    get(magic);
+    get(version);
+    if (!valid || magic != ENCODING_MAGIC || version != ENCODING_VERSION)
+        return false;
+
+    uint16_t nameLength = 0;
+    get(nameLength);
+    if (!valid || offset + nameLength > length)
+        return false;
+    data.name.assign(bytes + offset, nameLength);
+    offset += nameLength;
+
+    uint8_t race        = 0;
+    uint8_t job         = 0;
+    uint8_t gender      = 0;
+    uint32_t face       = 0;
+    uint32_t hair       = 0;
+    uint32_t height     = 0;
+    uint32_t statpoints = 0;
+    uint64_t gold       = 0;
+    get(race);
+    get(job);
+    get(gender);
+    get(face);
+    get(hair);
+    get(height);
+    get(data.map);
+    get(data.x);
+    get(data.y);
+    get(data.z);
+    get(statpoints);
+    get(data.strength);
+    get(data.dexterity);
+    get(data.reaction);
+    get(data.intelligence);
+    get(data.wisdom);
+    get(data.luck);
+    get(data.hitpoints);
+    get(data.mana);
+    get(data.stamina);
+    get(gold);
+    getItems(data.inventory);
+    getItems(data.equipment);
+
+    data.race       = static_cast<ShaiyaRace>(race);
+    data.job        = static_cast<ShaiyaClass>(job);
+    data.gender     = static_cast<ShaiyaGender>(gender);
+    data.face       = face;
+    data.hair       = hair;
+    data.height     = height;
+    data.statpoints = statpoints;
+    data.gold       = gold;
+    return valid && offset == length;
+}
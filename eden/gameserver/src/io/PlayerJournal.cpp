@@ -0,0 +1,345 @@
+#include <shaiya/game/io/PlayerJournal.hpp>
+
+#include <boost/crc.hpp>
+#include <boost/format.hpp>
+#include <boost/range/iterator_range.hpp>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace shaiya::game;
+
+/**
+ * The file extension of a journal segment.
+ */
+constexpr auto SEGMENT_EXTENSION = ".journal";
+
+/**
+ * The version of the record format.
+ */
+constexpr uint8_t RECORD_VERSION = 1;
+
+/**
+ * The size of a record header, which holds the length of the payload and its checksum.
+ */
+constexpr auto RECORD_HEADER_SIZE = sizeof(uint32_t) * 2;
+
+/**
+ * Opens the journal, and starts a new segment after any existing segments.
+ * @param directory The directory that holds the journal segments.
+ */
+PlayerJournal::PlayerJournal(const std::string& directory): directory_(directory)
+{
+    boost::filesystem::create_directories(directory_);
+
+    auto existing = segments();
+    current_      = existing.empty() ? 1 : existing.back() + 1;
+    open();
+}
+
+/**
+ * Closes the open segment.
+ */
+PlayerJournal::~PlayerJournal()
+{
+    if (fd_ == -1)
+        return;
+
+    ::fdatasync(fd_);
+    ::close(fd_);
+
+    // An empty segment holds nothing worth keeping
+    if (written_ == 0)
+        boost::filesystem::remove(segment(current_));
+}
+
+/**
+ * Reads the snapshots from the segments that existed when the journal was opened, in the order they were
+ * appended. A segment that ends with a torn or corrupt record, such as from a crash during a write, is read up
+ * to that record.
+ * @return  The snapshots.
+ */
+std::vector<PlayerSnapshot> PlayerJournal::replay() const
+{
+    std::vector<PlayerSnapshot> snapshots;
+    for (auto id: segments())
+    {
+        if (id >= current_)
+            break;
+
+        std::ifstream file(segment(id).string(), std::ios::binary);
+        std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        size_t offset = 0;
+        while (offset + RECORD_HEADER_SIZE <= contents.size())
+        {
+            uint32_t length   = 0;
+            uint32_t checksum = 0;
+            std::memcpy(&length, contents.data() + offset, sizeof(length));
+            std::memcpy(&checksum, contents.data() + offset + sizeof(length), sizeof(checksum));
+
+            auto payload = offset + RECORD_HEADER_SIZE;
+            if (payload + length > contents.size())
+                break;
+
+            boost::crc_32_type crc;
+            crc.process_bytes(contents.data() + payload, length);
+
+            PlayerSnapshot snapshot;
+            if (crc.checksum() != checksum || !decode(contents.data() + payload, length, snapshot))
+                break;
+
+            snapshots.push_back(std::move(snapshot));
+            offset = payload + length;
+        }
+
+        if (offset != contents.size())
+            LOG(INFO) << "Journal segment " << segment(id) << " ends with " << (contents.size() - offset)
+                      << " bytes of incomplete or corrupt records, which were skipped.";
+    }
+    return snapshots;
+}
+
+/**
+ * Appends a group of snapshots to the open segment. The snapshots are not durable until the journal is synced.
+ * @param snapshots The snapshots.
+ */
+void PlayerJournal::append(const std::vector<PlayerSnapshot>& snapshots)
+{
+    std::string buffer;
+    for (auto&& snapshot: snapshots)
+        encode(snapshot, buffer);
+
+    // Write the whole group, resuming after partial writes
+    size_t offset = 0;
+    while (offset < buffer.size())
+    {
+        auto result = ::write(fd_, buffer.data() + offset, buffer.size() - offset);
+        if (result < 0 && errno == EINTR)
+            continue;
+        if (result < 0)
+            throw std::system_error(errno, std::generic_category(), "Failed to append to the player journal");
+        offset += result;
+    }
+    written_ += buffer.size();
+}
+
+/**
+ * Flushes the appended snapshots to disk.
+ */
+void PlayerJournal::sync()
+{
+    if (::fdatasync(fd_) != 0)
+        throw std::system_error(errno, std::generic_category(), "Failed to sync the player journal");
+}
+
+/**
+ * Seals the open segment, and starts a new one. If nothing has been appended to the open segment, it is kept.
+ * @return  The id of the last sealed segment.
+ */
+size_t PlayerJournal::rotate()
+{
+    if (written_ == 0)
+        return current_ - 1;
+
+    sync();
+    ::close(fd_);
+
+    auto sealed = current_++;
+    open();
+    return sealed;
+}
+
+/**
+ * Deletes the sealed segments, up to and including a segment id.
+ * @param sealed    The id of the last segment to delete.
+ */
+void PlayerJournal::compact(size_t sealed)
+{
+    for (auto id: segments())
+    {
+        if (id > sealed || id >= current_)
+            break;
+        boost::filesystem::remove(segment(id));
+    }
+}
+
+/**
+ * Opens the segment with the current id.
+ */
+void PlayerJournal::open()
+{
+    auto path = segment(current_);
+    fd_       = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd_ == -1)
+        throw std::system_error(errno, std::generic_category(), "Failed to open journal segment " + path.string());
+    written_ = 0;
+}
+
+/**
+ * Gets the path of a segment.
+ * @param id    The segment id.
+ * @return      The path.
+ */
+boost::filesystem::path PlayerJournal::segment(size_t id) const
+{
+    return directory_ / (boost::format("%010d%s") % id % SEGMENT_EXTENSION).str();
+}
+
+/**
+ * Gets the ids of the segments on disk, in ascending order.
+ * @return  The segment ids.
+ */
+std::vector<size_t> PlayerJournal::segments() const
+{
+    using namespace boost::filesystem;
+
+    std::vector<size_t> ids;
+    for (auto& entry: boost::make_iterator_range(directory_iterator(directory_), {}))
+    {
+        auto& path = entry.path();
+        if (!is_regular_file(path) || path.extension() != SEGMENT_EXTENSION)
+            continue;
+
+        try
+        {
+            ids.push_back(std::stoul(path.stem().string()));
+        }
+        catch (const std::exception&)
+        {
+            LOG(INFO) << "Ignoring unrecognised file " << path << " in the player journal.";
+        }
+    }
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+/**
+ * Encodes a snapshot as a journal record, and appends it to a buffer.
+ * @param snapshot  The snapshot.
+ * @param buffer    The buffer.
+ */
+void PlayerJournal::encode(const PlayerSnapshot& snapshot, std::string& buffer)
+{
+    // Reserve the header, which is written once the length of the payload is known
+    auto header = buffer.size();
+    buffer.resize(header + RECORD_HEADER_SIZE);
+
+    auto put = [&](auto value) { buffer.append(reinterpret_cast<const char*>(&value), sizeof(value)); };
+    auto putItems = [&](const std::vector<ItemDelta>& deltas) {
+        put(static_cast<uint32_t>(deltas.size()));
+        for (auto&& delta: deltas)
+        {
+            put(static_cast<uint32_t>(delta.slot));
+            put(static_cast<uint32_t>(delta.itemId));
+            put(static_cast<uint32_t>(delta.count));
+        }
+    };
+
+    put(RECORD_VERSION);
+    put(static_cast<uint64_t>(snapshot.id));
+    put(snapshot.map);
+    put(snapshot.x);
+    put(snapshot.y);
+    put(snapshot.z);
+    put(snapshot.statpoints);
+    put(snapshot.strength);
+    put(snapshot.dexterity);
+    put(snapshot.reaction);
+    put(snapshot.intelligence);
+    put(snapshot.wisdom);
+    put(snapshot.luck);
+    put(snapshot.hitpoints);
+    put(snapshot.mana);
+    put(snapshot.stamina);
+    put(static_cast<uint64_t>(snapshot.gold));
+    putItems(snapshot.inventoryChanges);
+    putItems(snapshot.equipmentChanges);
+
+    // Write the header
+    auto payload = header + RECORD_HEADER_SIZE;
+    auto length  = static_cast<uint32_t>(buffer.size() - payload);
+
+    boost::crc_32_type crc;
+    crc.process_bytes(buffer.data() + payload, length);
+    auto checksum = static_cast<uint32_t>(crc.checksum());
+
+    std::memcpy(buffer.data() + header, &length, sizeof(length));
+    std::memcpy(buffer.data() + header + sizeof(length), &checksum, sizeof(checksum));
+}
+
+/**
+ * Decodes the payload of a journal record.
+ * @param data      The payload.
+ * @param length    The length of the payload.
+ * @param snapshot  The decoded snapshot.
+ * @return          If the payload was decoded successfully.
+ */
+bool PlayerJournal::decode(const char* data, size_t length, PlayerSnapshot& snapshot)
+{
+    size_t offset = 0;
+    bool valid    = true;
+
+    auto get = [&](auto& value) {
+        if (offset + sizeof(value) > length)
+        {
+            valid = false;
+            return;
+        }
+        std::memcpy(&value, data + offset, sizeof(value));
+        offset += sizeof(value);
+    };
+    auto getItems = [&](std::vector<ItemDelta>& deltas) {
+        uint32_t count = 0;
+        get(count);
+        for (uint32_t i = 0; valid && i < count; i++)
+        {
+            uint32_t slot     = 0;
+            uint32_t itemId   = 0;
+            uint32_t quantity = 0;
+            get(slot);
+            get(itemId);
+            get(quantity);
+            deltas.push_back({ slot, itemId, quantity });
+        }
+    };
+
+    uint8_t version = 0;
+    get(version);
+    if (version != RECORD_VERSION)
+        return false;
+
+    uint64_t id   = 0;
+    uint64_t gold = 0;
+    get(id);
+    get(snapshot.map);
+    get(snapshot.x);
+    get(snapshot.y);
+    get(snapshot.z);
+    get(snapshot.statpoints);
+    get(snapshot.strength);
+    get(snapshot.dexterity);
+    get(snapshot.reaction);
+    get(snapshot.intelligence);
+    get(snapshot.wisdom);
+    get(snapshot.luck);
+    get(snapshot.hitpoints);
+    get(snapshot.mana);
+    get(snapshot.stamina);
+    get(gold);
+    getItems(snapshot.inventoryChanges);
+    getItems(snapshot.equipmentChanges);
+
+    snapshot.id      = id;
+    snapshot.gold    = gold;
+    snapshot.takenAt = std::chrono::steady_clock::now();
+    return valid && offset == length;
+}
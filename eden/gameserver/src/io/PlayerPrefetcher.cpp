@@ -0,0 +1,145 @@
+#include <shaiya/common/util/Async.hpp>
+#include <shaiya/game/io/PlayerPrefetcher.hpp>
+#include <shaiya/game/service/PersistenceService.hpp>
+
+#include <sstream>
+
+using namespace shaiya::game;
+
+/**
+ * Initialises this prefetcher.
+ * @param persistence   The persistence service used to read the characters.
+ * @param ttl           The time that prefetched data stays fresh for.
+ */
+PlayerPrefetcher::PlayerPrefetcher(PersistenceService& persistence, std::chrono::milliseconds ttl)
+    : persistence_(persistence), ttl_(ttl)
+{
+}
+
+/**
+ * Starts reading the data of a character in the background, unless it is already prefetched.
+ * @param id    The id of the character.
+ */
+void PlayerPrefetcher::prefetch(size_t id)
+{
+    size_t token = 0;
+    {
+        std::lock_guard lock{ mutex_ };
+        expire();
+
+        auto [pos, inserted] = entries_.try_emplace(id);
+        if (!inserted)
+            return;
+        token = pos->second.token = nextToken_++;
+    }
+
+    auto task = [&, id, token]() { read(id, token); };
+    ASYNC(task)
+}
+
+/**
+ * Claims the prefetched data of a character. If the data has been read, it is returned straight away, and if it is
+ * still being read, the callback receives it once the read finishes.
+ * @param id        The id of the character.
+ * @param data      The prefetched data, if it has already been read.
+ * @param callback  The callback that receives the data, if it is still being read.
+ * @return          If the character was prefetched, and the data was claimed.
+ */
+bool PlayerPrefetcher::claim(size_t id, std::optional<CharacterData>& data, Callback callback)
+{
+    std::lock_guard lock{ mutex_ };
+    expire();
+
+    // A failed read isn't claimed, so the character is read again
+    auto pos = entries_.find(id);
+    if (pos == entries_.end() || pos->second.callback || (pos->second.ready && !pos->second.data))
+        return false;
+
+    auto& entry = pos->second;
+    hits_++;
+    if (!entry.ready)
+    {
+        entry.callback = std::move(callback);
+        return true;
+    }
+
+    data = std::move(entry.data);
+    entries_.erase(pos);
+    return true;
+}
+
+/**
+ * Discards the prefetched data of a character, as its persisted state is about to change.
+ * @param id    The id of the character.
+ */
+void PlayerPrefetcher::invalidate(size_t id)
+{
+    std::lock_guard lock{ mutex_ };
+    auto pos = entries_.find(id);
+
+    // A claimed prefetch already belongs to a player that is loading
+    if (pos == entries_.end() || pos->second.callback)
+        return;
+
+    entries_.erase(pos);
+    wasted_++;
+}
+
+/**
+ * Summarises how many prefetches were used, and how many were wasted.
+ * @return  The summary
+ */
+std::string PlayerPrefetcher::report() const
+{
+    std::stringstream stream;
+    stream << "Character prefetch: " << hits_ << " hits, " << wasted_ << " wasted.";
+    return stream.str();
+}
+
+/**
+ * Reads the data of a character, and completes its prefetch.
+ * @param id    The id of the character.
+ * @param token The token of the prefetch.
+ */
+void PlayerPrefetcher::read(size_t id, size_t token)
+{
+    auto data = persistence_.read(id);
+
+    Callback callback;
+    {
+        std::lock_guard lock{ mutex_ };
+        auto pos = entries_.find(id);
+        if (pos == entries_.end() || pos->second.token != token)
+            return;
+
+        auto& entry = pos->second;
+        if (!entry.callback)
+        {
+            entry.ready  = true;
+            entry.data   = std::move(data);
+            entry.readAt = std::chrono::steady_clock::now();
+            return;
+        }
+
+        callback = std::move(entry.callback);
+        entries_.erase(pos);
+    }
+
+    // Deliver the data to the claim that was waiting for it, without holding the lock
+    callback(std::move(data));
+}
+
+/**
+ * Discards the prefetches that have expired without being claimed. This must be called while holding the mutex.
+ */
+void PlayerPrefetcher::expire()
+{
+    auto now = std::chrono::steady_clock::now();
+    std::erase_if(entries_, [&](auto& element) {
+        auto& [id, entry] = element;
+        auto expired      = entry.ready && now - entry.readAt > ttl_;
+        if (expired)
+            wasted_++;
+        return expired;
+    });
+}
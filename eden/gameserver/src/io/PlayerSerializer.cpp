@@ -0,0 +1,156 @@
+#include <shaiya/common/client/item/ItemSData.hpp>
+#include <shaiya/game/io/PlayerSerializer.hpp>
+#include <shaiya/game/model/actor/player/Player.hpp>
+#include <shaiya/game/model/item/Item.hpp>
+
+#include <string>
+
+using namespace shaiya::game;
+
+/**
+ * Initialises this serializer.
+ * @param itemDefs  The item definitions.
+ */
+PlayerSerializer::PlayerSerializer(const shaiya::client::ItemSData& itemDefs): itemDefs_(itemDefs)
+{
+}
+
+/**
+ * Initialises this serializer, with a prototype for the characters that don't exist in storage yet.
+ * @param itemDefs  The item definitions.
+ * @param prototype The prototype of a new character.
+ */
+PlayerSerializer::PlayerSerializer(const shaiya::client::ItemSData& itemDefs, CharacterData prototype)
+    : itemDefs_(itemDefs), prototype_(std::move(prototype))
+{
+}
+
+/**
+ * Loads a player character.
+ * @param character The character to load.
+ */
+bool PlayerSerializer::load(Player& player)
+{
+    auto data = read(player.id());
+    if (!data)
+        return false;
+
+    apply(player, *data);
+    return true;
+}
+
+/**
+ * Applies previously read character data to a player character.
+ * @param player    The player character.
+ * @param data      The character data.
+ */
+void PlayerSerializer::apply(Player& player, const CharacterData& data)
+{
+    // Set the character name, race and class
+    player.setName(data.name);
+    player.setRace(data.race);
+    player.setJob(data.job);
+    player.setStatpoints(data.statpoints);
+
+    // Set the character appearance
+    auto& appearance = player.appearance();
+    appearance.setFace(data.face);
+    appearance.setHair(data.hair);
+    appearance.setHeight(data.height);
+    appearance.setGender(data.gender);
+
+    // Set the position
+    player.setPosition({ data.map, data.x, data.y, data.z });
+
+    // Add the inventory items and gold
+    auto& inventory = player.inventory();
+    inventory.setGold(data.gold);
+    for (auto&& stored: data.inventory)
+    {
+        auto* def = itemDefs_.forId(stored.itemId);
+        if (!def)
+            continue;
+
+        auto item = std::make_shared<Item>(*def);
+        item->setQuantity(stored.count);
+        inventory.add(std::move(item), stored.slot);
+    }
+
+    // Add the equipped items
+    auto& equipment = player.equipment();
+    for (auto&& stored: data.equipment)
+    {
+        auto* def = itemDefs_.forId(stored.itemId);
+        if (!def)
+            continue;
+
+        equipment.add(std::make_shared<Item>(*def), static_cast<EquipmentSlot>(stored.slot));
+    }
+
+    // The stored items are already persisted, so they aren't changes that need to be saved
+    inventory.clearChanges();
+    equipment.clearChanges();
+
+    // Set the base stats
+    auto& stats = player.stats();
+    stats.setBase(Stat::Strength, data.strength);
+    stats.setBase(Stat::Dexterity, data.dexterity);
+    stats.setBase(Stat::Reaction, data.reaction);
+    stats.setBase(Stat::Intelligence, data.intelligence);
+    stats.setBase(Stat::Wisdom, data.wisdom);
+    stats.setBase(Stat::Luck, data.luck);
+    stats.sync();
+    stats.setHitpoints(data.hitpoints);
+    stats.setMana(data.mana);
+    stats.setStamina(data.stamina);
+}
+
+/**
+ * Saves a player character.
+ * @param character The character to save.
+ */
+void PlayerSerializer::save(Player& player)
+{
+    save(std::vector<PlayerSnapshot>{ PlayerSnapshot::of(player) });
+}
+
+/**
+ * Creates the data of a character that doesn't exist in storage yet, from the prototype.
+ * @param id    The id of the character.
+ * @return      The character data.
+ */
+CharacterData PlayerSerializer::create(size_t id) const
+{
+    auto data = prototype_;
+    data.name = "Player" + std::to_string(id);
+    return data;
+}
+
+/**
+ * Creates the data of a character that was created on the character screen, from the prototype.
+ * @param entry The character list entry of the new character.
+ * @return      The character data.
+ */
+CharacterData PlayerSerializer::create(const shaiya::net::CharacterListEntry& entry) const
+{
+    auto data   = prototype_;
+    data.name   = entry.name.str();
+    data.race   = entry.race;
+    data.job    = entry.job;
+    data.gender = static_cast<shaiya::ShaiyaGender>(entry.gender);
+    data.face   = entry.face;
+    data.hair   = entry.hair;
+    data.height = entry.height;
+    return data;
+}
+
+/**
+ * Adds a character that was created on the character screen, when this serializer is the only storage of characters.
+ * The character is created from the prototype, with the chosen name, race, class and appearance.
+ * @param entry The character list entry of the new character.
+ * @return      The id of the new character, or an empty optional if this serializer can't add characters.
+ */
+std::optional<size_t> PlayerSerializer::add(const shaiya::net::CharacterListEntry& entry)
+{
+    return std::nullopt;
+}
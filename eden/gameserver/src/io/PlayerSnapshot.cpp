@@ -0,0 +1,88 @@
+#include <shaiya/game/io/PlayerSnapshot.hpp>
+#include <shaiya/game/model/actor/player/Player.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace shaiya::game;
+
+/**
+ * Takes a snapshot of a player character. This should only be called from the world thread. The change journals of
+ * the character's inventory and equipment are drained into the snapshot, so every snapshot that is taken must be
+ * saved.
+ * @param player    The player character.
+ * @return          The snapshot.
+ */
+PlayerSnapshot PlayerSnapshot::of(Player& player)
+{
+    auto& pos   = player.position();
+    auto& stats = player.stats();
+
+    PlayerSnapshot snapshot;
+    snapshot.id               = player.id();
+    snapshot.map              = pos.map();
+    snapshot.x                = pos.x();
+    snapshot.y                = pos.y();
+    snapshot.z                = pos.z();
+    snapshot.statpoints       = player.statpoints();
+    snapshot.strength         = stats.getBase(Stat::Strength);
+    snapshot.dexterity        = stats.getBase(Stat::Dexterity);
+    snapshot.reaction         = stats.getBase(Stat::Reaction);
+    snapshot.intelligence     = stats.getBase(Stat::Intelligence);
+    snapshot.wisdom           = stats.getBase(Stat::Wisdom);
+    snapshot.luck             = stats.getBase(Stat::Luck);
+    snapshot.hitpoints        = stats.currentHitpoints();
+    snapshot.mana             = stats.currentMana();
+    snapshot.stamina          = stats.currentStamina();
+    snapshot.gold             = player.inventory().gold();
+    snapshot.inventoryChanges = player.inventory().takeChanges();
+    snapshot.equipmentChanges = player.equipment().takeChanges();
+    snapshot.takenAt          = std::chrono::steady_clock::now();
+    return snapshot;
+}
+
+/**
+ * Checks if this snapshot can be saved, which requires the character's position to be finite.
+ * @return  If the snapshot is valid.
+ */
+bool PlayerSnapshot::valid() const
+{
+    return std::isfinite(x) && std::isfinite(y) && std::isfinite(z);
+}
+
+/**
+ * Checks if this snapshot holds the same state as another snapshot. The time at which the snapshots were taken
+ * is not compared.
+ * @param other The other snapshot.
+ * @return      If the snapshots hold the same state.
+ */
+bool PlayerSnapshot::sameStateAs(const PlayerSnapshot& other) const
+{
+    return id == other.id && map == other.map && x == other.x && y == other.y && z == other.z &&
+           statpoints == other.statpoints && strength == other.strength && dexterity == other.dexterity &&
+           reaction == other.reaction && intelligence == other.intelligence && wisdom == other.wisdom &&
+           luck == other.luck && hitpoints == other.hitpoints && mana == other.mana && stamina == other.stamina &&
+           gold == other.gold;
+}
+
+/**
+ * Carries over the item changes of an older snapshot of the same character, for the slots that haven't changed
+ * again since. This is used when a newer snapshot replaces an older one before the older one was saved.
+ * @param older The older snapshot.
+ */
+void PlayerSnapshot::inheritChanges(const PlayerSnapshot& older)
+{
+    // Adds the older deltas for the slots that the newer deltas don't already cover
+    auto inherit = [](std::vector<ItemDelta>& newer, const std::vector<ItemDelta>& deltas) {
+        auto size = newer.size();
+        for (auto&& delta: deltas)
+        {
+            auto end = newer.begin() + size;
+            if (std::none_of(newer.begin(), end, [&](auto& other) { return other.slot == delta.slot; }))
+                newer.push_back(delta);
+        }
+    };
+
+    inherit(inventoryChanges, older.inventoryChanges);
+    inherit(equipmentChanges, older.equipmentChanges);
+}
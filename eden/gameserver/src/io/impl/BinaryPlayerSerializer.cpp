@@ -0,0 +1,183 @@
+#include <shaiya/game/io/impl/BinaryPlayerSerializer.hpp>
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace shaiya::game;
+
+/**
+ * The file extension of a character file.
+ */
+constexpr auto FILE_EXTENSION = ".character";
+
+/**
+ * Initialises this character serializer.
+ * @param itemDefs  The item definitions.
+ * @param directory The directory that holds the character files.
+ * @param prototype The prototype of a new character.
+ */
+BinaryPlayerSerializer::BinaryPlayerSerializer(const shaiya::client::ItemSData& itemDefs, const std::string& directory,
+                                               CharacterData prototype)
+    : PlayerSerializer(itemDefs, std::move(prototype)), directory_(directory)
+{
+    boost::filesystem::create_directories(directory_);
+
+    // The files outlive the process, so new characters are given ids above those of the existing files
+    for (auto&& entry: boost::filesystem::directory_iterator(directory_))
+    {
+        auto& file = entry.path();
+        auto stem  = file.stem().string();
+        if (file.extension() != FILE_EXTENSION || stem.empty() || !std::all_of(stem.begin(), stem.end(), ::isdigit))
+            continue;
+        nextId_ = std::max<size_t>(nextId_, std::stoull(stem) + 1);
+    }
+}
+
+/**
+ * Reads the state of a character from its file, or creates it from the prototype if it doesn't have a file.
+ * @param id    The id of the character.
+ * @return      The character data, or an empty optional if the file couldn't be read.
+ */
+std::optional<CharacterData> BinaryPlayerSerializer::read(size_t id)
+{
+    auto file = path(id);
+    auto fd   = ::open(file.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+    {
+        if (errno == ENOENT)
+            return create(id);
+
+        LOG(INFO) << "Failed to open character file " << file << ": " << std::strerror(errno);
+        return std::nullopt;
+    }
+
+    // Map the whole file, and decode it in place
+    struct stat info{};
+    void* mapping = MAP_FAILED;
+    if (::fstat(fd, &info) == 0 && info.st_size > 0)
+        mapping = ::mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    ::close(fd);
+
+    if (mapping == MAP_FAILED)
+    {
+        LOG(INFO) << "Failed to map character file " << file << ".";
+        return std::nullopt;
+    }
+
+    CharacterData data;
+    auto valid = CharacterData::decode(static_cast<const char*>(mapping), info.st_size, data);
+    ::munmap(mapping, info.st_size);
+
+    if (!valid)
+    {
+        LOG(INFO) << "Character file " << file << " is corrupt, or has an unsupported version.";
+        return std::nullopt;
+    }
+    return data;
+}
+
+/**
+ * Saves a batch of player snapshots, by updating the file of each character.
+ * @param snapshots The snapshots to save.
+ * @return          If the snapshots were saved successfully.
+ */
+bool BinaryPlayerSerializer::save(const std::vector<PlayerSnapshot>& snapshots)
+{
+    std::lock_guard lock{ mutex_ };
+    try
+    {
+        for (auto&& snapshot: snapshots)
+        {
+            auto data = read(snapshot.id);
+            if (!data)
+                return false;
+
+            data->update(snapshot);
+            write(snapshot.id, *data);
+        }
+        return true;
+    }
+    catch (const std::exception& e)
+    {
+        LOG(INFO) << "Exception occurred while saving " << snapshots.size() << " character files: " << e.what();
+    }
+    return false;
+}
+
+/**
+ * Adds a character that was created on the character screen, with an id above those of the existing character files.
+ * @param entry The character list entry of the new character.
+ * @return      The id of the new character, or an empty optional if its file couldn't be written.
+ */
+std::optional<size_t> BinaryPlayerSerializer::add(const shaiya::net::CharacterListEntry& entry)
+{
+    std::lock_guard lock{ mutex_ };
+    try
+    {
+        auto id = nextId_++;
+        write(id, create(entry));
+        return id;
+    }
+    catch (const std::exception& e)
+    {
+        LOG(INFO) << "Exception occurred while adding a character file: " << e.what();
+    }
+    return std::nullopt;
+}
+
+/**
+ * Gets the path of a character's file.
+ * @param id    The id of the character.
+ * @return      The path.
+ */
+boost::filesystem::path BinaryPlayerSerializer::path(size_t id) const
+{
+    return directory_ / (std::to_string(id) + FILE_EXTENSION);
+}
+
+/**
+ * Writes the data of a character to its file. The data is written to a temporary file first, which then replaces
+ * the character's file, so a reader never sees a partially written file.
+ * @param id    The id of the character.
+ * @param data  The character data.
+ */
+void BinaryPlayerSerializer::write(size_t id, const CharacterData& data) const
+{
+    auto file      = path(id);
+    auto temporary = file;
+    temporary += ".tmp";
+
+    auto bytes = data.encode();
+    auto fd    = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd == -1)
+        throw std::system_error(errno, std::generic_category(), "Failed to create " + temporary.string());
+
+    size_t offset = 0;
+    while (offset < bytes.size())
+    {
+        auto result = ::write(fd, bytes.data() + offset, bytes.size() - offset);
+        if (result < 0 && errno == EINTR)
+            continue;
+        if (result < 0)
+        {
+            auto error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "Failed to write " + temporary.string());
+        }
+        offset += result;
+    }
+    ::close(fd);
+
+    if (::rename(temporary.c_str(), file.c_str()) != 0)
+        throw std::system_error(errno, std::generic_category(), "Failed to replace " + file.string());
+}
@@ -4,237 +4,276 @@
 #include <shaiya/game/model/actor/player/Player.hpp>
 #include <shaiya/game/model/item/Item.hpp>
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
 using namespace shaiya::database;
 using namespace shaiya::game;
 
 /**
- * The name of the query for loading a character's details.
+ * The name under which the latency of loading a character is recorded.
  */
-constexpr auto LOAD_CHARACTER_DETAILS = "load_character_details";
+constexpr auto LOAD_CHARACTER = "load_character";
 
 /**
- * The name of the query for loading a character's inventory.
+ * The name under which the latency of saving a batch of characters is recorded.
  */
-constexpr auto LOAD_CHARACTER_INVENTORY = "load_character_inventory";
+constexpr auto SAVE_CHARACTER_BATCH = "save_character_batch";
 
 /**
- * The name of the query for loading a character's equipment
+ * The name of the statement that updates the details of a chunk of characters.
  */
-constexpr auto LOAD_CHARACTER_EQUIPMENT = "load_character_equipment";
+constexpr auto SAVE_CHARACTER_DETAILS = "save_character_details";
 
 /**
- * The name of the query for saving a character's details.
+ * The name of the statement that applies a chunk of inventory changes.
  */
-constexpr auto SAVE_CHARACTER_DETAILS = "save_character_details";
+constexpr auto SAVE_INVENTORY_CHANGES = "save_inventory_changes";
 
 /**
- * Initialises this character serializer.
- * @param db            The database service.
- * @param itemService   The item definition service.
- * @param worldId       The id of this world server.
+ * The name of the statement that applies a chunk of equipment changes.
  */
-DatabasePlayerSerializer::DatabasePlayerSerializer(DatabaseService& db, shaiya::client::ItemSData& itemDefs, size_t worldId)
-    : db_(db), itemDefs_(itemDefs), worldId_(worldId)
-{
-    db.prepare(LOAD_CHARACTER_DETAILS, "SELECT * FROM gamedata.characters WHERE world = $1 AND charid = $2;");
-    db.prepare(LOAD_CHARACTER_INVENTORY, "SELECT * FROM gamedata.read_character_inventory($1, $2);");
-    db.prepare(LOAD_CHARACTER_EQUIPMENT, "SELECT * FROM gamedata.read_character_equipment($1, $2);");
-    db.prepare(SAVE_CHARACTER_DETAILS,
-               "UPDATE gamedata.characters SET map = $3, posX = $4, posY = $5, posZ = $6, statpoints = $7, strength = $8, "
-               "dexterity = $9, reaction = $10, intelligence = $11, wisdom = $12, luck = $13, hitpoints = $14, mana = $15, "
-               "stamina = $16 WHERE world = $1 "
-               "AND charid = $2;");
-}
+constexpr auto SAVE_EQUIPMENT_CHANGES = "save_equipment_changes";
 
 /**
- * Loads a player character.
- * @param character The character to load.
+ * The maximum number of characters that are updated by a single statement.
  */
-bool DatabasePlayerSerializer::load(Player& player)
-{
-    try
-    {
-        // Create a new connection to the database
-        auto connection = db_.connection();
-        pqxx::work tx(*connection);
-
-        // Fetch the character details
-        auto rows = tx.exec_prepared(LOAD_CHARACTER_DETAILS, worldId_, player.id());
-        if (rows.empty())
-            return false;
+constexpr auto SAVE_BATCH_ROWS = 500;
 
-        // The details row
-        auto row = rows.front();
-
-        // Set the character name, race and class
-        player.setName(row["name"].as<std::string>());
-        player.setRace(static_cast<ShaiyaRace>(row["race"].as<size_t>()));
-        player.setJob(static_cast<ShaiyaClass>(row["class"].as<size_t>()));
-        player.setStatpoints(row["statpoints"].as<size_t>());
-
-        // Set the character appearance
-        auto& appearance = player.appearance();
-        appearance.setFace(row["face"].as<size_t>());
-        appearance.setHair(row["hair"].as<size_t>());
-        appearance.setHeight(row["height"].as<size_t>());
-        appearance.setGender(static_cast<ShaiyaGender>(row["gender"].as<size_t>()));
-
-        // Build the position
-        auto map  = row["map"].as<size_t>();
-        auto posX = row["posx"].as<float>();
-        auto posY = row["posy"].as<float>();
-        auto posZ = row["posz"].as<float>();
-        player.setPosition({ static_cast<uint16_t>(map), posX, posY, posZ });
-
-        if (!loadInventory(player))
-            return false;
-        if (!loadEquipment(player))
-            return false;
-
-        // Set the base stats
-        auto& stats = player.stats();
-        stats.setBase(Stat::Strength, row["strength"].as<size_t>());
-        stats.setBase(Stat::Dexterity, row["dexterity"].as<size_t>());
-        stats.setBase(Stat::Reaction, row["reaction"].as<size_t>());
-        stats.setBase(Stat::Intelligence, row["intelligence"].as<size_t>());
-        stats.setBase(Stat::Wisdom, row["wisdom"].as<size_t>());
-        stats.setBase(Stat::Luck, row["luck"].as<size_t>());
-        stats.sync();
-        stats.setHitpoints(row["hitpoints"].as<size_t>());
-        stats.setMana(row["mana"].as<size_t>());
-        stats.setStamina(row["stamina"].as<size_t>());
-
-        return true;
-    }
-    catch (const std::exception& e)
-    {
-        LOG(INFO) << "Exception occurred while loading character with id " << player.id() << ": " << e.what();
-    }
-    return false;
-}
+/**
+ * The maximum number of item changes that are applied by a single statement.
+ */
+constexpr auto SAVE_BATCH_ITEMS = 2000;
 
 /**
- * Loads the inventory of this character.
- * @param character The character.
- * @return          If the inventory was successfully loaded.
+ * Initialises this character serializer.
+ * @param db            The database service.
+ * @param itemDefs      The item definitions.
+ * @param worldId       The id of this world server.
  */
-bool DatabasePlayerSerializer::loadInventory(Player& player)
+DatabasePlayerSerializer::DatabasePlayerSerializer(DatabaseService& db, const shaiya::client::ItemSData& itemDefs,
+                                                   size_t worldId)
+    : PlayerSerializer(itemDefs), db_(db), worldId_(worldId)
 {
-    try
-    {
-        // Create a new connection to the database
-        auto connection = db_.connection();
-        pqxx::work tx(*connection);
-
-        // The character's inventory
-        auto& inventory = player.inventory();
-
-        // Fetch the character inventory
-        auto rows = tx.exec_prepared(LOAD_CHARACTER_INVENTORY, worldId_, player.id());
-        if (rows.empty())
-            return true;
-
-        // Loop through the inventory rows
-        for (auto&& row: rows)
-        {
-            // Read the item details
-            auto id    = row["itemid"].as<size_t>();
-            auto slot  = row["slot"].as<size_t>();
-            auto count = row["count"].as<size_t>();
-
-            // The item definition
-            auto* def = itemDefs_.forId(id);
-            if (!def)
-                continue;
-
-            // The item instance
-            auto item = std::make_shared<Item>(*def);
-            item->setQuantity(count);
-
-            // Add the item
-            inventory.add(std::move(item), slot);
-        }
-        return true;
-    }
-    catch (const std::exception& e)
-    {
-        LOG(INFO) << "Exception occurred while loading inventory for character  with id " << player.id() << ": " << e.what();
-    }
-    return false;
+    // The values of each chunk are bound as parallel arrays, which are unnested into rows and joined against the
+    // characters table, so no value is ever written into the statement itself
+    db_.prepare(SAVE_CHARACTER_DETAILS,
+                "UPDATE gamedata.characters AS c SET map = v.map, posX = v.posX, posY = v.posY, posZ = v.posZ, "
+                "statpoints = v.statpoints, strength = v.strength, dexterity = v.dexterity, reaction = v.reaction, "
+                "intelligence = v.intelligence, wisdom = v.wisdom, luck = v.luck, hitpoints = v.hitpoints, "
+                "mana = v.mana, stamina = v.stamina, gold = v.gold FROM unnest($2::integer[], $3::integer[], "
+                "$4::real[], $5::real[], $6::real[], $7::integer[], $8::integer[], $9::integer[], $10::integer[], "
+                "$11::integer[], $12::integer[], $13::integer[], $14::integer[], $15::integer[], $16::integer[], "
+                "$17::bigint[]) AS v(charid, map, posX, posY, posZ, statpoints, strength, dexterity, reaction, "
+                "intelligence, wisdom, luck, hitpoints, mana, stamina, gold) WHERE c.world = $1 AND c.charid = v.charid;");
+    db_.prepare(SAVE_INVENTORY_CHANGES, "SELECT gamedata.save_inventory_changes($1, $2::integer[], $3::integer[], "
+                                        "$4::integer[], $5::integer[]);");
+    db_.prepare(SAVE_EQUIPMENT_CHANGES, "SELECT gamedata.save_equipment_changes($1, $2::integer[], $3::integer[], "
+                                        "$4::integer[], $5::integer[]);");
 }
 
 /**
- * Loads the equipment of this character.
- * @param character The character.
- * @return          If the equipment was successfully loaded.
+ * Reads the details, inventory and equipment of a character in a single transaction. The three queries are
+ * pipelined, so they are sent to the database in a single round trip.
+ * @param id    The id of the character.
+ * @return      The character data, or an empty optional if the character couldn't be read.
  */
-bool DatabasePlayerSerializer::loadEquipment(Player& player)
+std::optional<CharacterData> DatabasePlayerSerializer::read(size_t id)
 {
     try
     {
         // Create a new connection to the database
         auto connection = db_.connection();
+        auto start      = std::chrono::steady_clock::now();
         pqxx::work tx(*connection);
 
-        // The character's equipment
-        auto& equipment = player.equipment();
+        // The arguments shared by each query
+        auto args = "(" + tx.quote(worldId_) + ", " + tx.quote(id) + ")";
+
+        // Queue the queries, which are sent together
+        pqxx::pipeline pipeline(tx);
+        auto detailsQuery =
+            pipeline.insert("SELECT * FROM gamedata.characters WHERE world = " + tx.quote(worldId_) + " AND charid = " +
+                            tx.quote(id) + ";");
+        auto inventoryQuery = pipeline.insert("SELECT * FROM gamedata.read_character_inventory" + args + ";");
+        auto equipmentQuery = pipeline.insert("SELECT * FROM gamedata.read_character_equipment" + args + ";");
+
+        auto details   = pipeline.retrieve(detailsQuery);
+        auto inventory = pipeline.retrieve(inventoryQuery);
+        auto equipment = pipeline.retrieve(equipmentQuery);
+        pipeline.complete();
+        tx.commit();
+        db_.record(LOAD_CHARACTER, std::chrono::steady_clock::now() - start);
 
-        // Fetch the character inventory
-        auto rows = tx.exec_prepared(LOAD_CHARACTER_EQUIPMENT, worldId_, player.id());
-        if (rows.empty())
-            return true;
+        if (details.empty())
+            return std::nullopt;
 
-        // Loop through the equipment rows
-        for (auto&& row: rows)
+        // The details row
+        auto row = details.front();
+        CharacterData data;
+
+        // The character name, race and class
+        data.name       = row["name"].as<std::string>();
+        data.race       = static_cast<ShaiyaRace>(row["race"].as<size_t>());
+        data.job        = static_cast<ShaiyaClass>(row["class"].as<size_t>());
+        data.statpoints = row["statpoints"].as<size_t>();
+
+        // The character appearance
+        data.face   = row["face"].as<size_t>();
+        data.hair   = row["hair"].as<size_t>();
+        data.height = row["height"].as<size_t>();
+        data.gender = static_cast<ShaiyaGender>(row["gender"].as<size_t>());
+
+        // The position
+        data.map = static_cast<uint16_t>(row["map"].as<size_t>());
+        data.x   = row["posx"].as<float>();
+        data.y   = row["posy"].as<float>();
+        data.z   = row["posz"].as<float>();
+
+        // The base stats
+        data.strength     = row["strength"].as<int32_t>();
+        data.dexterity    = row["dexterity"].as<int32_t>();
+        data.reaction     = row["reaction"].as<int32_t>();
+        data.intelligence = row["intelligence"].as<int32_t>();
+        data.wisdom       = row["wisdom"].as<int32_t>();
+        data.luck         = row["luck"].as<int32_t>();
+        data.hitpoints    = row["hitpoints"].as<int32_t>();
+        data.mana         = row["mana"].as<int32_t>();
+        data.stamina      = row["stamina"].as<int32_t>();
+
+        // The gold column is added by a migration, and is null for the characters that existed before it
+        data.gold = row["gold"].as<size_t>(0);
+
+        // The inventory items
+        for (auto&& item: inventory)
         {
-            // Read the item details
-            auto id   = row["itemid"].as<size_t>();
-            auto slot = row["slot"].as<size_t>();
-
-            // The item definition
-            auto* def = itemDefs_.forId(id);
-            if (!def)
-                continue;
+            auto itemId = item["itemid"].as<uint32_t>();
+            auto slot   = item["slot"].as<size_t>();
+            auto count  = item["count"].as<size_t>();
+            data.inventory.push_back({ itemId, slot, count });
+        }
 
-            // Add the item
-            equipment.add(std::make_shared<Item>(*def), static_cast<EquipmentSlot>(slot));
+        // The equipped items
+        for (auto&& item: equipment)
+        {
+            auto itemId = item["itemid"].as<uint32_t>();
+            auto slot   = item["slot"].as<size_t>();
+            data.equipment.push_back({ itemId, slot });
         }
-        return true;
+        return data;
     }
     catch (const std::exception& e)
     {
-        LOG(INFO) << "Exception occurred while loading equipment for character with id " << player.id() << ": " << e.what();
+        LOG(INFO) << "Exception occurred while loading character with id " << id << ": " << e.what();
     }
-    return false;
+    return std::nullopt;
 }
 
 /**
- * Saves a player character.
- * @param character The character to save.
+ * Saves a batch of player snapshots, with a single multi-row update per statement. Only the inventory and equipment
+ * slots that changed since the previous snapshot are written, so the cost of a save scales with the activity of the
+ * characters rather than the size of their containers.
+ * @param snapshots The snapshots to save.
+ * @return          If the snapshots were saved successfully.
  */
-void DatabasePlayerSerializer::save(Player& player)
+bool DatabasePlayerSerializer::save(const std::vector<PlayerSnapshot>& snapshots)
 {
+    if (snapshots.empty())
+        return true;
+
     try
     {
         // Create a new connection to the database
         auto connection = db_.connection();
+        auto start      = std::chrono::steady_clock::now();
         pqxx::work tx(*connection);
 
-        // The character's position
-        auto& pos = player.position();
-
-        // The character's stats
-        auto& stats = player.stats();
+        // Formats values as the text of a Postgres array, which is bound as a single parameter
+        auto array = [](const std::vector<std::string>& values) {
+            std::string text = "{";
+            for (size_t i = 0; i < values.size(); i++)
+            {
+                if (i != 0)
+                    text += ',';
+                text += values[i];
+            }
+            return text + "}";
+        };
+
+        // Update the characters in chunks, each of which binds its values as parallel arrays
+        for (size_t offset = 0; offset < snapshots.size(); offset += SAVE_BATCH_ROWS)
+        {
+            std::array<std::vector<std::string>, 16> columns;
+            auto end = std::min(snapshots.size(), offset + SAVE_BATCH_ROWS);
+            for (auto i = offset; i < end; i++)
+            {
+                auto& s = snapshots.at(i);
+                if (!std::isfinite(s.x) || !std::isfinite(s.y) || !std::isfinite(s.z))
+                    throw std::invalid_argument("Character " + std::to_string(s.id) + " has a non-finite position");
+
+                auto column = columns.begin();
+                for (auto&& value: { pqxx::to_string(s.id), pqxx::to_string(s.map), pqxx::to_string(s.x),
+                                     pqxx::to_string(s.y), pqxx::to_string(s.z), pqxx::to_string(s.statpoints),
+                                     pqxx::to_string(s.strength), pqxx::to_string(s.dexterity),
+                                     pqxx::to_string(s.reaction), pqxx::to_string(s.intelligence),
+                                     pqxx::to_string(s.wisdom), pqxx::to_string(s.luck), pqxx::to_string(s.hitpoints),
+                                     pqxx::to_string(s.mana), pqxx::to_string(s.stamina), pqxx::to_string(s.gold) })
+                    (column++)->push_back(value);
+            }
+
+            db_.execute(tx, SAVE_CHARACTER_DETAILS, worldId_, array(columns[0]), array(columns[1]), array(columns[2]),
+                        array(columns[3]), array(columns[4]), array(columns[5]), array(columns[6]), array(columns[7]),
+                        array(columns[8]), array(columns[9]), array(columns[10]), array(columns[11]),
+                        array(columns[12]), array(columns[13]), array(columns[14]), array(columns[15]));
+        }
 
-        // Save the details
-        tx.exec_prepared(SAVE_CHARACTER_DETAILS, worldId_, player.id(), pos.map(), pos.x(), pos.y(), pos.z(),
-                         player.statpoints(), stats.getBase(Stat::Strength), stats.getBase(Stat::Dexterity),
-                         stats.getBase(Stat::Reaction), stats.getBase(Stat::Intelligence), stats.getBase(Stat::Wisdom),
-                         stats.getBase(Stat::Luck), stats.currentHitpoints(), stats.currentMana(), stats.currentStamina());
+        // Apply the item changes of a container, with each statement binding the changed slots as parallel arrays.
+        // An item id of zero clears the slot.
+        auto saveItems = [&](const std::string& statement, auto changes) {
+            std::vector<std::string> charIds;
+            std::vector<std::string> slots;
+            std::vector<std::string> itemIds;
+            std::vector<std::string> counts;
+
+            auto flush = [&]() {
+                if (charIds.empty())
+                    return;
+                db_.execute(tx, statement, worldId_, array(charIds), array(slots), array(itemIds), array(counts));
+                charIds.clear();
+                slots.clear();
+                itemIds.clear();
+                counts.clear();
+            };
+
+            for (auto&& snapshot: snapshots)
+            {
+                for (auto&& delta: changes(snapshot))
+                {
+                    charIds.push_back(pqxx::to_string(snapshot.id));
+                    slots.push_back(pqxx::to_string(delta.slot));
+                    itemIds.push_back(pqxx::to_string(delta.itemId));
+                    counts.push_back(pqxx::to_string(delta.count));
+
+                    if (charIds.size() == SAVE_BATCH_ITEMS)
+                        flush();
+                }
+            }
+            flush();
+        };
+        saveItems(SAVE_INVENTORY_CHANGES, [](auto& s) -> auto& { return s.inventoryChanges; });
+        saveItems(SAVE_EQUIPMENT_CHANGES, [](auto& s) -> auto& { return s.equipmentChanges; });
         tx.commit();
+        db_.record(SAVE_CHARACTER_BATCH, std::chrono::steady_clock::now() - start);
+        return true;
     }
     catch (const std::exception& e)
     {
-        LOG(INFO) << "Exception occured while saving character details for id " << player.id() << ": " << e.what();
+        LOG(INFO) << "Exception occured while saving the details of " << snapshots.size() << " characters: " << e.what();
     }
-}
\ No newline at end of file
+    return false;
+}
@@ -0,0 +1,61 @@
+#include <shaiya/game/io/impl/MemoryPlayerSerializer.hpp>
+
+using namespace shaiya::game;
+
+/**
+ * Initialises this character serializer.
+ * @param itemDefs  The item definitions.
+ * @param prototype The prototype of a new character.
+ */
+MemoryPlayerSerializer::MemoryPlayerSerializer(const shaiya::client::ItemSData& itemDefs, CharacterData prototype)
+    : PlayerSerializer(itemDefs, std::move(prototype))
+{
+}
+
+/**
+ * Reads the state of a character, or creates it from the prototype if it hasn't been saved.
+ * @param id    The id of the character.
+ * @return      The character data.
+ */
+std::optional<CharacterData> MemoryPlayerSerializer::read(size_t id)
+{
+    std::lock_guard lock{ mutex_ };
+    auto pos = characters_.find(id);
+    if (pos == characters_.end())
+        return create(id);
+    return pos->second;
+}
+
+/**
+ * Saves a batch of player snapshots.
+ * @param snapshots The snapshots to save.
+ * @return          If the snapshots were saved successfully.
+ */
+bool MemoryPlayerSerializer::save(const std::vector<PlayerSnapshot>& snapshots)
+{
+    std::lock_guard lock{ mutex_ };
+    for (auto&& snapshot: snapshots)
+    {
+        auto pos = characters_.find(snapshot.id);
+        if (pos == characters_.end())
+            pos = characters_.emplace(snapshot.id, create(snapshot.id)).first;
+        pos->second.update(snapshot);
+    }
+    return true;
+}
+
+/**
+ * Adds a character that was created on the character screen, with an id that no other character has.
+ * @param entry The character list entry of the new character.
+ * @return      The id of the new character.
+ */
+std::optional<size_t> MemoryPlayerSerializer::add(const shaiya::net::CharacterListEntry& entry)
+{
+    std::lock_guard lock{ mutex_ };
+    while (characters_.contains(nextId_))
+        nextId_++;
+
+    auto id = nextId_++;
+    characters_.emplace(id, create(entry));
+    return id;
+}
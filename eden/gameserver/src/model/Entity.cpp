@@ -1,5 +1,6 @@
 #include <shaiya/game/model/Entity.hpp>
 #include <shaiya/game/model/map/Map.hpp>
+#include <shaiya/game/model/map/SpatialQuery.hpp>
 #include <shaiya/game/service/GameWorldService.hpp>
 
 #include <cmath>
@@ -151,13 +152,14 @@ void Entity::clearAttribute(Attribute attribute)
 }
 
 /**
- * Checks if this entity can be observed by another.
+ * Checks if this entity can be observed by another. The client synchronizer tests the entities that a character
+ * observes in a single batch with SpatialQuery::select instead, so this is used for one-off checks.
  * @param other The entity trying to observe this entity.
  * @return      If the other entity can observe us.
  */
 bool Entity::observable(Entity& other)
 {
-    return position_.isWithinViewportDistance(other.position());
+    return SpatialQuery::viewport(other.position()).contains(position_);
 }
 
 /**
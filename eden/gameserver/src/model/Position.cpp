@@ -1,14 +1,10 @@
 #include <shaiya/game/model/Position.hpp>
+#include <shaiya/game/model/map/SpatialQuery.hpp>
 
 #include <cmath>
 
 using namespace shaiya::game;
 
-/**
- * The viewport distance of a player.
- */
-constexpr auto VIEWPORT_DISTANCE = 90;
-
 /**
  * The interaction distance of a player.
  */
@@ -65,7 +61,7 @@ Position Position::translate(float x, float y, float z) const
 }
 
 /**
- * Checks if a position is within distance of another.
+ * Checks if a position is within distance of another, on the horizontal plane.
  * @param other     The other position.
  * @param distance  The distance.
  * @return          If the other position is in distance of this position.
@@ -73,9 +69,8 @@ Position Position::translate(float x, float y, float z) const
 bool Position::isWithinDistance(const Position& other, float distance) const
 {
     auto deltaX = x_ - other.x_;
-    auto deltaY = y_ - other.y_;
     auto deltaZ = z_ - other.z_;
-    return map_ == other.map_ && deltaX <= distance && deltaY <= distance && deltaZ <= distance;
+    return map_ == other.map_ && (deltaX * deltaX) + (deltaZ * deltaZ) <= distance * distance;
 }
 
 /**
@@ -85,7 +80,7 @@ bool Position::isWithinDistance(const Position& other, float distance) const
  */
 bool Position::isWithinViewportDistance(const Position& other) const
 {
-    return isWithinDistance(other, VIEWPORT_DISTANCE);
+    return SpatialQuery::viewport(*this).contains(other);
 }
 
 /**
@@ -20,7 +20,7 @@ using namespace shaiya::game;
  * @param id        The character id.
  */
 Player::Player(GameSession& session, size_t id)
-    : session_(session),
+    : session_(&session),
       actionBar_(*this),
       appearance_(*this),
       requestManager_(*this),
@@ -31,6 +31,7 @@ Player::Player(GameSession& session, size_t id)
 
     // Set the character id and faction
     id_      = id;
+    userId_  = session.userId();
     faction_ = session.faction();
 }
 
@@ -47,9 +48,46 @@ void Player::init()
     equipment_.addListener(std::make_shared<EquipmentEventListener>(*this));
     stats().onSync([&](const StatSet& stats, StatUpdateType type) { onStatSync(stats, type); });
 
+    // Send the character's state to the client
+    sendState();
+}
+
+/**
+ * Marks this character as active.
+ */
+void Player::activate()
+{
+    Actor::activate();
+}
+
+/**
+ * Attaches this character to a new session, after it was resumed by a reconnecting client. The entities that the
+ * previous session observed are forgotten, so the new session receives its viewport from scratch.
+ * @param session   The new session.
+ */
+void Player::attach(GameSession& session)
+{
+    session_ = &session;
+    observedEntities_.clear();
+    pendingMovement_.clear();
+}
+
+/**
+ * Detaches this character from its session, once the session has disconnected. The character must not be synchronised
+ * or sent its state until it is attached to a new session.
+ */
+void Player::detach()
+{
+    session_ = nullptr;
+}
+
+/**
+ * Sends the state of this character to its session, such as its details, items and stats.
+ */
+void Player::sendState()
+{
     // Write the current time
-    session_.write(WorldTime{});
-    inventory_.setGold(250000000);
+    session_->write(WorldTime{});
 
     // Prepare the character details
     CharacterDetails details;
@@ -74,7 +112,7 @@ void Player::init()
 
     // Write some miscellaneous data about the character.
     details.gold = inventory_.gold();
-    session_.write(details);  // Send the character details.
+    session_->write(details);  // Send the character details.
 
     // Synchronise the item containers
     equipment().sync();
@@ -84,14 +122,6 @@ void Player::init()
     onStatSync(stats_, StatUpdateType::Full);
 }
 
-/**
- * Marks this character as active.
- */
-void Player::activate()
-{
-    Actor::activate();
-}
-
 /**
  * Gets executed when the stats for this character are synchronized.
  * @param stats     The stats for this character.
@@ -104,7 +134,7 @@ void Player::onStatSync(const StatSet& stats, StatUpdateType type)
     status.hitpoints = stats.currentHitpoints();
     status.mana      = stats.currentMana();
     status.stamina   = stats.currentStamina();
-    session_.write(status);
+    session_->write(status);
 
     // If it's just a status update, we can stop here
     if (type == StatUpdateType::Status)
@@ -116,7 +146,7 @@ void Player::onStatSync(const StatSet& stats, StatUpdateType type)
         update.id    = id();
         update.type  = type;
         update.value = value;
-        session_.write(update);
+        session_->write(update);
     };
     updateMaxHealth(MaxHitpointType::Hitpoints, stats.maxHitpoints());
     updateMaxHealth(MaxHitpointType::Mana, stats.maxMana());
@@ -139,7 +169,7 @@ void Player::onStatSync(const StatSet& stats, StatUpdateType type)
     update.maxMagicAttack = stats.getTotal(Stat::MaxMagicalAttack);
     update.defense        = stats.getTotal(Stat::Defense);
     update.resistance     = stats.getTotal(Stat::Resistance);
-    session_.write(update);
+    session_->write(update);
 }
 
 /**
@@ -7,6 +7,7 @@
 #include <shaiya/game/model/actor/player/request/trade/TradeRequest.hpp>
 #include <shaiya/game/model/item/Item.hpp>
 #include <shaiya/game/model/item/container/event/TradeEventListener.hpp>
+#include <shaiya/game/service/GameWorldService.hpp>
 
 #include <utility>
 
@@ -232,6 +233,9 @@ void TradeRequest::finalise()
     auto gold = (inv.gold() - gold_) + second->gold_;
     inv.setGold(gold);
 
+    // Journal the result of the trade straight away
+    player_->world().persist(*player_);
+
     // Inform the player that the trade has ended
     player_->session().write(CharacterTradeCompleted{ .type = TradeFinaliseType::Accepted });
 
@@ -0,0 +1,45 @@
+#include <shaiya/common/net/packet/game/CharacterMapTeleport.hpp>
+#include <shaiya/game/net/GameSession.hpp>
+#include <shaiya/game/service/GameWorldService.hpp>
+#include <shaiya/game/model/actor/player/Player.hpp>
+#include <shaiya/game/model/commands/impl/GotoCommand.hpp>
+
+using namespace shaiya::game;
+using namespace shaiya::net;
+
+/**
+ * Handles the execution of this command.
+ * @param character     The character that executed this command.
+ * @param args          The command arguments
+ */
+void GotoCommand::execute(Player& character, const std::vector<std::string>& args)
+{
+    if (args.size() != 1)
+        return;
+
+    // The target must be connected, and have finished loading into the world
+    auto target = character.world().directory().forName(args.at(0));
+    if (!target || target.get() == &character || !target->active())
+        return;
+
+    auto dest = target->position();
+
+    CharacterMapTeleport teleport;
+    teleport.id  = character.id();
+    teleport.map = dest.map();
+    teleport.x   = dest.x();
+    teleport.y   = dest.y();
+    teleport.z   = dest.z();
+
+    character.session().write(teleport);
+    character.setPosition(dest);
+}
+
+/**
+ * Gets the identifier of the command.
+ * @return  The identifier.
+ */
+const std::string GotoCommand::identifier() const
+{
+    return "goto";
+}
\ No newline at end of file
@@ -27,6 +27,10 @@ void TeleportCommand::execute(Player& character, const std::vector<std::string>&
 
     Position dest(map, x, character.position().y(), z);
 
+    // The map may be owned by another zone
+    if (character.world().handoff(character, dest))
+        return;
+
     CharacterMapTeleport teleport;
     teleport.id  = character.id();
     teleport.map = dest.map();
@@ -58,6 +58,7 @@ bool ItemContainer::add(std::shared_ptr<Item> item)
             {
                 dest->setQuantity(dest->quantity() + quantity);
                 item->setQuantity(item->quantity() - quantity);
+                record(ItemChangeType::QuantityChanged, i);
 
                 for (auto&& listener: listeners_)
                     listener->itemAdded(*this, dest, i);
@@ -83,6 +84,7 @@ bool ItemContainer::add(std::shared_ptr<Item> item, size_t slot)
     if (dest)
         return false;
     dest = std::move(item);
+    record(ItemChangeType::Added, slot);
     for (auto&& listener: listeners_)
         listener->itemAdded(*this, dest, slot);
     return true;
@@ -145,6 +147,7 @@ std::shared_ptr<Item> ItemContainer::remove(size_t slot, size_t quantity)
     if (quantity >= item->quantity())
     {
         items_.at(slot) = nullptr;
+        record(ItemChangeType::Removed, slot);
 
         for (auto&& listener: listeners_)
             listener->itemRemoved(*this, nullptr, slot);
@@ -155,12 +158,14 @@ std::shared_ptr<Item> ItemContainer::remove(size_t slot, size_t quantity)
 
         if (item->quantity() >= 0)
         {
+            record(ItemChangeType::QuantityChanged, slot);
             for (auto&& listener: listeners_)
                 listener->itemRemoved(*this, item, slot);
         }
         else
         {
             items_.at(slot) = nullptr;
+            record(ItemChangeType::Removed, slot);
             for (auto&& listener: listeners_)
                 listener->itemRemoved(*this, nullptr, slot);
         }
@@ -248,6 +253,8 @@ ItemPair ItemContainer::transferTo(ItemContainer& dest, size_t sourceSlot, size_
 
             destItem->setQuantity(destItem->quantity() + quantity);
             sourceItem->setQuantity(sourceItem->quantity() - quantity);
+            record(ItemChangeType::QuantityChanged, sourceSlot);
+            dest.record(ItemChangeType::QuantityChanged, destSlot);
             return ok();
         }
 
@@ -258,6 +265,8 @@ ItemPair ItemContainer::transferTo(ItemContainer& dest, size_t sourceSlot, size_
         // Swap the items
         items_.at(sourceSlot)    = destItem;
         dest.items_.at(destSlot) = sourceItem;
+        record(ItemChangeType::Moved, sourceSlot);
+        dest.record(ItemChangeType::Moved, destSlot);
         return ok();
     }
 
@@ -273,12 +282,16 @@ ItemPair ItemContainer::transferTo(ItemContainer& dest, size_t sourceSlot, size_
 
         // Move the new item into the destination
         dest.items_.at(destSlot) = destItem;
+        record(ItemChangeType::QuantityChanged, sourceSlot);
+        dest.record(ItemChangeType::Added, destSlot);
         return ok();
     }
 
     // Swap the two items
     items_.at(sourceSlot)    = destItem;
     dest.items_.at(destSlot) = sourceItem;
+    record(ItemChangeType::Moved, sourceSlot);
+    dest.record(ItemChangeType::Moved, destSlot);
     return ok();
 }
 
@@ -311,6 +324,51 @@ void ItemContainer::sync()
         listener->sync(*this);
 }
 
+/**
+ * Compacts the change journal into the current state of each slot that was changed, and clears the journal.
+ * @return  The state of the changed slots, in the order they were first changed.
+ */
+std::vector<ItemDelta> ItemContainer::takeChanges()
+{
+    std::vector<ItemDelta> deltas;
+    std::vector<bool> seen(items_.size());
+
+    // A slot may have changed many times, but only its latest state needs to be persisted
+    for (auto&& change: changes_)
+    {
+        if (change.slot >= items_.size() || seen.at(change.slot))
+            continue;
+        seen.at(change.slot) = true;
+
+        auto& item = items_.at(change.slot);
+        if (item)
+            deltas.push_back({ change.slot, item->itemId(), item->quantity() });
+        else
+            deltas.push_back({ change.slot, 0, 0 });
+    }
+
+    changes_.clear();
+    return deltas;
+}
+
+/**
+ * Clears the change journal, such as after the container has been populated from storage.
+ */
+void ItemContainer::clearChanges()
+{
+    changes_.clear();
+}
+
+/**
+ * Records a change to a slot in the change journal.
+ * @param type  The type of change.
+ * @param slot  The slot.
+ */
+void ItemContainer::record(ItemChangeType type, size_t slot)
+{
+    changes_.push_back({ type, slot });
+}
+
 /**
  * Sets the items of this container.
  * @param items The items.
@@ -320,5 +378,6 @@ void ItemContainer::setItems(const std::vector<std::shared_ptr<Item>>& items)
     for (auto i = 0; i < items_.size(); i++)
     {
         items_[i] = items.at(i);
+        record(ItemChangeType::Added, i);
     }
 }
\ No newline at end of file
@@ -3,25 +3,30 @@
 #include <shaiya/game/model/actor/player/Player.hpp>
 #include <shaiya/game/model/map/Map.hpp>
 #include <shaiya/game/model/map/MapCell.hpp>
+#include <shaiya/game/model/map/SpatialQuery.hpp>
+#include <shaiya/game/model/map/index/GridSpatialIndex.hpp>
+#include <shaiya/game/model/map/index/SparseSpatialIndex.hpp>
 #include <shaiya/game/service/GameWorldService.hpp>
 
-#include <cassert>
-#include <cfenv>
-#include <cmath>
+#include <glog/logging.h>
+
+#include <algorithm>
 #include <iostream>
 #include <yaml-cpp/yaml.h>
 
 using namespace shaiya::game;
 
 /**
- * The size of a cell (16x16).
+ * The default width of a tile (512 units, or 32 cells), used when a map doesn't specify how many tiles it should be split
+ * into.
  */
-constexpr auto CELL_SIZE = 16;
+constexpr auto TILE_SIZE = 512;
 
 /**
- * The observable radius from a center cell.
+ * The minimum number of cell columns in a tile. A tile must be wider than the observable area of a cell, so that the halo
+ * of a tile (the cells of neighbouring tiles that its entities can observe) never reaches past the adjacent tiles.
  */
-constexpr auto OBSERVABLE_CELL_RADIUS = 3;
+constexpr auto MIN_TILE_COLUMNS = (SpatialIndex::OBSERVABLE_CELL_RADIUS * 2) + 1;
 
 /**
  * Initialises this map.
@@ -43,18 +48,23 @@ void Map::load(std::ifstream& stream)
     id_   = yaml["id"].as<uint16_t>();
     size_ = yaml["size"].as<size_t>();
 
-    // Calculate the cell rows and columns
-    // Cells always fit perfectly into a map, and map sizes are only ever 1024x1024 or 2048x2048.
-    rowCount_    = size_ / CELL_SIZE;
-    columnCount_ = rowCount_;
-
-    // The total number of cells
-    auto totalCells = rowCount_ * columnCount_;
-    cells_.resize(totalCells);
+    // Create the spatial index. Open fields use a dense grid, while dungeons and other sparsely populated maps may use a
+    // sparse index that only allocates the cells that are occupied.
+    auto index = yaml["index"].as<std::string>("grid");
+    if (index == "sparse")
+        index_ = std::make_unique<SparseSpatialIndex>(size_);
+    else
+    {
+        if (index != "grid")
+            LOG(WARNING) << "Unknown spatial index \"" << index << "\" for map " << id_ << ", using a grid instead.";
+        index_ = std::make_unique<GridSpatialIndex>(size_);
+    }
 
-    // Generate the cells
-    for (auto i = 0; i < totalCells; i++)
-        cells_.at(i) = std::make_shared<MapCell>();
+    // Split the cell columns into stripes. The tile count may be explicitly set for large maps with dense populations.
+    auto tiles   = yaml["tiles"].as<size_t>(std::max<size_t>(1, size_ / TILE_SIZE));
+    auto columns = index_->columnCount();
+    tileColumns_ = std::max<size_t>(MIN_TILE_COLUMNS, (columns + tiles - 1) / std::max<size_t>(1, tiles));
+    tileCount_   = (columns + tileColumns_ - 1) / tileColumns_;
 }
 
 /**
@@ -155,11 +165,7 @@ void Map::add(std::shared_ptr<Entity> entity) const
 {
     // Adjust the position where needed
     adjustPosition(entity->position());
-
-    // Get the cell to place this entity into.
-    auto cell = getCell(entity->position());
-    assert(cell);
-    cell->addEntity(entity);
+    index_->add(entity, entity->position());
 }
 
 /**
@@ -170,11 +176,7 @@ void Map::remove(std::shared_ptr<Entity> entity) const
 {
     // Adjust the position where needed
     adjustPosition(entity->position());
-
-    // Get the cell to remove this entity from
-    auto cell = getCell(entity->position());
-    assert(cell);
-    cell->removeEntity(entity);
+    index_->remove(entity, entity->position());
 }
 
 /**
@@ -201,78 +203,42 @@ std::shared_ptr<Entity> Map::get(Position& pos, size_t id, EntityType type) cons
 }
 
 /**
- * Get a cell in the map based on a position.
+ * Gets the cells in a neighbouring radius of a position.
  * @param position  The position.
- * @return          The map cell.
+ * @return          The neighbouring cells.
  */
-std::shared_ptr<MapCell> Map::getCell(Position& position) const
+std::vector<std::shared_ptr<MapCell>> Map::getNeighbouringCells(Position& position) const
 {
     // Adjust the position where needed
     adjustPosition(position);
-    return cells_.at(getCellIndex(position));
+    return index_->neighbours(position);
 }
 
 /**
- * Get a cell index  based on a position.
- * @param position  The position.
- * @return          The map cell.
+ * Gets the entities inside a spatial query, such as the targets of an area of effect skill.
+ * @param query The spatial query.
+ * @return      The entities inside the query.
  */
-size_t Map::getCellIndex(Position& position) const
+std::vector<std::shared_ptr<Entity>> Map::query(const SpatialQuery& query) const
 {
-    // Adjust the position where needed
-    adjustPosition(position);
+    std::vector<std::shared_ptr<Entity>> entities;
+    if (query.map() != id_)
+        return entities;
 
-    // Set the rounding mode
-    std::fesetround(FE_TOWARDZERO);
-
-    // The x and z coordinates
-    auto x = std::min(static_cast<size_t>(std::nearbyint(position.x())), size_);
-    auto z = std::min(static_cast<size_t>(std::nearbyint(position.z())), size_);
-
-    // The row and column
-    auto row    = x / CELL_SIZE;
-    auto column = z / CELL_SIZE;
-    return row + (column * rowCount_);
+    for (auto&& cell: index_->cellsWithin(query.min(), query.max()))
+        cell->query(query, entities);
+    return entities;
 }
 
 /**
- * Gets the cells in a neighbouring radius of a position.
+ * Gets the index of the tile that owns a position. A tile is a stripe of cell columns that may be simulated in
+ * parallel with the other tiles of this map.
  * @param position  The position.
- * @return          The neighbouring cells.
+ * @return          The tile index.
  */
-std::vector<std::shared_ptr<MapCell>> Map::getNeighbouringCells(Position& position) const
+size_t Map::tileIndex(Position& position) const
 {
-    // Adjust the position where needed
-    adjustPosition(position);
-
-    // The vector of cells
-    std::vector<std::shared_ptr<MapCell>> cells;
-
-    // The x and z coordinates.
-    auto x = std::min(static_cast<size_t>(std::nearbyint(position.x())), size_);
-    auto z = std::min(static_cast<size_t>(std::nearbyint(position.z())), size_);
-
-    // The position's row and column
-    auto centerRow    = x / CELL_SIZE;
-    auto centerColumn = z / CELL_SIZE;
-
-    // The maximum row and column
-    auto maxRow    = centerRow + OBSERVABLE_CELL_RADIUS;
-    auto maxColumn = centerColumn + OBSERVABLE_CELL_RADIUS;
-
-    // Loop through the cell rows and columns
-    for (auto row = centerRow - OBSERVABLE_CELL_RADIUS; row < maxRow; row++)
-    {
-        for (auto column = centerColumn - OBSERVABLE_CELL_RADIUS; column < maxColumn; column++)
-        {
-            auto id = row + (column * rowCount_);
-            if (id >= 0 && id < cells_.size())
-            {
-                cells.push_back(cells_.at(id));
-            }
-        }
-    }
-    return cells;
+    return std::min(index_->column(position) / tileColumns_, tileCount_ - 1);
 }
 
 /**
@@ -1,15 +1,26 @@
 #include <shaiya/game/model/Entity.hpp>
 #include <shaiya/game/model/map/MapCell.hpp>
+#include <shaiya/game/model/map/SpatialQuery.hpp>
+
+#include <algorithm>
 
 using namespace shaiya::game;
 
+/**
+ * The size of the control block of a shared allocation (the use and weak counts, and the vtable).
+ */
+constexpr auto CONTROL_BLOCK_SIZE = sizeof(long) * 2 + sizeof(void*);
+
 /**
  * Adds an entity to this cell.
  * @param entity    The entity to add.
+ * @param position  The position of the entity.
  */
-void MapCell::addEntity(std::shared_ptr<Entity> entity)
+void MapCell::addEntity(std::shared_ptr<Entity> entity, const Position& position)
 {
-    entities_.push_back(entity);
+    entities_.push_back(std::move(entity));
+    xs_.push_back(position.x());
+    zs_.push_back(position.z());
 }
 
 /**
@@ -24,6 +35,36 @@ void MapCell::removeEntity(const std::shared_ptr<Entity>& entity)
     auto pos = std::find_if(entities_.begin(), entities_.end(), pred);
     if (pos != entities_.end())
     {
+        auto index = std::distance(entities_.begin(), pos);
         entities_.erase(pos);
+        xs_.erase(xs_.begin() + index);
+        zs_.erase(zs_.begin() + index);
     }
+}
+
+/**
+ * Appends the entities of this cell that are inside a query.
+ * @param query The spatial query.
+ * @param out   The vector to append the entities to.
+ */
+void MapCell::query(const SpatialQuery& query, std::vector<std::shared_ptr<Entity>>& out) const
+{
+    // The indices of the selected entities, reused between queries on the same thread
+    static thread_local std::vector<uint32_t> selected;
+    selected.resize(entities_.size());
+
+    auto count = query.select(xs_.data(), zs_.data(), entities_.size(), selected.data());
+    for (size_t i = 0; i < count; i++)
+        out.push_back(entities_[selected[i]]);
+}
+
+/**
+ * Gets an estimate of the heap memory used by this cell, including its shared allocation.
+ * @return  The memory usage, in bytes.
+ */
+size_t MapCell::memoryUsage() const
+{
+    auto entities    = entities_.capacity() * sizeof(std::shared_ptr<Entity>);
+    auto coordinates = (xs_.capacity() + zs_.capacity()) * sizeof(float);
+    return CONTROL_BLOCK_SIZE + sizeof(MapCell) + entities + coordinates;
 }
\ No newline at end of file
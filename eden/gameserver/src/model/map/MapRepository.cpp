@@ -12,10 +12,11 @@ using namespace shaiya::game;
 
 /**
  * Loads the map repository.
- * @param mapPath  The path to the world's map files.
+ * @param mapPath   The path to the world's map files.
  * @param world     The game world service.
+ * @param filter    The filter that decides which maps are loaded, by their id.
  */
-void MapRepository::load(const std::string& mapPath, GameWorldService& world)
+void MapRepository::load(const std::string& mapPath, GameWorldService& world, const std::function<bool(uint16_t)>& filter)
 {
     using namespace boost::filesystem;
     path p(mapPath);  // The path to the map files
@@ -40,6 +41,10 @@ void MapRepository::load(const std::string& mapPath, GameWorldService& world)
         auto map = std::make_shared<Map>(world);
         map->load(metastream);
 
+        // Skip the maps that are owned by another zone
+        if (!filter(map->id()))
+            continue;
+
         // Store the map
         maps_[map->id()] = map;
 
@@ -0,0 +1,202 @@
+#include <shaiya/game/model/map/SpatialQuery.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <numbers>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace shaiya::game;
+
+/**
+ * The viewport distance of a player.
+ */
+constexpr auto VIEWPORT_DISTANCE = 90.0f;
+
+/**
+ * Creates a query for the entities within a radius of a position.
+ * @param center    The center of the circle.
+ * @param radius    The radius.
+ * @return          The query.
+ */
+SpatialQuery SpatialQuery::circle(const Position& center, float radius)
+{
+    SpatialQuery query;
+    query.shape_         = Shape::Circle;
+    query.map_           = center.map();
+    query.x_             = center.x();
+    query.z_             = center.z();
+    query.radiusSquared_ = radius * radius;
+    query.minX_          = center.x() - radius;
+    query.minZ_          = center.z() - radius;
+    query.maxX_          = center.x() + radius;
+    query.maxZ_          = center.z() + radius;
+    return query;
+}
+
+/**
+ * Creates a query for the entities within an axis-aligned rectangle.
+ * @param bottomLeft    The bottom-left corner.
+ * @param topRight      The top-right corner.
+ * @return              The query.
+ */
+SpatialQuery SpatialQuery::rectangle(const Position& bottomLeft, const Position& topRight)
+{
+    SpatialQuery query;
+    query.shape_ = Shape::Rectangle;
+    query.map_   = bottomLeft.map();
+    query.minX_  = std::min(bottomLeft.x(), topRight.x());
+    query.minZ_  = std::min(bottomLeft.z(), topRight.z());
+    query.maxX_  = std::max(bottomLeft.x(), topRight.x());
+    query.maxZ_  = std::max(bottomLeft.z(), topRight.z());
+    query.x_     = (query.minX_ + query.maxX_) / 2;
+    query.z_     = (query.minZ_ + query.maxZ_) / 2;
+    return query;
+}
+
+/**
+ * Creates a query for the entities within a cone.
+ * @param origin    The origin of the cone.
+ * @param towards   A position that the cone is facing.
+ * @param radius    The length of the cone.
+ * @param angle     The full angle of the cone, in degrees.
+ * @return          The query.
+ */
+SpatialQuery SpatialQuery::cone(const Position& origin, const Position& towards, float radius, float angle)
+{
+    auto query   = circle(origin, radius);
+    query.shape_ = Shape::Cone;
+
+    // The direction of the cone. If the cone isn't facing anywhere, it covers the full circle.
+    auto deltaX = towards.x() - origin.x();
+    auto deltaZ = towards.z() - origin.z();
+    auto length = std::sqrt((deltaX * deltaX) + (deltaZ * deltaZ));
+    if (length == 0)
+    {
+        query.cosine_ = -1;
+        return query;
+    }
+
+    auto halfAngle    = std::clamp(angle, 0.0f, 360.0f) / 2;
+    query.directionX_ = deltaX / length;
+    query.directionZ_ = deltaZ / length;
+    query.cosine_     = std::cos(halfAngle * std::numbers::pi_v<float> / 180);
+    return query;
+}
+
+/**
+ * Creates a query for the entities within the viewport of a position.
+ * @param center    The position of the observer.
+ * @return          The query.
+ */
+SpatialQuery SpatialQuery::viewport(const Position& center)
+{
+    return circle(center, VIEWPORT_DISTANCE);
+}
+
+/**
+ * Checks if a position is inside this query.
+ * @param position  The position.
+ * @return          If the position is inside the query.
+ */
+bool SpatialQuery::contains(const Position& position) const
+{
+    return position.map() == map_ && contains(position.x(), position.z());
+}
+
+/**
+ * Checks if a set of coordinates is inside this query. The map is not checked.
+ * @param x The x coordinate.
+ * @param z The z coordinate.
+ * @return  If the coordinates are inside the query.
+ */
+bool SpatialQuery::contains(float x, float z) const
+{
+    if (shape_ == Shape::Rectangle)
+        return x >= minX_ && x <= maxX_ && z >= minZ_ && z <= maxZ_;
+
+    auto deltaX   = x - x_;
+    auto deltaZ   = z - z_;
+    auto distance = (deltaX * deltaX) + (deltaZ * deltaZ);
+    if (distance > radiusSquared_)
+        return false;
+    if (shape_ == Shape::Circle)
+        return true;
+
+    // The point is inside the cone if the angle between it and the direction of the cone is within the half angle.
+    auto dot = (deltaX * directionX_) + (deltaZ * directionZ_);
+    return dot >= cosine_ * std::sqrt(distance);
+}
+
+/**
+ * Selects the coordinates that are inside this query, from a structure-of-arrays set of coordinates. Four coordinates are
+ * tested at a time where SSE2 is available, and the remainder are tested individually.
+ * @param xs    The x coordinates.
+ * @param zs    The z coordinates.
+ * @param count The number of coordinates.
+ * @param out   The output indices, which must have room for at least count elements.
+ * @return      The number of selected indices.
+ */
+size_t SpatialQuery::select(const float* xs, const float* zs, size_t count, uint32_t* out) const
+{
+    size_t selected = 0;
+    size_t i        = 0;
+
+#ifdef __SSE2__
+    auto centerX = _mm_set1_ps(x_);
+    auto centerZ = _mm_set1_ps(z_);
+    auto radius  = _mm_set1_ps(radiusSquared_);
+    auto dirX    = _mm_set1_ps(directionX_);
+    auto dirZ    = _mm_set1_ps(directionZ_);
+    auto cosine  = _mm_set1_ps(cosine_);
+    auto minX    = _mm_set1_ps(minX_);
+    auto minZ    = _mm_set1_ps(minZ_);
+    auto maxX    = _mm_set1_ps(maxX_);
+    auto maxZ    = _mm_set1_ps(maxZ_);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        auto x = _mm_loadu_ps(xs + i);
+        auto z = _mm_loadu_ps(zs + i);
+
+        __m128 mask;
+        if (shape_ == Shape::Rectangle)
+        {
+            auto insideX = _mm_and_ps(_mm_cmpge_ps(x, minX), _mm_cmple_ps(x, maxX));
+            auto insideZ = _mm_and_ps(_mm_cmpge_ps(z, minZ), _mm_cmple_ps(z, maxZ));
+            mask         = _mm_and_ps(insideX, insideZ);
+        }
+        else
+        {
+            auto deltaX   = _mm_sub_ps(x, centerX);
+            auto deltaZ   = _mm_sub_ps(z, centerZ);
+            auto distance = _mm_add_ps(_mm_mul_ps(deltaX, deltaX), _mm_mul_ps(deltaZ, deltaZ));
+            mask          = _mm_cmple_ps(distance, radius);
+
+            if (shape_ == Shape::Cone)
+            {
+                auto dot = _mm_add_ps(_mm_mul_ps(deltaX, dirX), _mm_mul_ps(deltaZ, dirZ));
+                mask     = _mm_and_ps(mask, _mm_cmpge_ps(dot, _mm_mul_ps(cosine, _mm_sqrt_ps(distance))));
+            }
+        }
+
+        // Write the index of each selected lane
+        auto lanes = static_cast<uint32_t>(_mm_movemask_ps(mask));
+        while (lanes)
+        {
+            out[selected++] = static_cast<uint32_t>(i + std::countr_zero(lanes));
+            lanes &= lanes - 1;
+        }
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        if (contains(xs[i], zs[i]))
+            out[selected++] = static_cast<uint32_t>(i);
+    }
+    return selected;
+}
@@ -0,0 +1,63 @@
+#include <shaiya/game/model/map/MapCell.hpp>
+#include <shaiya/game/model/map/index/GridSpatialIndex.hpp>
+
+using namespace shaiya::game;
+
+/**
+ * Initialises this index, and allocates the cells.
+ * @param size  The size of the map.
+ */
+GridSpatialIndex::GridSpatialIndex(size_t size): SpatialIndex(size)
+{
+    cells_.resize(rowCount_ * columnCount_);
+    for (auto& cell: cells_)
+        cell = std::make_shared<MapCell>();
+}
+
+/**
+ * Adds an entity to the cell containing a position.
+ * @param entity    The entity to add.
+ * @param position  The position of the entity.
+ */
+void GridSpatialIndex::add(const std::shared_ptr<Entity>& entity, const Position& position)
+{
+    cells_.at(cellKey(row(position), column(position)))->addEntity(entity, position);
+}
+
+/**
+ * Removes an entity from the cell containing a position.
+ * @param entity    The entity to remove.
+ * @param position  The position of the entity.
+ */
+void GridSpatialIndex::remove(const std::shared_ptr<Entity>& entity, const Position& position)
+{
+    cells_.at(cellKey(row(position), column(position)))->removeEntity(entity);
+}
+
+/**
+ * Gets the cells within a set of bounds.
+ * @param bounds    The cell bounds.
+ * @return          The cells.
+ */
+std::vector<std::shared_ptr<MapCell>> GridSpatialIndex::cells(const CellBounds& bounds) const
+{
+    std::vector<std::shared_ptr<MapCell>> found;
+    found.reserve((bounds.maxRow - bounds.minRow + 1) * (bounds.maxColumn - bounds.minColumn + 1));
+
+    for (auto row = bounds.minRow; row <= bounds.maxRow; row++)
+        for (auto column = bounds.minColumn; column <= bounds.maxColumn; column++)
+            found.push_back(cells_.at(cellKey(row, column)));
+    return found;
+}
+
+/**
+ * Gets an estimate of the heap memory used by this index, including its cells.
+ * @return  The memory usage, in bytes.
+ */
+size_t GridSpatialIndex::memoryUsage() const
+{
+    auto usage = cells_.capacity() * sizeof(std::shared_ptr<MapCell>);
+    for (auto&& cell: cells_)
+        usage += cell->memoryUsage();
+    return usage;
+}
@@ -0,0 +1,95 @@
+#include <shaiya/game/model/map/MapCell.hpp>
+#include <shaiya/game/model/map/index/SparseSpatialIndex.hpp>
+
+#include <mutex>
+
+using namespace shaiya::game;
+
+/**
+ * The size of a node in the cell table, excluding the cell itself.
+ */
+constexpr auto NODE_SIZE = sizeof(std::pair<const size_t, std::shared_ptr<MapCell>>) + sizeof(void*);
+
+/**
+ * Initialises this index.
+ * @param size  The size of the map.
+ */
+SparseSpatialIndex::SparseSpatialIndex(size_t size): SpatialIndex(size)
+{
+}
+
+/**
+ * Adds an entity to the cell containing a position, allocating the cell if needed.
+ * @param entity    The entity to add.
+ * @param position  The position of the entity.
+ */
+void SparseSpatialIndex::add(const std::shared_ptr<Entity>& entity, const Position& position)
+{
+    std::unique_lock lock(mutex_);
+    auto& cell = cells_[cellKey(row(position), column(position))];
+    if (!cell)
+        cell = std::make_shared<MapCell>();
+    cell->addEntity(entity, position);
+}
+
+/**
+ * Removes an entity from the cell containing a position, releasing the cell if it is now empty.
+ * @param entity    The entity to remove.
+ * @param position  The position of the entity.
+ */
+void SparseSpatialIndex::remove(const std::shared_ptr<Entity>& entity, const Position& position)
+{
+    std::unique_lock lock(mutex_);
+    auto itr = cells_.find(cellKey(row(position), column(position)));
+    if (itr == cells_.end())
+        return;
+
+    auto& cell = itr->second;
+    cell->removeEntity(entity);
+    if (cell->empty())
+        cells_.erase(itr);
+}
+
+/**
+ * Gets the occupied cells within a set of bounds.
+ * @param bounds    The cell bounds.
+ * @return          The cells.
+ */
+std::vector<std::shared_ptr<MapCell>> SparseSpatialIndex::cells(const CellBounds& bounds) const
+{
+    std::vector<std::shared_ptr<MapCell>> found;
+    std::shared_lock lock(mutex_);
+    for (auto row = bounds.minRow; row <= bounds.maxRow; row++)
+    {
+        for (auto column = bounds.minColumn; column <= bounds.maxColumn; column++)
+        {
+            auto itr = cells_.find(cellKey(row, column));
+            if (itr != cells_.end())
+                found.push_back(itr->second);
+        }
+    }
+    return found;
+}
+
+/**
+ * Gets the number of cells that are currently allocated by this index.
+ * @return  The cell count.
+ */
+size_t SparseSpatialIndex::cellCount() const
+{
+    std::shared_lock lock(mutex_);
+    return cells_.size();
+}
+
+/**
+ * Gets an estimate of the heap memory used by this index, including its cells.
+ * @return  The memory usage, in bytes.
+ */
+size_t SparseSpatialIndex::memoryUsage() const
+{
+    std::shared_lock lock(mutex_);
+    auto usage = (cells_.bucket_count() * sizeof(void*)) + (cells_.size() * NODE_SIZE);
+    for (auto&& [key, cell]: cells_)
+        usage += cell->memoryUsage();
+    return usage;
+}
@@ -0,0 +1,84 @@
+#include <shaiya/game/model/Position.hpp>
+#include <shaiya/game/model/map/index/SpatialIndex.hpp>
+
+#include <algorithm>
+
+using namespace shaiya::game;
+
+/**
+ * Initialises this index.
+ * @param size  The size of the map.
+ */
+SpatialIndex::SpatialIndex(size_t size): size_(size)
+{
+    // Cells always fit perfectly into a map, and map sizes are only ever 1024x1024 or 2048x2048.
+    rowCount_    = std::max<size_t>(1, size_ / CELL_SIZE);
+    columnCount_ = rowCount_;
+}
+
+/**
+ * Gets the row of the cell containing a position.
+ * @param position  The position.
+ * @return          The row.
+ */
+size_t SpatialIndex::row(const Position& position) const
+{
+    auto x = std::clamp(position.x(), 0.0f, static_cast<float>(size_ - 1));
+    return std::min(static_cast<size_t>(x) / CELL_SIZE, rowCount_ - 1);
+}
+
+/**
+ * Gets the column of the cell containing a position.
+ * @param position  The position.
+ * @return          The column.
+ */
+size_t SpatialIndex::column(const Position& position) const
+{
+    auto z = std::clamp(position.z(), 0.0f, static_cast<float>(size_ - 1));
+    return std::min(static_cast<size_t>(z) / CELL_SIZE, columnCount_ - 1);
+}
+
+/**
+ * Gets the bounds of the cells within the observable radius of a position, clamped to the edges of the map.
+ * @param position  The position.
+ * @return          The cell bounds.
+ */
+SpatialIndex::CellBounds SpatialIndex::observableBounds(const Position& position) const
+{
+    auto centerRow    = row(position);
+    auto centerColumn = column(position);
+
+    CellBounds bounds;
+    bounds.minRow    = centerRow - std::min(centerRow, OBSERVABLE_CELL_RADIUS);
+    bounds.maxRow    = std::min(centerRow + OBSERVABLE_CELL_RADIUS, rowCount_ - 1);
+    bounds.minColumn = centerColumn - std::min(centerColumn, OBSERVABLE_CELL_RADIUS);
+    bounds.maxColumn = std::min(centerColumn + OBSERVABLE_CELL_RADIUS, columnCount_ - 1);
+    return bounds;
+}
+
+
+/**
+ * Gets the cells in a neighbouring radius of a position. Cells that don't exist are skipped.
+ * @param position  The position.
+ * @return          The neighbouring cells.
+ */
+std::vector<std::shared_ptr<MapCell>> SpatialIndex::neighbours(const Position& position) const
+{
+    return cells(observableBounds(position));
+}
+
+/**
+ * Gets the cells that overlap a rectangular area. Cells that don't exist are skipped.
+ * @param bottomLeft    The bottom-left corner of the area.
+ * @param topRight      The top-right corner of the area.
+ * @return              The overlapping cells.
+ */
+std::vector<std::shared_ptr<MapCell>> SpatialIndex::cellsWithin(const Position& bottomLeft, const Position& topRight) const
+{
+    CellBounds bounds;
+    bounds.minRow    = row(bottomLeft);
+    bounds.maxRow    = row(topRight);
+    bounds.minColumn = column(bottomLeft);
+    bounds.maxColumn = column(topRight);
+    return cells(bounds);
+}
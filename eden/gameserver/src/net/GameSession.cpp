@@ -2,6 +2,7 @@
 #include <shaiya/game/net/GameSession.hpp>
 #include <shaiya/game/service/GameWorldService.hpp>
 #include <shaiya/game/service/ServiceContext.hpp>
+#include <shaiya/game/service/WorldApiService.hpp>
 
 #include <crypto++/sha.h>
 
@@ -81,6 +82,15 @@ void GameSession::setFaction(ShaiyaFaction faction)
     faction_ = faction;
 }
 
+/**
+ * Sets the session transfer that this session was accepted with.
+ * @param transfer  The session transfer.
+ */
+void GameSession::setTransfer(std::shared_ptr<const gameapi::SessionTransferRequest> transfer)
+{
+    transfer_ = std::move(transfer);
+}
+
 /**
  * Sets the character instance for this session.
  * @param player The character.
@@ -95,8 +105,15 @@ void GameSession::setPlayer(std::shared_ptr<shaiya::game::Player> player)
  */
 void GameSession::onDisconnect()
 {
+    // Allow the account to be transferred to this world again
+    if (userId_)
+        context().getApiService().releaseTransfer(userId_);
+
     if (player_)
     {
+        LOG(INFO) << "Session for user " << userId_ << " disconnected after " << bytesWritten_ << " bytes, with "
+                  << deferredUpdates_ << " deferred and " << droppedUpdates_ << " dropped movement updates.";
+
         auto& world = context().getGameWorld();
         world.unregisterPlayer(player_);
     }
@@ -106,14 +123,17 @@ void GameSession::onDisconnect()
 
 /**
  * Processes the queue of packets that are yet to be processed.
+ * @param limit The maximum number of packets to process, or 0 to process every queued packet. Packets beyond the
+ *              limit remain queued for the next tick.
  */
-void GameSession::processQueue()
+void GameSession::processQueue(size_t limit)
 {
     // Lock the mutex
     std::lock_guard lock{ mutex_ };
 
     // Loop over the queued packets
-    while (!queuedPackets_.empty())
+    size_t processed = 0;
+    while (!queuedPackets_.empty() && (limit == 0 || processed++ < limit))
     {
         auto packet = queuedPackets_.front();
         queuedPackets_.pop_front();
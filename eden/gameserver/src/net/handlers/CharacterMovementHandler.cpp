@@ -4,6 +4,9 @@
 #include <shaiya/game/service/GameWorldService.hpp>
 #include <shaiya/game/service/ServiceContext.hpp>
 #include <shaiya/game/model/actor/player/Player.hpp>
+#include <shaiya/game/model/map/Map.hpp>
+
+#include <cmath>
 
 using namespace shaiya;
 using namespace shaiya::net;
@@ -20,13 +23,18 @@ void handleCharacterMovement(Session& session, const CharacterMovement& movement
     auto& world = game.context().getGameWorld();
     auto player = game.player();
 
+    // Ignore a position that isn't a finite point on the character's map
+    auto map    = player->map();
+    auto within = [&](float value) { return std::isfinite(value) && value >= 0 && value <= map->size(); };
+    if (!map || !within(movement.x) || !std::isfinite(movement.y) || !within(movement.z))
+        return;
+
     // Update the motion and direction
     player->setDirection(movement.direction);
     player->setMotion(movement.motion);
 
     // Update the character's position
-    auto map = player->position().map();
-    player->setPosition(Position(map, movement.x, movement.y, movement.z));
+    player->setPosition(Position(map->id(), movement.x, movement.y, movement.z));
 }
 
 /**
@@ -25,6 +25,10 @@ void handleCharacterSelect(Session& session, const CharacterSelectionRequest& re
     response.charId  = request.charId;
     game.write(response);
 
+    // Resume the character if it was parked when this account disconnected
+    if (world.resume(game, request.charId))
+        return;
+
     // The character instance
     auto player = std::make_shared<Player>(game, request.charId);
     game.setPlayer(player);
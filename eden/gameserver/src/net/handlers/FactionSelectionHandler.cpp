@@ -11,14 +11,14 @@ using namespace shaiya::net;
  * @param session   The session instance.
  * @param request   The inbound faction selection request.
  */
-void handleFactionSelect(Session& session, const AccountFactionSelectRequest& request)
+boost::asio::awaitable<void> handleFactionSelect(Session& session, const AccountFactionSelectRequest& request)
 {
     auto& game       = dynamic_cast<GameSession&>(session);
     auto& charScreen = game.context().getCharScreen();
 
-    if (!charScreen.setFaction(game, request.faction))
-        return game.close();
-    charScreen.display(game);
+    if (!co_await charScreen.setFaction(game, request.faction))
+        co_return game.close();
+    co_await charScreen.display(game);
 }
 
 /**
@@ -27,5 +27,5 @@ void handleFactionSelect(Session& session, const AccountFactionSelectRequest& re
 template<>
 void PacketRegistry::registerPacketHandler<AccountFactionOpcode>()
 {
-    registerHandler<AccountFactionOpcode, AccountFactionSelectRequest>(&handleFactionSelect, ExecutionType::Asynchronous);
+    registerCoroutineHandler<AccountFactionOpcode, AccountFactionSelectRequest>(&handleFactionSelect);
 }
\ No newline at end of file
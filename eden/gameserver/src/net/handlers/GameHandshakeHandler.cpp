@@ -1,3 +1,4 @@
+#include <shaiya/common/crypto/SecureRandom.hpp>
 #include <shaiya/common/net/packet/PacketRegistry.hpp>
 #include <shaiya/common/net/packet/game/GameHandshake.hpp>
 #include <shaiya/game/net/GameSession.hpp>
@@ -5,8 +6,6 @@
 #include <shaiya/game/service/ServiceContext.hpp>
 #include <shaiya/game/service/WorldApiService.hpp>
 
-#include <crypto++/osrng.h>
-
 using namespace shaiya::net;
 
 /**
@@ -14,28 +13,31 @@ using namespace shaiya::net;
  * @param session   The session instance.
  * @param request   The inbound handshake request.
  */
-void handleHandshake(Session& session, const GameHandshakeRequest& request)
+boost::asio::awaitable<void> handleHandshake(Session& session, const GameHandshakeRequest& request)
 {
     auto& game     = dynamic_cast<GameSession&>(session);  // The game session
     auto& api      = game.context().getApiService();
     auto& identity = request.identity;
 
     // Attempt to find the transfer request for a provided identity.
-    auto transfer = api.getTransferForIdentity(identity);
+    std::shared_ptr<const gameapi::SessionTransferRequest> transfer = api.getTransferForIdentity(identity);
     if (!transfer)
     {
         LOG(INFO) << "Couldn't find transfer request for user id: " << request.userId;
         game.close();
-        return;
+        co_return;
     }
 
+    // Set the session's user id, so the account is released when the session disconnects
+    game.setUserId(transfer->userid());
+
     // If the transfer doesn't originate from the same ip address, disconnect the session.
     if (game.remoteAddress() != transfer->ipaddress())
     {
         LOG(INFO) << "Transfer request was found for user id: " << request.userId << ", but request address "
                   << game.remoteAddress() << " did not match transfer origin address " << transfer->ipaddress();
         game.close();
-        return;
+        co_return;
     }
 
     // The aes key iv, and xor key
@@ -48,23 +50,20 @@ void handleHandshake(Session& session, const GameHandshakeRequest& request)
     std::memcpy(iv.data(), transfer->iv().data(), iv.size());
 
     // Generate the XOR key
-    CryptoPP::AutoSeededRandomPool prng;
-    prng.GenerateBlock((byte*)xorKey.data(), xorKey.size());
+    shaiya::crypto::SecureRandom::the().GenerateBlock((byte*)xorKey.data(), xorKey.size());
 
     // Initialise the encryption based on the previous AES keys.
     game.initEncryption(key, iv, xorKey);
+    game.setTransfer(std::move(transfer));
 
     // Generate the expanded key to use for game world encryption and provide it to the client
     GameHandshakeResponse response;
     std::memcpy(response.expandedKeySeed.data(), xorKey.data(), xorKey.size());
     game.write(response);
 
-    // Set the session's user id
-    game.setUserId(transfer->userid());
-
     // Show the character selection screen
     auto& charScreen = game.context().getCharScreen();
-    charScreen.display(game);
+    co_await charScreen.display(game);
 }
 
 /**
@@ -73,5 +72,5 @@ void handleHandshake(Session& session, const GameHandshakeRequest& request)
 template<>
 void PacketRegistry::registerPacketHandler<GameHandshakeOpcode>()
 {
-    registerHandler<GameHandshakeOpcode, GameHandshakeRequest>(&handleHandshake, ExecutionType::Asynchronous);
+    registerCoroutineHandler<GameHandshakeOpcode, GameHandshakeRequest>(&handleHandshake);
 }
\ No newline at end of file
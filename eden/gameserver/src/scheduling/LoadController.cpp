@@ -0,0 +1,137 @@
+#include <shaiya/game/scheduling/LoadController.hpp>
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <vector>
+
+using namespace shaiya::game;
+
+/**
+ * The weight of the latest tick in the smoothed utilisation.
+ */
+constexpr auto SMOOTHING = 0.2;
+
+/**
+ * The utilisation above which the world is considered to be under pressure.
+ */
+constexpr auto ESCALATE_THRESHOLD = 0.9;
+
+/**
+ * The utilisation below which the world is considered to have recovered.
+ */
+constexpr auto RECOVER_THRESHOLD = 0.6;
+
+/**
+ * The number of consecutive ticks under pressure before the degradation level is raised (250ms at a 50ms tick rate).
+ */
+constexpr auto ESCALATE_TICKS = 5;
+
+/**
+ * The number of consecutive recovered ticks before the degradation level is lowered (5s at a 50ms tick rate).
+ */
+constexpr auto RECOVER_TICKS = 100;
+
+/**
+ * The maximum number of packets processed per session per tick, while packets are capped.
+ */
+constexpr auto PACKET_CAP = 8;
+
+/**
+ * Updates the controller with the measured phase times of the last tick.
+ * @param phases    The phase times.
+ * @param tickRate  The duration of a tick.
+ */
+void LoadController::update(const TickPhases& phases, std::chrono::milliseconds tickRate)
+{
+    using namespace std::chrono;
+    auto ticks = ticks_.load();
+    tickTimes_.at(ticks % TICK_HISTORY).store(phases.total().count());
+    ticks_ = ticks + 1;
+
+    auto utilisation = static_cast<double>(phases.total().count()) / duration_cast<microseconds>(tickRate).count();
+    utilisation_ += SMOOTHING * (utilisation - utilisation_);
+
+    auto level = static_cast<uint8_t>(level_.load());
+    if (utilisation_ > ESCALATE_THRESHOLD)
+    {
+        calm_ = 0;
+        if (++pressure_ >= ESCALATE_TICKS && level_ != LoadLevel::DormantPaused)
+        {
+            setLevel(static_cast<LoadLevel>(level + 1), phases);
+            pressure_ = 0;
+        }
+    }
+    else if (utilisation_ < RECOVER_THRESHOLD)
+    {
+        pressure_ = 0;
+        if (++calm_ >= RECOVER_TICKS && level_ != LoadLevel::Normal)
+        {
+            setLevel(static_cast<LoadLevel>(level - 1), phases);
+            calm_ = 0;
+        }
+    }
+    else
+    {
+        pressure_ = 0;
+        calm_     = 0;
+    }
+}
+
+/**
+ * Gets the factor to multiply the synchronization interval of far entities by.
+ * @return  The interval scale.
+ */
+size_t LoadController::syncIntervalScale() const
+{
+    if (level_ >= LoadLevel::PacketCap)
+        return 4;
+    if (level_ >= LoadLevel::ReducedSync)
+        return 2;
+    return 1;
+}
+
+/**
+ * Gets the maximum number of packets to process for a session in a tick.
+ * @return  The packet cap, or 0 if the number of packets is unlimited.
+ */
+size_t LoadController::packetCap() const
+{
+    return level_ >= LoadLevel::PacketCap ? PACKET_CAP : 0;
+}
+
+/**
+ * Gets a percentile of the time taken by the recent ticks. This may be called from any thread.
+ * @param percentile    The percentile, between 0 and 1.
+ * @return              The tick time.
+ */
+std::chrono::microseconds LoadController::tickTime(double percentile) const
+{
+    auto count = std::min(ticks_.load(), TICK_HISTORY);
+    if (count == 0)
+        return std::chrono::microseconds(0);
+
+    std::vector<int64_t> times;
+    times.reserve(count);
+    for (size_t i = 0; i < count; i++)
+        times.push_back(tickTimes_.at(i).load());
+
+    auto index = std::min(static_cast<size_t>(percentile * static_cast<double>(count)), count - 1);
+    std::nth_element(times.begin(), times.begin() + index, times.end());
+    return std::chrono::microseconds(times.at(index));
+}
+
+/**
+ * Changes the degradation level.
+ * @param level     The new level.
+ * @param phases    The phase times of the tick that triggered the change.
+ */
+void LoadController::setLevel(LoadLevel level, const TickPhases& phases)
+{
+    LOG(WARNING) << "World load level changed from " << static_cast<int>(level_.load()) << " to "
+                 << static_cast<int>(level) << " at " << static_cast<int>(utilisation_ * 100)
+                 << "% tick utilisation (registrations " << phases.registrations.count() << "us, packets "
+                 << phases.packets.count() << "us, scheduler " << phases.scheduler.count() << "us, sync "
+                 << phases.sync.count() << "us).";
+    level_ = level;
+}
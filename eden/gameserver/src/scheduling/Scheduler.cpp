@@ -2,6 +2,11 @@
 
 using namespace shaiya::game;
 
+/**
+ * The number of pulses between each pulse of a non-urgent task, while tasks are being deferred.
+ */
+constexpr auto DEFERRED_INTERVAL = 2;
+
 /**
  * Pulses the active tasks, and removes those that are no longer running.
  * @param world The world instance
@@ -15,12 +20,16 @@ void Scheduler::pulse(GameWorldService& world)
         pendingTasks_.pop();
     }
 
+    // While deferring, non-urgent tasks are only pulsed on some pulses
+    auto deferred = deferring_ && (pulses_++ % DEFERRED_INTERVAL) != 0;
+
     // Iterate over the tasks
     auto itr = activeTasks_.begin();
     while (itr != activeTasks_.end())
     {
         auto task = *itr;
-        task->pulse(world);
+        if (!deferred || task->urgent())
+            task->pulse(world);
 
         if (!task->running())
         {
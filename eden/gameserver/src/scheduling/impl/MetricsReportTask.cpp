@@ -0,0 +1,37 @@
+#include <shaiya/common/db/DatabaseService.hpp>
+#include <shaiya/game/io/PlayerPrefetcher.hpp>
+#include <shaiya/game/scheduling/impl/MetricsReportTask.hpp>
+#include <shaiya/game/service/CharacterScreenService.hpp>
+#include <shaiya/game/service/GameWorldService.hpp>
+#include <shaiya/game/service/ServiceContext.hpp>
+#include <shaiya/game/service/ZoneDirectory.hpp>
+#include <shaiya/game/service/WorldApiService.hpp>
+
+#include <glog/logging.h>
+
+using namespace shaiya::game;
+
+/**
+ * Initialise this task.
+ * @param context   The service context.
+ * @param interval  The interval between reports, in ticks.
+ */
+MetricsReportTask::MetricsReportTask(ServiceContext& context, size_t interval)
+    : ScheduledTask(interval), context_(context)
+{
+}
+
+/**
+ * Handle the execution of this task.
+ */
+void MetricsReportTask::execute(GameWorldService& world)
+{
+    LOG(INFO) << context_.getCharScreen().cache().report();
+    if (auto* prefetcher = world.prefetcher())
+        LOG(INFO) << prefetcher->report();
+    LOG(INFO) << context_.getApiService().transfers().report();
+    LOG(INFO) << world.report();
+    LOG(INFO) << world.zones().report();
+    if (auto* db = context_.getDatabase())
+        LOG(INFO) << db->report();
+}
@@ -1,8 +1,13 @@
 #include <shaiya/common/util/Prng.hpp>
 #include <shaiya/game/model/actor/mob/Mob.hpp>
+#include <shaiya/game/model/actor/player/Player.hpp>
+#include <shaiya/game/model/map/MapTile.hpp>
 #include <shaiya/game/scheduling/impl/NpcMovementTask.hpp>
 #include <shaiya/game/service/GameWorldService.hpp>
 
+#include <execution>
+#include <set>
+
 using namespace shaiya::game;
 
 /**
@@ -29,20 +34,65 @@ NpcMovementTask::NpcMovementTask(): ScheduledTask(Delay)
 }
 
 /**
- * Handle the execution of this task.
+ * Handle the execution of this task. The mobs of each map tile are moved in parallel, as a tile exclusively owns the cells
+ * within it. Mobs that would wander into another tile are handed over once all tiles have finished, in tile order.
  */
 void NpcMovementTask::execute(GameWorldService& world)
 {
-    auto& prng = shaiya::Prng::the();
-    auto& mobs = world.mobs();
+    auto tiles = partitionByTile<Mob>(world.mobs());
 
-    for (auto&& mob: mobs)
+    // While the world is overloaded, only mobs in or next to a tile with players in it may wander
+    std::set<MapTile> awake;
+    auto paused = world.load().pauseDormant();
+    if (paused)
     {
-        if (!mob)
-            continue;
+        for (auto&& player: world.players())
+        {
+            auto map = player->map();
+            if (!map)
+                continue;
 
-        auto move = prng.percentage(MovementChance);  //(rand() % 100) < MovementChance;
-        if (move)
-            mob->setPosition(mob->spawnArea().randomPoint(MovementRange));
+            auto index = map->tileIndex(player->position());
+            awake.insert(MapTile{ .map = map->id(), .index = index });
+            awake.insert(MapTile{ .map = map->id(), .index = index + 1 });
+            if (index > 0)
+                awake.insert(MapTile{ .map = map->id(), .index = index - 1 });
+        }
     }
-}
\ No newline at end of file
+
+    // The mobs that are leaving their tile, and their destination
+    std::vector<std::vector<std::pair<std::shared_ptr<Mob>, Position>>> handovers(tiles.size());
+
+    std::for_each(std::execution::par, tiles.begin(), tiles.end(), [&](std::vector<std::shared_ptr<Mob>>& tile) {
+        auto& prng     = shaiya::Prng::the();
+        auto& handover = handovers.at(&tile - tiles.data());
+
+        for (auto&& mob: tile)
+        {
+            if (!prng.percentage(MovementChance))
+                continue;
+
+            auto& position = mob->position();
+            auto map       = mob->map();
+
+            // Dormant mobs don't wander while the world is overloaded
+            if (paused && !awake.contains(MapTile{ .map = map->id(), .index = map->tileIndex(position) }))
+                continue;
+
+            auto destination = mob->spawnArea().randomPoint(MovementRange);
+
+            // Defer the movement if the destination is owned by another tile
+            if (destination.map() != position.map() || map->tileIndex(destination) != map->tileIndex(position))
+            {
+                handover.emplace_back(mob, destination);
+                continue;
+            }
+            mob->setPosition(destination);
+        }
+    });
+
+    // Move the mobs that have crossed a tile boundary
+    for (auto&& handover: handovers)
+        for (auto&& [mob, destination]: handover)
+            mob->setPosition(destination);
+}
@@ -0,0 +1,52 @@
+#include <shaiya/game/model/actor/player/Player.hpp>
+#include <shaiya/game/scheduling/impl/PlayerPersistenceTask.hpp>
+#include <shaiya/game/service/GameWorldService.hpp>
+#include <shaiya/game/service/PersistenceService.hpp>
+
+#include <vector>
+
+using namespace shaiya::game;
+
+/**
+ * Initialise this task.
+ * @param persistence   The persistence service.
+ * @param interval      The interval between snapshots, in ticks.
+ */
+PlayerPersistenceTask::PlayerPersistenceTask(PersistenceService& persistence, size_t interval)
+    : ScheduledTask(interval), persistence_(persistence)
+{
+}
+
+/**
+ * Handle the execution of this task.
+ */
+void PlayerPersistenceTask::execute(GameWorldService& world)
+{
+    std::vector<PlayerSnapshot> dirty;
+    std::unordered_map<size_t, PlayerSnapshot> submitted;
+
+    for (auto&& player: world.players())
+    {
+        // Players that haven't finished loading have nothing to save
+        if (!player->active())
+            continue;
+
+        // Only submit the players whose state has changed since their last snapshot. Item changes are drained from the
+        // containers when the snapshot is taken, so a snapshot that holds any must always be submitted.
+        auto snapshot = PlayerSnapshot::of(*player);
+        auto previous = submitted_.find(snapshot.id);
+        if (previous == submitted_.end() || snapshot.hasItemChanges() || !previous->second.sameStateAs(snapshot))
+        {
+            dirty.push_back(snapshot);
+            submitted.emplace(snapshot.id, snapshot);
+        }
+        else
+        {
+            submitted.emplace(snapshot.id, previous->second);
+        }
+    }
+
+    // Players that have left the world are dropped from the submitted snapshots
+    submitted_ = std::move(submitted);
+    persistence_.submit(std::move(dirty));
+}
@@ -0,0 +1,20 @@
+#include <shaiya/game/scheduling/impl/WorldStatusTask.hpp>
+#include <shaiya/game/service/WorldApiService.hpp>
+
+using namespace shaiya::game;
+
+/**
+ * Initialise this task.
+ * @param api   The api service.
+ */
+WorldStatusTask::WorldStatusTask(WorldApiService& api): ScheduledTask(1), api_(api)
+{
+}
+
+/**
+ * Handle the execution of this task.
+ */
+void WorldStatusTask::execute(GameWorldService& world)
+{
+    api_.publishStatus();
+}
\ No newline at end of file
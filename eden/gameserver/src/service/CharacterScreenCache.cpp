@@ -0,0 +1,214 @@
+#include <shaiya/game/io/PlayerSnapshot.hpp>
+#include <shaiya/game/service/CharacterScreenCache.hpp>
+
+#include <sstream>
+
+using namespace shaiya;
+using namespace shaiya::game;
+using namespace shaiya::net;
+
+/**
+ * Initialises the cache.
+ * @param capacity  The maximum number of accounts to cache.
+ * @param ttl       The time an entry may be idle before it expires.
+ */
+CharacterScreenCache::CharacterScreenCache(size_t capacity, std::chrono::seconds ttl): capacity_(capacity), ttl_(ttl)
+{
+}
+
+/**
+ * Gets the cached faction of an account.
+ * @param userId    The id of the account.
+ * @return          The faction, or an empty optional if it isn't cached.
+ */
+std::optional<ShaiyaFaction> CharacterScreenCache::faction(uint32_t userId)
+{
+    std::lock_guard lock{ mutex_ };
+    auto* entry = find(userId);
+    if (!entry || !entry->faction)
+    {
+        misses_++;
+        return std::nullopt;
+    }
+
+    hits_++;
+    return entry->faction;
+}
+
+/**
+ * Gets the cached character list of an account.
+ * @param userId    The id of the account.
+ * @return          The character list packets, or an empty optional if they aren't cached.
+ */
+std::optional<std::vector<CharacterListEntry>> CharacterScreenCache::characters(uint32_t userId)
+{
+    std::lock_guard lock{ mutex_ };
+    auto* entry = find(userId);
+    if (!entry || !entry->characters)
+    {
+        misses_++;
+        return std::nullopt;
+    }
+
+    hits_++;
+    return entry->characters;
+}
+
+/**
+ * Gets the id of the character that an account last played, if it logged out while the account was cached.
+ * @param userId    The id of the account.
+ * @return          The id of the character, or an empty optional if it isn't known.
+ */
+std::optional<uint32_t> CharacterScreenCache::lastPlayed(uint32_t userId)
+{
+    std::lock_guard lock{ mutex_ };
+    auto* entry = find(userId);
+    return entry ? entry->lastPlayed : std::nullopt;
+}
+
+/**
+ * Caches the faction of an account.
+ * @param userId    The id of the account.
+ * @param faction   The faction.
+ */
+void CharacterScreenCache::setFaction(uint32_t userId, ShaiyaFaction faction)
+{
+    if (capacity_ == 0)
+        return;
+
+    std::lock_guard lock{ mutex_ };
+    obtain(userId).faction = faction;
+}
+
+/**
+ * Caches the character list of an account.
+ * @param userId        The id of the account.
+ * @param characters    The character list packets.
+ */
+void CharacterScreenCache::setCharacters(uint32_t userId, std::vector<CharacterListEntry> characters)
+{
+    if (capacity_ == 0)
+        return;
+
+    std::lock_guard lock{ mutex_ };
+    obtain(userId).characters = std::move(characters);
+}
+
+/**
+ * Updates the cached character list entry of a character that was saved, if the account is cached, and records it as
+ * the account's last played character.
+ * @param userId    The id of the account.
+ * @param snapshot  The snapshot of the character.
+ */
+void CharacterScreenCache::update(uint32_t userId, const PlayerSnapshot& snapshot)
+{
+    std::lock_guard lock{ mutex_ };
+    auto pos = entries_.find(userId);
+    if (pos == entries_.end() || !pos->second.characters)
+        return;
+
+    pos->second.lastPlayed = snapshot.id;
+    for (auto&& character: *pos->second.characters)
+    {
+        if (character.id == snapshot.id)
+            apply(character, snapshot);
+    }
+}
+
+/**
+ * Copies the state of a saved character onto its character list entry.
+ * @param character The character list entry.
+ * @param snapshot  The snapshot of the character.
+ */
+void CharacterScreenCache::apply(shaiya::net::CharacterListEntry& character, const PlayerSnapshot& snapshot)
+{
+    character.map          = snapshot.map;
+    character.strength     = snapshot.strength;
+    character.dexterity    = snapshot.dexterity;
+    character.reaction     = snapshot.reaction;
+    character.intelligence = snapshot.intelligence;
+    character.wisdom       = snapshot.wisdom;
+    character.luck         = snapshot.luck;
+    character.hitpoints    = snapshot.hitpoints;
+    character.mana         = snapshot.mana;
+    character.stamina      = snapshot.stamina;
+}
+
+/**
+ * Summarises the size of the cache, and how often it was hit.
+ * @return  The summary
+ */
+std::string CharacterScreenCache::report() const
+{
+    size_t size = 0;
+    {
+        std::lock_guard lock{ mutex_ };
+        size = entries_.size();
+    }
+
+    std::stringstream stream;
+    stream << "Character screen cache: " << size << "/" << capacity_ << " accounts, " << hits_ << " hits, " << misses_
+           << " misses.";
+    return stream.str();
+}
+
+/**
+ * Gets the live entry of an account, and marks it as the most recently used. This must be called while holding
+ * the mutex.
+ * @param userId    The id of the account.
+ * @return          The entry, or null if the account isn't cached or its entry has expired.
+ */
+CharacterScreenCache::Entry* CharacterScreenCache::find(uint32_t userId)
+{
+    auto pos = entries_.find(userId);
+    if (pos == entries_.end())
+        return nullptr;
+
+    auto& entry = pos->second;
+    auto now    = std::chrono::steady_clock::now();
+    if (now - entry.lastUsed > ttl_)
+    {
+        remove(userId);
+        return nullptr;
+    }
+
+    entry.lastUsed = now;
+    recency_.splice(recency_.begin(), recency_, entry.recency);
+    return &entry;
+}
+
+/**
+ * Gets the entry of an account, creating it if it doesn't exist, and marks it as the most recently used. This
+ * must be called while holding the mutex.
+ * @param userId    The id of the account.
+ * @return          The entry.
+ */
+CharacterScreenCache::Entry& CharacterScreenCache::obtain(uint32_t userId)
+{
+    if (auto* entry = find(userId))
+        return *entry;
+
+    // Evict the least recently used entries to make room
+    while (entries_.size() >= capacity_ && !recency_.empty())
+        remove(recency_.back());
+
+    recency_.push_front(userId);
+    auto& entry    = entries_[userId];
+    entry.lastUsed = std::chrono::steady_clock::now();
+    entry.recency  = recency_.begin();
+    return entry;
+}
+
+/**
+ * Removes the entry of an account. This must be called while holding the mutex.
+ * @param userId    The id of the account.
+ */
+void CharacterScreenCache::remove(uint32_t userId)
+{
+    auto pos = entries_.find(userId);
+    if (pos == entries_.end())
+        return;
+
+    recency_.erase(pos->second.recency);
+    entries_.erase(pos);
+}
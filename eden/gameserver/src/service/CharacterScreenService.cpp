@@ -1,9 +1,16 @@
-#include <shaiya/common/db/DatabaseService.hpp>
+#include <shaiya/common/db/AsyncDatabaseService.hpp>
 #include <shaiya/common/net/packet/game/AccountFaction.hpp>
+#include <shaiya/game/io/PlayerSerializer.hpp>
+#include <shaiya/game/io/PlayerSnapshot.hpp>
 #include <shaiya/game/net/GameSession.hpp>
 #include <shaiya/game/service/CharacterScreenService.hpp>
+#include <shaiya/game/service/GameWorldService.hpp>
+#include <shaiya/game/service/ServiceContext.hpp>
+
+#include <algorithm>
 
 using namespace shaiya;
+using namespace shaiya::database;
 using namespace shaiya::game;
 using namespace shaiya::net;
 
@@ -39,27 +46,42 @@ constexpr auto CREATE_CHARACTER = "create_character";
 
 /**
  * Initialises the character screen service.
- * @param db        The database service to use.
- * @param worldId   The id of this world server.
+ * @param db            The asynchronous database service to use, or null to keep the accounts in memory.
+ * @param worldId       The id of this world server.
+ * @param cacheSize     The maximum number of accounts whose character screen is cached.
+ * @param cacheTtl      The time a cached character screen may be idle before it expires.
  */
-CharacterScreenService::CharacterScreenService(shaiya::database::DatabaseService& db, uint32_t worldId)
-    : db_(db), worldId_(worldId)
+CharacterScreenService::CharacterScreenService(AsyncDatabaseService* db, uint32_t worldId, size_t cacheSize,
+                                               std::chrono::seconds cacheTtl)
+    : db_(db), worldId_(worldId), cache_(cacheSize, cacheTtl)
 {
-    db.prepare(FETCH_ACCOUNT_FACTION, "SELECT faction FROM gamedata.factions WHERE userid = $1 and world = $2");
-    db.prepare(UPDATE_ACCOUNT_FACTION, "SELECT gamedata.update_faction($1, $2, $3);");
-    db.prepare(FETCH_CHARACTERS, "SELECT * FROM gamedata.get_characters($1, $2);");
-    db.prepare(CREATE_CHARACTER,
-               "SELECT status FROM gamedata.create_character($1, $2, $3, $4, $5, $6, $7, $8, $9, $10, $11);");
+    if (!db)
+        return;
+
+    db->prepare(FETCH_ACCOUNT_FACTION, "SELECT faction FROM gamedata.factions WHERE userid = $1 and world = $2");
+    db->prepare(UPDATE_ACCOUNT_FACTION, "SELECT gamedata.update_faction($1, $2, $3);");
+    db->prepare(FETCH_CHARACTERS, "SELECT * FROM gamedata.get_characters($1, $2);");
+    db->prepare(CREATE_CHARACTER,
+                "SELECT status FROM gamedata.create_character($1, $2, $3, $4, $5, $6, $7, $8, $9, $10, $11);");
 }
 
 /**
- * Displays the character screen for a session.
+ * Displays the character screen for a session. The faction and character list are served from the cache when
+ * possible, and are otherwise read from the database and cached. The character that the player is most likely to
+ * select is then prefetched.
  * @param session   The session.
  */
-void CharacterScreenService::display(GameSession& session)
+boost::asio::awaitable<void> CharacterScreenService::display(GameSession& session)
 {
     // The player's faction
-    auto faction = getFaction(session);
+    auto cachedFaction = cache_.faction(session.userId());
+    if (!cachedFaction)
+    {
+        cachedFaction = co_await getFaction(session);
+        if (cachedFaction)
+            cache_.setFaction(session.userId(), *cachedFaction);
+    }
+    auto faction = cachedFaction.value_or(ShaiyaFaction::Neither);
 
     // Send the player their faction
     AccountFactionNotify factionNotify;
@@ -68,17 +90,41 @@ void CharacterScreenService::display(GameSession& session)
 
     // If the faction is neither Light nor Fury, don't send the character list
     if (faction == ShaiyaFaction::Neither)
-        return;
+        co_return;
 
     // Set the faction for the user
     session.setFaction(faction);
 
     // Get the list of characters for this session
-    auto characters = getCharacters(session);
+    auto characters = cache_.characters(session.userId());
+    if (!characters)
+    {
+        characters = co_await getCharacters(session);
+        if (characters)
+            cache_.setCharacters(session.userId(), *characters);
+    }
+
+    // If the characters couldn't be read, show the empty slots
+    if (!characters)
+    {
+        characters.emplace(CHARACTER_LIST_SIZE);
+        for (auto i = 0; i < characters->size(); i++)
+            characters->at(i).slot = i;
+    }
 
     // Send the character list
-    for (auto&& character: characters)
+    for (auto&& character: *characters)
         session.write(character, character.id ? sizeof(character) : EMPTY_CHARCTER_LENGTH);
+
+    // Prefetch the last played character, or the character in the first occupied slot
+    auto lastPlayed = cache_.lastPlayed(session.userId());
+    auto occupied   = [](auto& character) { return character.id != 0; };
+    auto played     = [&](auto& character) { return lastPlayed && character.id == *lastPlayed; };
+    auto candidate  = std::find_if(characters->begin(), characters->end(), played);
+    if (candidate == characters->end())
+        candidate = std::find_if(characters->begin(), characters->end(), occupied);
+    if (candidate != characters->end())
+        session.context().getGameWorld().prefetch(candidate->id);
 }
 
 /**
@@ -95,48 +141,144 @@ void CharacterScreenService::display(GameSession& session)
  * @param name      The name of the character
  * @return          The result of the character creation
  */
-CharacterCreateResult CharacterScreenService::createCharacter(GameSession& session, int slot, int race, int mode, int hair,
-                                                              int face, int height, int job, int gender, std::string name)
+boost::asio::awaitable<CharacterCreateResult> CharacterScreenService::createCharacter(GameSession& session, int slot,
+                                                                                      int race, int mode, int hair,
+                                                                                      int face, int height, int job,
+                                                                                      int gender, std::string name)
 {
     // If the destination slot is greater than the maximum character slots
     if (slot >= CHARACTER_LIST_SIZE)
-        return CharacterCreateResult::Error;
+        co_return CharacterCreateResult::Error;
 
-    try
+    // Without a database, the character only lives in memory
+    if (!db_)
     {
-        // Create a new connection to the database
-        auto connection = db_.connection();
-        pqxx::work tx(*connection);
+        CharacterListEntry character;
+        character.slot   = slot;
+        character.level  = 1;
+        character.race   = static_cast<ShaiyaRace>(race);
+        character.mode   = static_cast<ShaiyaGameMode>(mode);
+        character.hair   = hair;
+        character.face   = face;
+        character.height = height;
+        character.job    = static_cast<ShaiyaClass>(job);
+        character.gender = gender;
+        character.name   = name;
+        auto& serializer = session.context().getGameWorld().playerSerializer();
+        co_return createInMemory(session.userId(), std::move(character), serializer);
+    }
 
+    try
+    {
         // Attempt to create the character
-        auto response = tx.exec_prepared(CREATE_CHARACTER, worldId_, session.userId(), slot, race, mode, hair, face, height,
-                                         job, gender, name);
+        auto params   = AsyncDatabaseService::params(worldId_, session.userId(), slot, race, mode, hair, face, height, job,
+                                                     gender, name);
+        auto response = co_await db_->execute(CREATE_CHARACTER, std::move(params), boost::asio::use_awaitable);
 
         // If nothing was returned, treat it as an error
         if (response.empty())
-            return CharacterCreateResult::Error;
+            co_return CharacterCreateResult::Error;
 
         // The table returned by the character creation
-        auto row    = response.front();
-        auto result = static_cast<CharacterCreateResult>(row.front().as<size_t>());
+        auto result = static_cast<CharacterCreateResult>(response.get<size_t>(0, "status"));
+
+        // Refresh the cached character list, which now includes the new character
         if (result == CharacterCreateResult::Success)
-            tx.commit();
-        return result;
+        {
+            auto characters = co_await getCharacters(session);
+            if (characters)
+                cache_.setCharacters(session.userId(), std::move(*characters));
+        }
+        co_return result;
     }
     catch (const std::exception& e)
     {
         LOG(ERROR) << "Exception occurred while creating character for user id " << session.userId() << " from ip address "
                    << session.remoteAddress() << ": " << e.what();
-        return CharacterCreateResult::Error;
     }
+    co_return CharacterCreateResult::Error;
 }
 
 /**
- * Gets the list of characters for a session.
+ * Updates the cached character screen of an account, after one of its characters has been saved on logout.
+ * @param userId    The id of the account.
+ * @param snapshot  The final snapshot of the character.
+ */
+void CharacterScreenService::characterSaved(uint32_t userId, const PlayerSnapshot& snapshot)
+{
+    cache_.update(userId, snapshot);
+    if (db_)
+        return;
+
+    // The characters that are kept in memory are the only copy of the character list
+    std::lock_guard lock{ mutex_ };
+    auto pos = accounts_.find(userId);
+    if (pos == accounts_.end())
+        return;
+    for (auto&& character: pos->second.characters)
+    {
+        if (character.id == snapshot.id)
+            CharacterScreenCache::apply(character, snapshot);
+    }
+}
+
+/**
+ * Creates a character in memory, when there is no database. The character is added to the player serializer, which
+ * allocates its id.
+ * @param userId        The id of the account.
+ * @param character     The character.
+ * @param serializer    The player serializer.
+ * @return              The result of the character creation.
+ */
+CharacterCreateResult CharacterScreenService::createInMemory(uint32_t userId, CharacterListEntry character,
+                                                             PlayerSerializer& serializer)
+{
+    std::vector<CharacterListEntry> characters;
+    {
+        std::lock_guard lock{ mutex_ };
+
+        // Character names are unique across every account
+        for (auto&& [id, account]: accounts_)
+        {
+            auto taken = [&](auto& other) { return other.id != 0 && other.name == character.name; };
+            if (std::any_of(account.characters.begin(), account.characters.end(), taken))
+                return CharacterCreateResult::NameNotAvailable;
+        }
+
+        auto& account = accounts_[userId];
+        if (account.characters.empty())
+        {
+            account.characters.resize(CHARACTER_LIST_SIZE);
+            for (auto i = 0; i < account.characters.size(); i++)
+                account.characters.at(i).slot = i;
+        }
+
+        auto& entry = account.characters.at(character.slot);
+        if (entry.id != 0)
+            return CharacterCreateResult::Error;
+
+        // The serializer holds the character's data, so it loads with the chosen name, race, class and appearance
+        auto id = serializer.add(character);
+        if (!id)
+            return CharacterCreateResult::Error;
+
+        character.id = *id;
+        entry        = std::move(character);
+        characters   = account.characters;
+    }
+
+    // Refresh the cached character list, which now includes the new character
+    cache_.setCharacters(userId, std::move(characters));
+    return CharacterCreateResult::Success;
+}
+
+/**
+ * Gets the list of characters for a session from the database.
  * @param session   The session instance.
- * @return          The session's characters.
+ * @return          The session's characters, or an empty optional if they couldn't be read.
  */
-std::vector<CharacterListEntry> CharacterScreenService::getCharacters(GameSession& session)
+boost::asio::awaitable<std::optional<std::vector<CharacterListEntry>>>
+CharacterScreenService::getCharacters(GameSession& session)
 {
     // Prepare the packets
     std::vector<CharacterListEntry> characters;
@@ -144,84 +286,93 @@ std::vector<CharacterListEntry> CharacterScreenService::getCharacters(GameSessio
     for (auto i = 0; i < characters.size(); i++)
         characters.at(i).slot = i;
 
+    // Without a database, the characters are kept in memory
+    if (!db_)
+    {
+        std::lock_guard lock{ mutex_ };
+        auto pos = accounts_.find(session.userId());
+        if (pos != accounts_.end() && !pos->second.characters.empty())
+            characters = pos->second.characters;
+        co_return characters;
+    }
+
     // Attempt to get the character list from the database
     try
     {
-        // Create a new connection to the database
-        auto connection = db_.connection();
-        pqxx::work tx(*connection);
-
         // Fetch the character rows
-        auto rows = tx.exec_prepared(FETCH_CHARACTERS, worldId_, session.userId());
+        auto params = AsyncDatabaseService::params(worldId_, session.userId());
+        auto rows   = co_await db_->execute(FETCH_CHARACTERS, std::move(params), boost::asio::use_awaitable);
 
         // Loop through the rows
-        for (auto&& row: rows)
+        for (size_t row = 0; row < rows.size(); row++)
         {
-            auto slot = row["slot"].as<int>();
+            auto slot = rows.get<int>(row, "slot");
             assert(slot <= CHARACTER_LIST_SIZE);
 
             auto& character        = characters.at(slot);
-            character.id           = row["charid"].as<int>();
-            character.level        = row["level"].as<int>();
-            character.race         = static_cast<ShaiyaRace>(row["race"].as<int>());
-            character.mode         = static_cast<ShaiyaGameMode>(row["mode"].as<int>());
-            character.hair         = row["hair"].as<int>();
-            character.face         = row["face"].as<int>();
-            character.height       = row["height"].as<int>();
-            character.job          = static_cast<ShaiyaClass>(row["class"].as<int>());
-            character.gender       = row["gender"].as<int>();
-            character.map          = row["map"].as<int>();
-            character.strength     = row["strength"].as<int>();
-            character.dexterity    = row["dexterity"].as<int>();
-            character.reaction     = row["reaction"].as<int>();
-            character.intelligence = row["intelligence"].as<int>();
-            character.wisdom       = row["wisdom"].as<int>();
-            character.luck         = row["luck"].as<int>();
-            character.name         = row["name"].as<std::string>();
+            character.id           = rows.get<int>(row, "charid");
+            character.level        = rows.get<int>(row, "level");
+            character.race         = static_cast<ShaiyaRace>(rows.get<int>(row, "race"));
+            character.mode         = static_cast<ShaiyaGameMode>(rows.get<int>(row, "mode"));
+            character.hair         = rows.get<int>(row, "hair");
+            character.face         = rows.get<int>(row, "face");
+            character.height       = rows.get<int>(row, "height");
+            character.job          = static_cast<ShaiyaClass>(rows.get<int>(row, "class"));
+            character.gender       = rows.get<int>(row, "gender");
+            character.map          = rows.get<int>(row, "map");
+            character.strength     = rows.get<int>(row, "strength");
+            character.dexterity    = rows.get<int>(row, "dexterity");
+            character.reaction     = rows.get<int>(row, "reaction");
+            character.intelligence = rows.get<int>(row, "intelligence");
+            character.wisdom       = rows.get<int>(row, "wisdom");
+            character.luck         = rows.get<int>(row, "luck");
+            character.name         = rows.get<std::string>(row, "name");
         }
+        co_return characters;
     }
     catch (const std::exception& e)
     {
         LOG(ERROR) << "Exception occurred while fetching characters for user id " << session.userId() << " from ip address "
                    << session.remoteAddress() << ": " << e.what();
     }
-
-    return characters;
+    co_return std::nullopt;
 }
 
 /**
- * Gets the faction for a given session.
+ * Gets the faction for a given session from the database.
  * @param session   The session instance.
- * @return          The session's faction.
+ * @return          The session's faction, or an empty optional if it couldn't be read.
  */
-ShaiyaFaction CharacterScreenService::getFaction(shaiya::net::GameSession& session)
+boost::asio::awaitable<std::optional<ShaiyaFaction>> CharacterScreenService::getFaction(shaiya::net::GameSession& session)
 {
-    try
+    // Without a database, the faction is kept in memory
+    if (!db_)
     {
-        // Create a new connection to the database
-        auto connection = db_.connection();
-        pqxx::work tx(*connection);
+        std::lock_guard lock{ mutex_ };
+        auto pos = accounts_.find(session.userId());
+        co_return pos != accounts_.end() ? pos->second.faction : ShaiyaFaction::Neither;
+    }
 
+    try
+    {
         // Get the faction for the user on this server
-        auto rows = tx.exec_prepared(FETCH_ACCOUNT_FACTION, session.userId(), worldId_);
+        auto params = AsyncDatabaseService::params(session.userId(), worldId_);
+        auto rows   = co_await db_->execute(FETCH_ACCOUNT_FACTION, std::move(params), boost::asio::use_awaitable);
 
         // If no faction was found, return a notification for the user to select their faction
         if (rows.empty())
-            return ShaiyaFaction::Neither;
-
-        // Get the first row
-        auto row = rows.front();
+            co_return ShaiyaFaction::Neither;
 
         // Set the faction id
-        auto faction = row["faction"].as<int>();
-        return static_cast<ShaiyaFaction>(faction);
+        auto faction = rows.get<int>(0, "faction");
+        co_return static_cast<ShaiyaFaction>(faction);
     }
     catch (const std::exception& e)
     {
         LOG(ERROR) << "Exception occurred while fetching faction for user id " << session.userId() << " from ip address "
                    << session.remoteAddress() << ": " << e.what();
-        return ShaiyaFaction::Neither;
     }
+    co_return std::nullopt;
 }
 
 /**
@@ -229,26 +380,35 @@ ShaiyaFaction CharacterScreenService::getFaction(shaiya::net::GameSession& sessi
  * @param session   The session.
  * @param faction   The selected faction.
  */
-bool CharacterScreenService::setFaction(shaiya::net::GameSession& session, ShaiyaFaction faction)
+boost::asio::awaitable<bool> CharacterScreenService::setFaction(shaiya::net::GameSession& session, ShaiyaFaction faction)
 {
     // The faction may only be Light or Fury
     if (faction != ShaiyaFaction::Fury && faction != ShaiyaFaction::Light)
-        return false;
-    try
+        co_return false;
+
+    // Without a database, the faction is kept in memory
+    if (!db_)
     {
-        // Create a new connection to the database
-        auto connection = db_.connection();
-        pqxx::work tx(*connection);
+        {
+            std::lock_guard lock{ mutex_ };
+            accounts_[session.userId()].faction = faction;
+        }
+        cache_.setFaction(session.userId(), faction);
+        co_return true;
+    }
 
+    try
+    {
         // Execute the update
-        tx.exec_prepared(UPDATE_ACCOUNT_FACTION, worldId_, session.userId(), (int)faction);
-        tx.commit();
-        return true;
+        auto params = AsyncDatabaseService::params(worldId_, session.userId(), static_cast<int>(faction));
+        co_await db_->execute(UPDATE_ACCOUNT_FACTION, std::move(params), boost::asio::use_awaitable);
+        cache_.setFaction(session.userId(), faction);
+        co_return true;
     }
     catch (const std::exception& e)
     {
         LOG(ERROR) << "Exception occurred while setting faction to " << (int)faction << " for session with user id "
                    << session.userId() << " from ip address " << session.remoteAddress() << ": " << e.what();
-        return false;
     }
+    co_return false;
 }
\ No newline at end of file
@@ -1,6 +1,9 @@
 #include <shaiya/common/client/item/ItemSData.hpp>
 #include <shaiya/common/util/Async.hpp>
+#include <shaiya/game/io/PlayerPrefetcher.hpp>
+#include <shaiya/game/io/impl/BinaryPlayerSerializer.hpp>
 #include <shaiya/game/io/impl/DatabasePlayerSerializer.hpp>
+#include <shaiya/game/io/impl/MemoryPlayerSerializer.hpp>
 #include <shaiya/game/model/actor/mob/Mob.hpp>
 #include <shaiya/game/model/actor/npc/Npc.hpp>
 #include <shaiya/game/model/actor/player/Player.hpp>
@@ -8,35 +11,148 @@
 #include <shaiya/game/model/map/Map.hpp>
 #include <shaiya/game/net/GameSession.hpp>
 #include <shaiya/game/scheduling/impl/NpcMovementTask.hpp>
+#include <shaiya/game/scheduling/impl/PlayerPersistenceTask.hpp>
+#include <shaiya/game/service/CharacterScreenService.hpp>
 #include <shaiya/game/service/GameWorldService.hpp>
+#include <shaiya/game/service/PersistenceService.hpp>
+#include <shaiya/game/service/ServiceContext.hpp>
+#include <shaiya/game/service/ZoneDirectory.hpp>
 #include <shaiya/game/sync/ParallelClientSynchronizer.hpp>
 
+#include <boost/asio/post.hpp>
+
 #include <chrono>
+#include <limits>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
 
 using namespace shaiya::game;
 
 /**
  * Initialise this game world service.
- * @param db            The database service.
+ * @param db            The database service, or null if the players aren't stored in a database.
+ * @param charScreen    The character screen service, which is told about the characters that are saved.
  * @param worldId       The id of this world service.
  */
-GameWorldService::GameWorldService(shaiya::database::DatabaseService& db, size_t worldId): db_(db)
+GameWorldService::GameWorldService(shaiya::database::DatabaseService* db, CharacterScreenService& charScreen,
+                                   size_t worldId)
+    : db_(db), charScreen_(charScreen), worldId_(worldId)
 {
-    itemDefs_         = shaiya::client::ItemSData("./data/game/Item.SData");
-    synchronizer_     = std::make_unique<ParallelClientSynchronizer>();
-    playerSerializer_ = std::make_unique<DatabasePlayerSerializer>(db, itemDefs_, worldId);
+    itemDefs_ = shaiya::client::ItemSData("./data/game/Item.SData");
 }
 
+/**
+ * Saves any player snapshots that are still pending.
+ */
+GameWorldService::~GameWorldService() = default;
+
 /**
  * Loads the game world service.
  * @param config    The configuration instance.
  */
 void GameWorldService::load(boost::property_tree::ptree& config)
 {
-    mapRepository_.load(config.get<std::string>("World.MapFilePath"), *this);  // Load the game's maps.
+    // The maps may be split between several zones, each of which only loads the maps that it owns
+    auto parseMaps = [](const std::string& list) {
+        std::set<uint16_t> maps;
+        std::istringstream stream(list);
+        for (std::string id; std::getline(stream, id, ',');)
+        {
+            if (id.find_first_not_of(' ') != std::string::npos)
+                maps.insert(static_cast<uint16_t>(std::stoi(id)));
+        }
+        return maps;
+    };
+    auto deadline = std::chrono::milliseconds(config.get<size_t>("Zones.HandoffDeadline", 3000));
+    auto ttl      = std::chrono::milliseconds(config.get<size_t>("Zones.HandoffTtl", 30000));
+    zones_        = std::make_unique<ZoneDirectory>(parseMaps(config.get<std::string>("Zones.Maps", "")), deadline, ttl);
+
+    // The other zones, each of which is written as "host:port/map,map,..."
+    if (auto peers = config.get_child_optional("ZonePeers"))
+    {
+        for (auto&& [name, value]: *peers)
+        {
+            auto peer      = value.get_value<std::string>();
+            auto separator = peer.find('/');
+            if (separator == std::string::npos)
+                throw std::runtime_error("Invalid zone peer: " + name);
+            zones_->addZone(name, peer.substr(0, separator), parseMaps(peer.substr(separator + 1)));
+        }
+    }
+
+    // Load the game's maps.
+    auto owned = [&](uint16_t id) { return zones_->owns(id); };
+    mapRepository_.load(config.get<std::string>("World.MapFilePath"), *this, owned);
+    capacity_ = config.get<size_t>("World.Capacity", 0);
+
+    // Characters stay parked for a while after their account disconnects, so a quick reconnect can resume them
+    resumeWindow_ = std::chrono::milliseconds(config.get<size_t>("World.ResumeWindow", 0));
+
+    // The storage of player characters. The file and memory serializers allow the world to be load tested without a
+    // database, and create characters that don't exist yet from a prototype.
+    auto serializer = config.get<std::string>("Persistence.Serializer", "database");
+    if (serializer == "database")
+    {
+        if (!db_)
+            throw std::runtime_error("The database player serializer needs a database service.");
+        playerSerializer_ = std::make_unique<DatabasePlayerSerializer>(*db_, itemDefs_, worldId_);
+    }
+    else
+    {
+        CharacterData prototype;
+        prototype.map          = config.get<uint16_t>("Persistence.PrototypeMap", 0);
+        prototype.x            = config.get<float>("Persistence.PrototypeX", 0);
+        prototype.y            = config.get<float>("Persistence.PrototypeY", 0);
+        prototype.z            = config.get<float>("Persistence.PrototypeZ", 0);
+        prototype.strength     = config.get<int32_t>("Persistence.PrototypeStat", 10);
+        prototype.dexterity    = prototype.strength;
+        prototype.reaction     = prototype.strength;
+        prototype.intelligence = prototype.strength;
+        prototype.wisdom       = prototype.strength;
+        prototype.luck         = prototype.strength;
+        prototype.hitpoints    = std::numeric_limits<int32_t>::max();
+        prototype.mana         = std::numeric_limits<int32_t>::max();
+        prototype.stamina      = std::numeric_limits<int32_t>::max();
+
+        if (serializer == "binary")
+        {
+            auto path         = config.get<std::string>("Persistence.BinaryPath", "./data/characters/");
+            playerSerializer_ = std::make_unique<BinaryPlayerSerializer>(itemDefs_, path, std::move(prototype));
+        }
+        else if (serializer == "memory")
+        {
+            playerSerializer_ = std::make_unique<MemoryPlayerSerializer>(itemDefs_, std::move(prototype));
+        }
+        else
+        {
+            throw std::runtime_error("Unknown player serializer: " + serializer);
+        }
+    }
+
+    // Replay the journal of the previous run before any player can connect
+    auto journalPath   = config.get<std::string>("Persistence.JournalPath", "");
+    auto flushInterval = std::chrono::milliseconds(config.get<size_t>("Persistence.FlushInterval", 60000));
+    persistence_       = std::make_unique<PersistenceService>(*playerSerializer_, journalPath, flushInterval);
+
+    // Warm the data of the character that a player is likely to select, while they are on the character screen
+    if (config.get<bool>("Persistence.Prefetch", false))
+    {
+        auto ttl    = std::chrono::milliseconds(config.get<size_t>("Persistence.PrefetchTtl", 30000));
+        prefetcher_ = std::make_unique<PlayerPrefetcher>(*persistence_, ttl);
+    }
+
+    // The level-of-detail policy for client synchronization
+    SyncPolicy policy;
+    policy.nearDistance = config.get<float>("Sync.NearDistance", policy.nearDistance);
+    policy.farInterval  = config.get<size_t>("Sync.FarUpdateInterval", policy.farInterval);
+    policy.byteBudget   = config.get<size_t>("Sync.ByteBudget", policy.byteBudget);
+    synchronizer_       = std::make_unique<ParallelClientSynchronizer>(policy, loadController_);
 
     // Global tasks
     schedule(std::make_shared<NpcMovementTask>());
+    schedule(std::make_shared<PlayerPersistenceTask>(*persistence_, config.get<size_t>("Persistence.Interval", 100)));
 }
 
 /**
@@ -51,21 +167,41 @@ void GameWorldService::tick(size_t tickRate)
     while (running_)
     {
         // The time we should sleep until, for the next tick
-        auto nextTick = steady_clock::now() + milliseconds(tickRate);
+        auto start    = steady_clock::now();
+        auto nextTick = start + milliseconds(tickRate);
+
+        // The measured time of each phase of this tick
+        TickPhases phases;
+        auto measure = [&](microseconds& phase) {
+            auto now = steady_clock::now();
+            phase    = duration_cast<microseconds>(now - start);
+            start    = now;
+        };
 
-        // Finalise the registration and unregistrations for characters
-        finaliseRegistrations();
+        // Finalise the unregistrations and registrations for characters. The unregistrations come first, so that no
+        // character whose session has disconnected is registered or initialised.
         finaliseUnregistrations();
+        finaliseRegistrations();
+        directory_.publish();
+        measure(phases.registrations);
 
         // Process all the queued incoming packets
-        for (auto&& player: players_)
-            player->session().processQueue();
+        auto packetCap = loadController_.packetCap();
+        for (auto&& player: directory_.players())
+            player->session().processQueue(packetCap);
+        measure(phases.packets);
 
         // Pulse the game world
+        scheduler_.setDeferring(loadController_.deferTasks());
         scheduler_.pulse(*this);
+        measure(phases.scheduler);
 
         // Synchronize the characters with the world state
-        synchronizer_->synchronize(players_, npcs_, mobs_);
+        synchronizer_->synchronize(directory_.players(), npcs_, mobs_);
+        measure(phases.sync);
+
+        // Adjust the degradation level based on the time spent in this tick
+        loadController_.update(phases, milliseconds(tickRate));
 
         // The current time
         auto now = steady_clock::now();
@@ -73,7 +209,7 @@ void GameWorldService::tick(size_t tickRate)
         {
             auto difference = duration_cast<milliseconds>(now - nextTick);
             LOG(INFO) << "Game tick took too long - went over " << tickRate << "ms tick rate by " << difference.count()
-                      << "ms.";
+                      << "ms (load level " << static_cast<int>(loadController_.level()) << ").";
         }
 
         // Sleep until the next tick
@@ -107,6 +243,99 @@ void GameWorldService::unregisterPlayer(std::shared_ptr<Player> character)
     oldPlayers_.push(std::move(character));
 }
 
+/**
+ * Resumes a character that was parked when its account disconnected, by attaching it to the account's new session. The
+ * character returns to the world on the next tick, without reading it again.
+ * @param session   The new session of the account.
+ * @param id        The id of the selected character.
+ * @return          If the character was parked and has been resumed.
+ */
+bool GameWorldService::resume(shaiya::net::GameSession& session, size_t id)
+{
+    // Lock the mutex
+    std::lock_guard lock{ mutex_ };
+
+    auto pos = parkedPlayers_.find(session.userId());
+    if (pos == parkedPlayers_.end())
+        return false;
+
+    // The parked character has already been saved, so it can be forgotten if the account selected another character
+    auto character = std::move(pos->second.player);
+    parkedPlayers_.erase(pos);
+    parkedCount_ = parkedPlayers_.size();
+    if (character->id() != id)
+        return false;
+
+    // Attach the character to the new session, and queue it to return to the world
+    character->attach(session);
+    session.setPlayer(character);
+    resumedPlayers_.push(std::move(character));
+    resumed_++;
+    return true;
+}
+
+/**
+ * Hands a player off to the zone that owns the map they are moving to, if this zone doesn't own it. The player is hidden
+ * and saved, and the handoff is only sent once the save has completed. Their client is disconnected once the other zone
+ * has answered, so it can reconnect and select the character there.
+ * @param player        The player.
+ * @param destination   The position that the player is moving to.
+ * @return              If the player is being handed off to another zone.
+ */
+bool GameWorldService::handoff(Player& player, const Position& destination)
+{
+    auto* zone    = zones_->ownerOf(destination.map());
+    auto& session = player.session();
+    if (zone == nullptr || !session.transfer())
+        return false;
+
+    // The character arrives at the destination, with the session keys that its client already holds
+    auto data = CharacterData::of(player);
+    data.map  = destination.map();
+    data.x    = destination.x();
+    data.y    = destination.y();
+    data.z    = destination.z();
+
+    gameapi::PlayerHandoffRequest request;
+    *request.mutable_session() = *session.transfer();
+    request.set_characterid(player.id());
+    request.set_character(data.encode());
+
+    // Take the character's final snapshot as it leaves, unless it never finished loading into this zone
+    std::optional<PlayerSnapshot> snapshot;
+    if (player.active())
+    {
+        snapshot = PlayerSnapshot::of(player);
+        charScreen_.characterSaved(player.userId(), *snapshot);
+    }
+
+    // Hide the character, so its unregistration neither saves nor parks it again
+    player.deactivate();
+
+    // The other zone takes over the character as soon as it accepts it, so the final snapshot is saved before the handoff
+    // is sent. Otherwise a write-behind save of this zone could later overwrite the other zone's changes.
+    auto client = session.shared_from_this();
+    auto send   = [this, client, zone, request, snapshot]() {
+        auto close = [client]() {
+            boost::asio::post(client->socket().get_executor(), [client]() { client->close(); });
+        };
+
+        auto saved = !snapshot || persistence_->saveNow(*snapshot);
+        if (prefetcher_)
+            prefetcher_->invalidate(request.characterid());
+        if (!saved)
+        {
+            LOG(INFO) << "Failed to save character " << request.characterid() << " before handing it off.";
+            return close();
+        }
+
+        // Disconnect the client once the other zone has answered, whether or not it accepted the character
+        zones_->handoff(*zone, request, [close](bool) { close(); });
+    };
+    ASYNC(send)
+    return true;
+}
+
 /**
  * Registers a ground item to this world.
  * @param item  The ground item instance.
@@ -223,19 +452,114 @@ void GameWorldService::finaliseRegistrations()
     // Lock the mutex
     std::lock_guard lock{ mutex_ };
 
+    // Apply the data of the characters that have been read, and initialise them on the world thread
+    while (!loadedPlayers_.empty())
+    {
+        auto [character, data] = std::move(loadedPlayers_.front());
+        loadedPlayers_.pop();
+
+        // The session may have disconnected while the character was being read
+        if (!character->attached())
+            continue;
+
+        // A character that couldn't be read is never initialised, as its default state would be saved over its data.
+        // Its client is disconnected, which unregisters the character.
+        if (!data)
+        {
+            LOG(INFO) << "Failed to load character with id " << character->id() << ".";
+            directory_.remove(*character);
+
+            auto client = character->session().shared_from_this();
+            boost::asio::post(client->socket().get_executor(), [client]() { client->close(); });
+            continue;
+        }
+        playerSerializer_->apply(*character, *data);
+        directory_.rename(*character);
+
+        // A character that was last on a map owned by another zone is handed off to it
+        auto& position = character->position();
+        if (!zones_->owns(position.map()) && handoff(*character, position))
+            continue;
+        character->init();
+    }
+
+    // Retry the characters that were deferred on the previous tick
+    for (auto&& character: std::exchange(deferredResumptions_, {}))
+        resumedPlayers_.push(std::move(character));
+    for (auto&& character: std::exchange(deferredRegistrations_, {}))
+        newPlayers_.push(std::move(character));
+
+    // Return the resumed characters to the world, and send their state to their new session
+    while (!resumedPlayers_.empty())
+    {
+        auto character = std::move(resumedPlayers_.front());
+        resumedPlayers_.pop();
+
+        // The new session may have disconnected before the character returned to the world
+        if (!character->attached())
+            continue;
+
+        // The account's previous player may not have been unregistered yet
+        if (!directory_.add(character))
+        {
+            deferredResumptions_.push_back(std::move(character));
+            continue;
+        }
+        directory_.rename(*character);
+
+        auto map = mapRepository_.forId(character->position().map());
+        map->add(character);
+        character->sendState();
+    }
+
     // Process the registrations
     while (!newPlayers_.empty())
     {
         auto character = newPlayers_.front();
         newPlayers_.pop();
-        players_.push_back(character);
 
+        // The session may have disconnected before the character was registered
+        if (!character->attached())
+            continue;
+
+        // A character whose account still has a player in the world waits until that player has been unregistered
+        if (!directory_.add(character))
+        {
+            deferredRegistrations_.push_back(std::move(character));
+            continue;
+        }
+
+        // Use the data of a character that another zone handed off to this one
+        if (auto arrived = zones_->claim(character->id()))
+        {
+            loadedPlayers_.emplace(character, std::move(arrived));
+            continue;
+        }
+
+        // Use the prefetched data of the character if it is still fresh, or wait for the prefetch if it's still running
+        auto deliver = [&, character](std::optional<CharacterData> data) {
+            std::lock_guard lock{ mutex_ };
+            loadedPlayers_.emplace(character, std::move(data));
+        };
+        std::optional<CharacterData> prefetched;
+        if (prefetcher_ && prefetcher_->claim(character->id(), prefetched, deliver))
+        {
+            if (prefetched)
+                loadedPlayers_.emplace(character, std::move(prefetched));
+            continue;
+        }
+
+        // Read the character away from the world thread, along with any of their snapshots that are yet to be saved, and
+        // queue the data to be applied on the next tick
         auto load = [&, character]() {
-            playerSerializer_->load(*character);
-            character->init();
+            auto data = persistence_->read(character->id());
+
+            std::lock_guard lock{ mutex_ };
+            loadedPlayers_.emplace(character, std::move(data));
         };
         ASYNC(load)
     }
+    playerCount_ = directory_.size();
 }
 
 /**
@@ -246,33 +570,108 @@ void GameWorldService::finaliseUnregistrations()
     // Lock the mutex
     std::lock_guard lock{ mutex_ };
 
+    // Forget the parked characters whose account didn't reconnect in time. They were saved when they were parked.
+    auto now = std::chrono::steady_clock::now();
+    std::erase_if(parkedPlayers_, [&](auto& element) { return element.second.expiresAt <= now; });
+
+    // The final snapshots of the characters that are leaving, which are saved as a single batch
+    std::vector<PlayerSnapshot> snapshots;
+
+    // The ids of the characters that are leaving
+    std::vector<size_t> leaving;
+
     // Process the unregistrations
     while (!oldPlayers_.empty())
     {
-        // Deactivate the character
+        // Deactivate the character, taking their final snapshot if they finished loading
         auto character = oldPlayers_.front();
         oldPlayers_.pop();
+        leaving.push_back(character->id());
+        if (character->active())
+        {
+            snapshots.push_back(PlayerSnapshot::of(*character));
+
+            // Keep the account's cached character screen in step with the saved character
+            charScreen_.characterSaved(character->userId(), snapshots.back());
+
+            // Park the character, so its account can resume it without a read if it reconnects within the window
+            if (resumeWindow_.count() > 0)
+                parkedPlayers_.insert_or_assign(character->userId(), ParkedPlayer{ character, now + resumeWindow_ });
+        }
         character->deactivate();
 
-        // Remove the character from their map
-        auto map = mapRepository_.forId(character->position().map());
-        map->remove(character);
+        // The session has disconnected, so the character must not use it again
+        character->detach();
 
-        auto finalise = [&, character = std::move(character)]() {
-            playerSerializer_->save(*character);
+        // Remove the character from their map, which isn't loaded if the character was handed off to another zone
+        auto map = mapRepository_.forId(character->position().map());
+        if (map)
+            map->remove(character);
 
-            // Find the character
-            auto predicate = [&](auto& element) { return element.get() == character.get(); };
-            auto pos       = std::find_if(players_.begin(), players_.end(), predicate);
+        // Remove the character from the directory, or from the deferred characters if it never reached the directory
+        directory_.remove(*character);
+        std::erase(deferredResumptions_, character);
+        std::erase(deferredRegistrations_, character);
+    }
+    playerCount_ = directory_.size();
+    parkedCount_ = parkedPlayers_.size();
+    persistence_->submit(std::move(snapshots));
 
-            // Remove the character
-            if (pos != players_.end())
-                players_.erase(pos);
-        };
-        ASYNC(finalise)
+    // Discard the prefetches of the characters only once their final snapshots are queued, so a prefetch that starts in
+    // between reads them
+    if (prefetcher_)
+    {
+        for (auto id: leaving)
+            prefetcher_->invalidate(id);
     }
 }
 
+/**
+ * Submits a snapshot of a player to be saved straight away, rather than waiting for the next persistence task. This
+ * should be used after high-value changes, such as a completed trade.
+ * @param player    The player.
+ */
+void GameWorldService::persist(Player& player)
+{
+    if (!player.active())
+        return;
+
+    std::vector<PlayerSnapshot> snapshots;
+    snapshots.push_back(PlayerSnapshot::of(player));
+    persistence_->submit(std::move(snapshots));
+}
+
+/**
+ * Starts reading a character's data in the background, while its player is still on the character screen. This does
+ * nothing unless prefetching is enabled.
+ * @param id    The id of the character.
+ */
+void GameWorldService::prefetch(size_t id)
+{
+    if (prefetcher_)
+        prefetcher_->prefetch(id);
+}
+
+/**
+ * Summarises the connected and parked players, and how many parked characters were resumed.
+ * @return  The summary
+ */
+std::string GameWorldService::report() const
+{
+    std::stringstream stream;
+    stream << "Game world: " << playerCount_ << " players, " << parkedCount_ << " parked, " << resumed_ << " resumed.";
+    return stream.str();
+}
+
+/**
+ * Gets the number of player snapshots that are waiting to be saved.
+ * @return  The number of pending saves.
+ */
+size_t GameWorldService::pendingSaves() const
+{
+    return persistence_ ? persistence_->pending() : 0;
+}
+
 /**
  * Schedules a task to be executed in the future.
  * @param task  The task.
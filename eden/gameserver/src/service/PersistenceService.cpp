@@ -0,0 +1,462 @@
+#include <shaiya/game/io/PlayerSerializer.hpp>
+#include <shaiya/game/service/PersistenceService.hpp>
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+using namespace shaiya::game;
+
+/**
+ * The delay before retrying a batch that failed to save.
+ */
+constexpr auto RETRY_DELAY = std::chrono::seconds(5);
+
+/**
+ * Initialises this service, replays any snapshots that were left in the journal, and starts the journal and
+ * flush threads. An exception is thrown if the journal can't be replayed into the database.
+ * @param serializer    The serializer used to save the snapshots.
+ * @param journalPath   The directory of the journal, or an empty string to save without a journal.
+ * @param flushInterval The interval between database saves, when a journal is used.
+ */
+PersistenceService::PersistenceService(PlayerSerializer& serializer, const std::string& journalPath,
+                                       std::chrono::milliseconds flushInterval)
+    : serializer_(serializer), flushInterval_(flushInterval)
+{
+    if (!journalPath.empty())
+    {
+        journal_    = std::make_unique<PlayerJournal>(journalPath);
+        quarantine_ = std::make_unique<PlayerJournal>(journalPath + "/quarantine");
+        replay();
+        journalThread_ = std::thread(&PersistenceService::journal, this);
+    }
+    thread_ = std::thread(&PersistenceService::run, this);
+}
+
+/**
+ * Stops the journal and flush threads, after saving any snapshots that are still pending.
+ */
+PersistenceService::~PersistenceService()
+{
+    // Journal the snapshots that have already been submitted
+    {
+        std::lock_guard lock{ mutex_ };
+        running_ = false;
+    }
+    condition_.notify_all();
+    if (journalThread_.joinable())
+        journalThread_.join();
+
+    // Save everything that is still pending
+    {
+        std::lock_guard lock{ mutex_ };
+        saving_ = false;
+    }
+    condition_.notify_all();
+    thread_.join();
+}
+
+/**
+ * Submits a batch of snapshots to be saved.
+ * @param snapshots The snapshots.
+ */
+void PersistenceService::submit(std::vector<PlayerSnapshot> snapshots)
+{
+    if (snapshots.empty())
+        return;
+
+    {
+        std::lock_guard lock{ mutex_ };
+        if (journal_)
+            std::move(snapshots.begin(), snapshots.end(), std::back_inserter(unjournaled_));
+        else
+            coalesce(pending_, snapshots);
+    }
+    condition_.notify_all();
+}
+
+/**
+ * Reads the latest state of a player character. The persisted state is read from the serializer, and the snapshots of
+ * the character that haven't been saved yet are applied on top of it, so a character that logs back in before their last
+ * snapshot is flushed doesn't lose it. This may be called from any thread.
+ * @param id    The id of the character.
+ * @return      The character data, or an empty optional if the character couldn't be read.
+ */
+std::optional<CharacterData> PersistenceService::read(size_t id)
+{
+    // Copy the unsaved snapshots of the character, from the oldest to the newest
+    std::vector<PlayerSnapshot> unsaved;
+    {
+        std::lock_guard lock{ mutex_ };
+        auto copy = [&](const std::unordered_map<size_t, PlayerSnapshot>& snapshots) {
+            if (auto pos = snapshots.find(id); pos != snapshots.end())
+                unsaved.push_back(pos->second);
+        };
+        auto copyAll = [&](const std::vector<PlayerSnapshot>& snapshots) {
+            std::copy_if(snapshots.begin(), snapshots.end(), std::back_inserter(unsaved),
+                         [&](auto& snapshot) { return snapshot.id == id; });
+        };
+        copy(inflight_);
+        copy(pending_);
+        copyAll(journaling_);
+        copyAll(unjournaled_);
+        copy(urgent_);
+    }
+
+    // The snapshots are copied before the character is read, so a save that completes in between is applied twice,
+    // which is harmless as a snapshot holds the absolute state of what it changed
+    auto data = serializer_.read(id);
+    if (data)
+    {
+        for (auto&& snapshot: unsaved)
+            data->update(snapshot);
+    }
+    return data;
+}
+
+/**
+ * Saves the final snapshot of a character straight away, and waits for it to be saved. The character's older snapshots
+ * that are still queued are dropped, and their item changes are inherited by the final snapshot, so nothing this
+ * service saves later can overwrite it. This must be called away from the world thread, once the character can no
+ * longer be snapshotted.
+ * @param snapshot  The final snapshot.
+ * @return          If the snapshot was saved. If it wasn't, it is queued to be saved like any other snapshot.
+ */
+bool PersistenceService::saveNow(PlayerSnapshot snapshot)
+{
+    auto id = snapshot.id;
+    {
+        // Wait for the journal and flush threads to let go of the character, so an older save can't land after this one
+        std::unique_lock lock{ mutex_ };
+        auto journaling = [&] {
+            return std::any_of(journaling_.begin(), journaling_.end(), [&](auto& older) { return older.id == id; });
+        };
+        condition_.wait(lock, [&] { return !inflight_.contains(id) && !journaling(); });
+
+        // Take the older snapshots out of the queues, oldest first, so each one inherits the changes before it
+        std::optional<PlayerSnapshot> older;
+        if (auto pos = pending_.find(id); pos != pending_.end())
+        {
+            older = std::move(pos->second);
+            pending_.erase(pos);
+        }
+        std::erase_if(unjournaled_, [&](auto& unjournaled) {
+            if (unjournaled.id != id)
+                return false;
+            if (older)
+                unjournaled.inheritChanges(*older);
+            older = std::move(unjournaled);
+            return true;
+        });
+        if (older)
+            snapshot.inheritChanges(*older);
+
+        // Keep the snapshot visible to readers while it is being saved
+        urgent_.insert_or_assign(id, snapshot);
+    }
+
+    std::vector<PlayerSnapshot> batch{ snapshot };
+    auto saved = save(batch);
+
+    std::lock_guard lock{ mutex_ };
+    urgent_.erase(id);
+    if (!saved)
+    {
+        LOG(INFO) << "Failed to save the final snapshot of character " << id << ", which has been queued instead.";
+        std::vector<PlayerSnapshot> snapshots{ std::move(snapshot) };
+        coalesce(pending_, snapshots);
+    }
+    return saved;
+}
+
+/**
+ * Gets the number of snapshots that are waiting to be saved.
+ * @return  The number of pending snapshots.
+ */
+size_t PersistenceService::pending()
+{
+    std::lock_guard lock{ mutex_ };
+    return pending_.size();
+}
+
+/**
+ * Adds snapshots to a set of pending snapshots, replacing any older snapshot of the same character.
+ * @param pending   The pending snapshots, keyed by character id.
+ * @param snapshots The snapshots to add.
+ */
+void PersistenceService::coalesce(std::unordered_map<size_t, PlayerSnapshot>& pending,
+                                  std::vector<PlayerSnapshot>& snapshots)
+{
+    for (auto&& snapshot: snapshots)
+    {
+        // A newer snapshot replaces a pending one, but the item changes of the pending one are still unsaved
+        auto [pos, inserted] = pending.try_emplace(snapshot.id, snapshot);
+        if (!inserted)
+        {
+            snapshot.inheritChanges(pos->second);
+            pos->second = std::move(snapshot);
+        }
+    }
+}
+
+/**
+ * Saves the snapshots that were left in the journal by a previous run, and deletes them from the journal.
+ */
+void PersistenceService::replay()
+{
+    auto records = journal_->replay();
+    if (!records.empty())
+    {
+        // Only the latest state of each character needs to be saved
+        std::unordered_map<size_t, PlayerSnapshot> latest;
+        coalesce(latest, records);
+
+        std::vector<PlayerSnapshot> batch;
+        batch.reserve(latest.size());
+        for (auto&& [id, snapshot]: latest)
+            batch.push_back(std::move(snapshot));
+
+        if (!save(batch))
+            throw std::runtime_error("Failed to replay the player journal into the database.");
+        LOG(INFO) << "Replayed " << records.size() << " journaled snapshots of " << batch.size() << " characters.";
+    }
+
+    // Every segment from the previous run has now been saved
+    journal_->compact(journal_->rotate());
+}
+
+/**
+ * Appends the submitted snapshots to the journal until this service is stopped.
+ */
+void PersistenceService::journal()
+{
+    std::unique_lock lock{ mutex_ };
+    while (running_ || !unjournaled_.empty())
+    {
+        condition_.wait(lock, [&] { return !running_ || !unjournaled_.empty(); });
+        if (unjournaled_.empty())
+            continue;
+
+        // Take every submitted snapshot as a single group, which is made durable with a single sync
+        // The group stays visible to readers while it is written, as it isn't pending yet
+        journaling_ = std::move(unjournaled_);
+        unjournaled_.clear();
+        lock.unlock();
+
+        std::lock_guard journalLock{ journalMutex_ };
+        try
+        {
+            journal_->append(journaling_);
+            journal_->sync();
+        }
+        catch (const std::exception& e)
+        {
+            LOG(ERROR) << "Failed to journal " << journaling_.size() << " snapshots, which are only kept in memory: "
+                       << e.what();
+        }
+
+        // Queue the group to be saved, before the journal lock is released
+        lock.lock();
+        coalesce(pending_, journaling_);
+        journaling_.clear();
+        condition_.notify_all();
+    }
+}
+
+/**
+ * Saves the pending snapshots until this service is stopped.
+ */
+void PersistenceService::run()
+{
+    std::unique_lock lock{ mutex_ };
+    while (saving_ || !pending_.empty())
+    {
+        // Without a journal, snapshots are saved as soon as they are pending. With a journal, they are already durable,
+        // so they are left to coalesce until the next flush.
+        auto ready = [&] { return !saving_ || (!journal_ && !pending_.empty()); };
+        if (journal_)
+            condition_.wait_for(lock, flushInterval_, ready);
+        else
+            condition_.wait(lock, ready);
+
+        if (pending_.empty())
+            continue;
+
+        // Seal the journal first, so every snapshot in the sealed segments is already pending
+        lock.unlock();
+        auto sealed = seal();
+        lock.lock();
+
+        // Take every pending snapshot as a single batch, which stays visible to readers until it has been saved
+        std::vector<PlayerSnapshot> batch;
+        batch.reserve(pending_.size());
+        for (auto&& [id, snapshot]: pending_)
+            batch.push_back(snapshot);
+        inflight_ = std::move(pending_);
+        pending_.clear();
+
+        // Save the batch without holding the lock, so the world thread can keep submitting
+        lock.unlock();
+        flush(std::move(batch), sealed);
+        lock.lock();
+        inflight_.clear();
+        condition_.notify_all();
+    }
+}
+
+/**
+ * Seals the journal segments that hold the snapshots which have been queued to be saved.
+ * @return  The id of the last sealed segment, or zero if no segments were sealed.
+ */
+size_t PersistenceService::seal()
+{
+    if (!journal_)
+        return 0;
+
+    try
+    {
+        std::lock_guard lock{ journalMutex_ };
+        return journal_->rotate();
+    }
+    catch (const std::exception& e)
+    {
+        LOG(ERROR) << "Failed to rotate the player journal: " << e.what();
+    }
+    return 0;
+}
+
+/**
+ * Saves a batch of snapshots. Snapshots that can never be saved are quarantined and removed from the batch, rather than
+ * failing the batch forever. If the batch fails as a whole, the characters are saved one at a time, and the ones that
+ * still fail are quarantined too, unless none of them could be saved, which means the database is unavailable.
+ * @param batch The batch of snapshots.
+ * @return      If the snapshots that remain in the batch were saved.
+ */
+bool PersistenceService::save(std::vector<PlayerSnapshot>& batch)
+{
+    // Set aside the snapshots that no database would accept
+    auto invalid = std::stable_partition(batch.begin(), batch.end(), [](auto& snapshot) { return snapshot.valid(); });
+    if (invalid != batch.end())
+    {
+        quarantine(std::vector<PlayerSnapshot>(invalid, batch.end()));
+        batch.erase(invalid, batch.end());
+    }
+
+    if (batch.empty() || serializer_.save(batch))
+        return true;
+    if (batch.size() == 1)
+        return false;
+
+    // Find the snapshots that fail the batch, by saving the characters one at a time
+    std::vector<PlayerSnapshot> saved;
+    std::vector<PlayerSnapshot> failed;
+    for (auto&& snapshot: batch)
+        (serializer_.save({ snapshot }) ? saved : failed).push_back(snapshot);
+    if (saved.empty())
+        return false;
+
+    quarantine(failed);
+    batch = std::move(saved);
+    return true;
+}
+
+/**
+ * Sets aside snapshots that can never be saved, so they don't hold up the rest of the characters. They are appended to
+ * the quarantine journal, if there is one, so they can be inspected and repaired by hand.
+ * @param snapshots The snapshots.
+ */
+void PersistenceService::quarantine(const std::vector<PlayerSnapshot>& snapshots)
+{
+    if (snapshots.empty())
+        return;
+
+    for (auto&& snapshot: snapshots)
+        LOG(ERROR) << "Quarantined a snapshot of character " << snapshot.id << " that can't be saved.";
+    quarantined_ += snapshots.size();
+
+    if (!quarantine_)
+        return;
+
+    try
+    {
+        quarantine_->append(snapshots);
+        quarantine_->sync();
+    }
+    catch (const std::exception& e)
+    {
+        LOG(ERROR) << "Failed to journal " << snapshots.size() << " quarantined snapshots: " << e.what();
+    }
+}
+
+/**
+ * Saves a batch of snapshots, and records the batch metrics. If the batch fails to save, its snapshots are put
+ * back in the pending queue, unless a newer snapshot of the same character has since been submitted, in which case
+ * the newer snapshot inherits their unsaved item changes. Once the batch has been saved, the journal segments that
+ * it covers are deleted.
+ * @param batch     The batch of snapshots.
+ * @param sealed    The id of the last journal segment covered by the batch.
+ */
+void PersistenceService::flush(std::vector<PlayerSnapshot> batch, size_t sealed)
+{
+    using namespace std::chrono;
+
+    if (!save(batch))
+    {
+        std::unique_lock lock{ mutex_ };
+        if (!saving_)
+        {
+            LOG(INFO) << "Failed to save a batch of " << batch.size() << " characters while shutting down.";
+
+            // Everything has been journaled by now, so the journal is left intact to be replayed on the next startup
+            if (journal_)
+                pending_.clear();
+            return;
+        }
+
+        LOG(INFO) << "Failed to save a batch of " << batch.size() << " characters, retrying in "
+                  << duration_cast<seconds>(RETRY_DELAY).count() << "s.";
+        for (auto&& snapshot: batch)
+        {
+            auto [pos, inserted] = pending_.try_emplace(snapshot.id, snapshot);
+            if (!inserted)
+                pos->second.inheritChanges(snapshot);
+        }
+
+        // The batch is pending again, so a final save doesn't have to wait out the retry delay
+        inflight_.clear();
+        condition_.notify_all();
+
+        // Wait before retrying, unless the service is stopping
+        condition_.wait_for(lock, RETRY_DELAY, [&] { return !saving_; });
+        return;
+    }
+
+    // The batch is in the database, so the journal no longer needs the segments it covers
+    if (journal_ && sealed)
+    {
+        try
+        {
+            std::lock_guard lock{ journalMutex_ };
+            journal_->compact(sealed);
+        }
+        catch (const std::exception& e)
+        {
+            LOG(ERROR) << "Failed to compact the player journal: " << e.what();
+        }
+    }
+
+    // The save lag is the age of the oldest snapshot in the batch
+    if (batch.empty())
+        return;
+    auto oldest = std::min_element(batch.begin(), batch.end(), [](auto& a, auto& b) { return a.takenAt < b.takenAt; });
+    auto lag    = duration_cast<milliseconds>(steady_clock::now() - oldest->takenAt).count();
+
+    lastBatchSize_ = batch.size();
+    lastSaveLag_   = lag;
+    if (lag > maxSaveLag_)
+        maxSaveLag_ = lag;
+
+    LOG(INFO) << "Saved a batch of " << batch.size() << " characters with a save lag of " << lag << "ms.";
+}
@@ -0,0 +1,187 @@
+#include <shaiya/game/model/actor/player/Player.hpp>
+#include <shaiya/game/service/PlayerDirectory.hpp>
+
+#include <algorithm>
+#include <cctype>
+
+using namespace shaiya::game;
+
+/**
+ * Lower-cases a character name, so that names are matched regardless of their case.
+ * @param name  The name.
+ * @return      The lower-cased name.
+ */
+auto lowercase = [](std::string_view name) {
+    std::string lower(name);
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return std::tolower(c); });
+    return lower;
+};
+
+/**
+ * Gets the player with a character id.
+ * @param id    The id of the character.
+ * @return      The player, or null if no such player is connected.
+ */
+const PlayerEntry* PlayerDirectory::Snapshot::forId(size_t id) const
+{
+    auto pos = players.find(id);
+    return pos != players.end() ? &pos->second : nullptr;
+}
+
+/**
+ * Gets the player with a character name, ignoring its case.
+ * @param name  The name of the character.
+ * @return      The player, or null if no such player is connected.
+ */
+const PlayerEntry* PlayerDirectory::Snapshot::forName(std::string_view name) const
+{
+    auto pos = names.find(lowercase(name));
+    return pos != names.end() ? forId(pos->second) : nullptr;
+}
+
+/**
+ * Gets the player of an account.
+ * @param userId    The id of the account.
+ * @return          The player, or null if the account has no connected player.
+ */
+const PlayerEntry* PlayerDirectory::Snapshot::forUser(uint32_t userId) const
+{
+    auto pos = users.find(userId);
+    return pos != users.end() ? forId(pos->second) : nullptr;
+}
+
+/**
+ * Initialises this directory, with an empty snapshot.
+ */
+PlayerDirectory::PlayerDirectory(): snapshot_(std::make_shared<const Snapshot>())
+{
+}
+
+/**
+ * Adds a player to this directory. This must only be called on the world thread.
+ * @param player    The player.
+ * @return          If the player was added, or false if its character or account already has a player.
+ */
+bool PlayerDirectory::add(std::shared_ptr<Player> player)
+{
+    auto id     = player->id();
+    auto userId = player->userId();
+    if (current_.players.contains(id) || current_.users.contains(userId))
+        return false;
+
+    PlayerEntry entry;
+    entry.id     = id;
+    entry.userId = userId;
+    current_.players.emplace(id, std::move(entry));
+    current_.users.emplace(userId, id);
+
+    indices_.emplace(id, players_.size());
+    players_.push_back(std::move(player));
+    dirty_ = true;
+    return true;
+}
+
+/**
+ * Indexes the name of a player, once its data has been loaded. This must only be called on the world thread.
+ * @param player    The player.
+ */
+void PlayerDirectory::rename(const Player& player)
+{
+    if (indexOf(player) == players_.size())
+        return;
+
+    auto& entry = current_.players.at(player.id());
+    if (!entry.name.empty())
+        current_.names.erase(lowercase(entry.name));
+
+    entry.name = player.name();
+    if (!entry.name.empty())
+        current_.names.insert_or_assign(lowercase(entry.name), entry.id);
+    dirty_ = true;
+}
+
+/**
+ * Removes a player from this directory. This must only be called on the world thread.
+ * @param player    The player.
+ */
+void PlayerDirectory::remove(const Player& player)
+{
+    auto index = indexOf(player);
+    if (index == players_.size())
+        return;
+
+    // Forget the player's entry, and the names that point to it
+    auto pos = current_.players.find(player.id());
+    if (!pos->second.name.empty())
+        current_.names.erase(lowercase(pos->second.name));
+    current_.users.erase(pos->second.userId);
+    current_.players.erase(pos);
+
+    // Move the last player into the removed player's place, so removal doesn't shift the vector
+    indices_.erase(player.id());
+    if (index != players_.size() - 1)
+    {
+        players_[index] = std::move(players_.back());
+        indices_[players_[index]->id()] = index;
+    }
+    players_.pop_back();
+    dirty_ = true;
+}
+
+/**
+ * Gets the player with a character id. This must only be called on the world thread.
+ * @param id    The id of the character.
+ * @return      The player, or null if no such player is connected.
+ */
+std::shared_ptr<Player> PlayerDirectory::forId(size_t id) const
+{
+    auto pos = indices_.find(id);
+    return pos != indices_.end() ? players_[pos->second] : nullptr;
+}
+
+/**
+ * Gets the player with a character name, ignoring its case. This must only be called on the world thread.
+ * @param name  The name of the character.
+ * @return      The player, or null if no such player is connected.
+ */
+std::shared_ptr<Player> PlayerDirectory::forName(std::string_view name) const
+{
+    auto* entry = current_.forName(name);
+    return entry ? forId(entry->id) : nullptr;
+}
+
+/**
+ * Gets the player of an account. This must only be called on the world thread.
+ * @param userId    The id of the account.
+ * @return          The player, or null if the account has no connected player.
+ */
+std::shared_ptr<Player> PlayerDirectory::forUser(uint32_t userId) const
+{
+    auto* entry = current_.forUser(userId);
+    return entry ? forId(entry->id) : nullptr;
+}
+
+/**
+ * Publishes the changes made since the last call as a new snapshot. This must only be called on the world thread.
+ */
+void PlayerDirectory::publish()
+{
+    if (!dirty_)
+        return;
+
+    snapshot_.store(std::make_shared<const Snapshot>(current_));
+    dirty_ = false;
+}
+
+/**
+ * Gets the index of a player in the vector of players.
+ * @param player    The player.
+ * @return          The index, or the size of the vector if the player isn't in this directory.
+ */
+size_t PlayerDirectory::indexOf(const Player& player) const
+{
+    auto pos = indices_.find(player.id());
+    if (pos == indices_.end() || players_[pos->second].get() != &player)
+        return players_.size();
+    return pos->second;
+}
@@ -1,10 +1,14 @@
+#include <shaiya/common/db/AsyncDatabaseService.hpp>
 #include <shaiya/common/db/DatabaseService.hpp>
+#include <shaiya/game/scheduling/impl/MetricsReportTask.hpp>
+#include <shaiya/game/scheduling/impl/WorldStatusTask.hpp>
 #include <shaiya/game/service/CharacterScreenService.hpp>
 #include <shaiya/game/service/GameWorldService.hpp>
 #include <shaiya/game/service/ServiceContext.hpp>
 #include <shaiya/game/service/WorldApiService.hpp>
 
 #include <cassert>
+#include <memory>
 #include <thread>
 
 using namespace shaiya::game;
@@ -15,27 +19,57 @@ using namespace shaiya::game;
  */
 ServiceContext::ServiceContext(boost::property_tree::ptree& config)
 {
-    // The database credentials
-    auto dbHost = config.get<std::string>("Database.Host");
-    auto dbUser = config.get<std::string>("Database.User");
-    auto dbPass = config.get<std::string>("Database.Pass");
-    auto dbName = config.get<std::string>("Database.Database");
-
     // The world api port
     auto worldApiPort = config.get<uint16_t>("Network.WorldApiPort");
 
+    // The time a session transfer waits for its client
+    auto transferTtl = std::chrono::milliseconds(config.get<size_t>("Network.TransferTtl", 30000));
+
     // The world id
     auto worldId = config.get<uint32_t>("World.Id");
 
-    // Initialise the database service
-    dbService_   = new shaiya::database::DatabaseService(dbHost, dbName, dbUser, dbPass);
-    apiService_  = new WorldApiService();
-    charScreen_  = new CharacterScreenService(*dbService_, worldId);
-    gameService_ = new GameWorldService(*dbService_, worldId);
+    // The character screen cache
+    auto cacheSize = config.get<size_t>("CharacterScreen.CacheSize", 10000);
+    auto cacheTtl  = std::chrono::seconds(config.get<size_t>("CharacterScreen.CacheTtl", 1800));
+
+    // Initialise the database services, unless the players are stored without a database
+    if (config.get<std::string>("Persistence.Serializer", "database") == "database")
+    {
+        // The database credentials
+        auto dbHost = config.get<std::string>("Database.Host");
+        auto dbUser = config.get<std::string>("Database.User");
+        auto dbPass = config.get<std::string>("Database.Pass");
+        auto dbName = config.get<std::string>("Database.Database");
+
+        // The database connection pool options
+        shaiya::database::PoolOptions pool;
+        pool.minConnections  = config.get<size_t>("Database.MinConnections", pool.minConnections);
+        pool.maxConnections  = config.get<size_t>("Database.MaxConnections", pool.maxConnections);
+        pool.checkoutTimeout = std::chrono::milliseconds(config.get<size_t>("Database.CheckoutTimeout", 5000));
+
+        // The number of connections used for non-blocking queries
+        auto asyncConnections = config.get<size_t>("Database.AsyncConnections", 4);
+        auto queryTimeout     = std::chrono::milliseconds(config.get<size_t>("Database.QueryTimeout", 10000));
+
+        dbService_      = new shaiya::database::DatabaseService(dbHost, dbName, dbUser, dbPass, pool);
+        asyncDbService_ = new shaiya::database::AsyncDatabaseService(dbHost, dbName, dbUser, dbPass, asyncConnections,
+                                                                     queryTimeout);
+    }
+
+    charScreen_  = new CharacterScreenService(asyncDbService_, worldId, cacheSize, cacheTtl);
+    gameService_ = new GameWorldService(dbService_, *charScreen_, worldId);
+    apiService_  = new WorldApiService(*gameService_, transferTtl);
 
     // Load the game world
     gameService_->load(config);
 
+    // Periodically log a summary of the services
+    auto reportInterval = config.get<size_t>("World.ReportInterval", 1200);
+    gameService_->schedule(std::make_shared<MetricsReportTask>(*this, reportInterval));
+
+    // Publish the status of the world to the status streams of the login server
+    gameService_->schedule(std::make_shared<WorldStatusTask>(*apiService_));
+
     // Run the api service on an external thread, as it blocks
     std::thread apiThread(&WorldApiService::start, apiService_, worldApiPort);
     apiThread.detach();
@@ -74,4 +108,13 @@ GameWorldService& ServiceContext::getGameWorld()
 {
     assert(gameService_);
     return *gameService_;
+}
+
+/**
+ * Gets the database service.
+ * @return  The database service, or null if the players are stored without a database.
+ */
+shaiya::database::DatabaseService* ServiceContext::getDatabase()
+{
+    return dbService_;
 }
\ No newline at end of file
@@ -0,0 +1,225 @@
+#include <shaiya/game/service/SessionTransferTable.hpp>
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+using namespace shaiya::game;
+using namespace gameapi;
+
+/**
+ * The interval between sweeps for expired transfers.
+ */
+constexpr auto EXPIRY_INTERVAL = std::chrono::seconds(1);
+
+/**
+ * Initialises this table, and starts the thread that expires transfers.
+ * @param ttl   The time a transfer waits for its client before it expires.
+ */
+SessionTransferTable::SessionTransferTable(std::chrono::milliseconds ttl): ttl_(ttl)
+{
+    thread_ = std::thread(&SessionTransferTable::run, this);
+}
+
+/**
+ * Stops the thread that expires transfers.
+ */
+SessionTransferTable::~SessionTransferTable()
+{
+    {
+        std::lock_guard lock{ mutex_ };
+        running_ = false;
+    }
+    condition_.notify_all();
+    thread_.join();
+}
+
+/**
+ * Submits a transfer. A pending transfer of the same account is replaced, as its client won't use it anymore.
+ * @param request   The transfer request.
+ * @return          The status of the transfer.
+ */
+SessionTransferStatus SessionTransferTable::submit(const SessionTransferRequest& request)
+{
+    Identity identity{ 0 };
+    std::memcpy(identity.data(), request.identity().data(), std::min(identity.size(), request.identity().size()));
+
+    auto& accountShard = shardFor(request.userid());
+    std::lock_guard accountLock{ accountShard.mutex };
+
+    // An account that is logged in can't be transferred again until it is released
+    auto [pos, inserted] = accountShard.accounts.try_emplace(request.userid());
+    auto& account        = pos->second;
+    if (!inserted && !account.pending)
+    {
+        rejected_++;
+        return SessionTransferStatus::AlreadyLoggedIn;
+    }
+
+    // Replace the account's previous transfer
+    if (account.pending)
+    {
+        auto& previous = shardFor(*account.pending);
+        std::lock_guard lock{ previous.mutex };
+        if (previous.transfers.erase(*account.pending))
+            pending_--;
+    }
+    account.pending = identity;
+
+    auto& shard = shardFor(identity);
+    std::lock_guard lock{ shard.mutex };
+
+    Transfer transfer;
+    transfer.request   = std::make_unique<SessionTransferRequest>(request);
+    transfer.expiresAt = std::chrono::steady_clock::now() + ttl_;
+    if (shard.transfers.insert_or_assign(identity, std::move(transfer)).second)
+        pending_++;
+    return SessionTransferStatus::Success;
+}
+
+/**
+ * Takes the transfer of a client that has connected, and marks its account as logged in.
+ * @param identity  The identity of the client.
+ * @return          The transfer request, or null if there is no pending transfer for the identity.
+ */
+std::unique_ptr<SessionTransferRequest> SessionTransferTable::take(const Identity& identity)
+{
+    auto& shard = shardFor(identity);
+
+    // Find the account of the transfer
+    uint32_t userId = 0;
+    {
+        std::lock_guard lock{ shard.mutex };
+        auto pos = shard.transfers.find(identity);
+        if (pos == shard.transfers.end())
+            return nullptr;
+        userId = pos->second.request->userid();
+    }
+
+    // Lock the account before the transfer, and check that the transfer wasn't replaced or expired in the meantime
+    auto& accountShard = shardFor(userId);
+    std::lock_guard accountLock{ accountShard.mutex };
+    std::lock_guard lock{ shard.mutex };
+
+    auto pos = shard.transfers.find(identity);
+    if (pos == shard.transfers.end())
+        return nullptr;
+
+    auto request = std::move(pos->second.request);
+    shard.transfers.erase(pos);
+    pending_--;
+
+    // The account is now logged in
+    auto account = accountShard.accounts.find(userId);
+    if (account != accountShard.accounts.end() && account->second.pending == identity)
+        account->second.pending.reset();
+    return request;
+}
+
+/**
+ * Releases an account that has logged out, so it can be transferred again.
+ * @param userId    The id of the account.
+ */
+void SessionTransferTable::release(uint32_t userId)
+{
+    auto& accountShard = shardFor(userId);
+    std::lock_guard lock{ accountShard.mutex };
+
+    // An account with a pending transfer has already been released
+    auto pos = accountShard.accounts.find(userId);
+    if (pos != accountShard.accounts.end() && !pos->second.pending)
+        accountShard.accounts.erase(pos);
+}
+
+/**
+ * Summarises the pending transfers, and how many expired or were rejected.
+ * @return  The summary
+ */
+std::string SessionTransferTable::report() const
+{
+    std::stringstream stream;
+    stream << "Session transfers: " << pending_ << " pending, " << expired_ << " expired, " << rejected_ << " rejected.";
+    return stream.str();
+}
+
+/**
+ * Gets the shard that holds the transfer of an identity.
+ * @param identity  The identity.
+ * @return          The transfer shard.
+ */
+SessionTransferTable::TransferShard& SessionTransferTable::shardFor(const Identity& identity)
+{
+    return transferShards_[IdentityHash()(identity) % SHARD_COUNT];
+}
+
+/**
+ * Gets the shard that holds an account.
+ * @param userId    The id of the account.
+ * @return          The account shard.
+ */
+SessionTransferTable::AccountShard& SessionTransferTable::shardFor(uint32_t userId)
+{
+    return accountShards_[userId % SHARD_COUNT];
+}
+
+/**
+ * Expires the transfers that have outlived their time to live, until this table is destroyed.
+ */
+void SessionTransferTable::run()
+{
+    std::unique_lock lock{ mutex_ };
+    while (running_)
+    {
+        if (condition_.wait_for(lock, EXPIRY_INTERVAL, [&] { return !running_; }))
+            break;
+
+        lock.unlock();
+        expire();
+        lock.lock();
+    }
+}
+
+/**
+ * Expires the transfers that have outlived their time to live.
+ */
+void SessionTransferTable::expire()
+{
+    auto now = std::chrono::steady_clock::now();
+
+    // Remove the expired transfers from each shard
+    std::vector<std::pair<Identity, uint32_t>> expired;
+    for (auto&& shard: transferShards_)
+    {
+        std::lock_guard lock{ shard.mutex };
+        std::erase_if(shard.transfers, [&](auto& element) {
+            auto& [identity, transfer] = element;
+            if (transfer.expiresAt > now)
+                return false;
+
+            expired.emplace_back(identity, transfer.request->userid());
+            return true;
+        });
+    }
+
+    if (expired.empty())
+        return;
+
+    // Forget the accounts of the expired transfers, unless they have since been replaced
+    for (auto&& [identity, userId]: expired)
+    {
+        auto& accountShard = shardFor(userId);
+        std::lock_guard lock{ accountShard.mutex };
+
+        auto pos = accountShard.accounts.find(userId);
+        if (pos != accountShard.accounts.end() && pos->second.pending == identity)
+            accountShard.accounts.erase(pos);
+    }
+
+    pending_ -= expired.size();
+    expired_ += expired.size();
+    LOG(INFO) << "Expired " << expired.size() << " session transfers whose client never connected.";
+}
@@ -1,8 +1,12 @@
+#include <shaiya/game/service/GameWorldService.hpp>
 #include <shaiya/game/service/WorldApiService.hpp>
+#include <shaiya/game/service/ZoneDirectory.hpp>
 
 #include <boost/format.hpp>
 #include <glog/logging.h>
 
+#include <chrono>
+
 using namespace shaiya::game;
 using namespace gameapi;
 using namespace grpc;
@@ -12,6 +16,21 @@ using namespace grpc;
  */
 constexpr auto IpAddress = "0.0.0.0";
 
+/**
+ * The maximum interval between two streamed world statuses, even if the status hasn't changed.
+ */
+constexpr auto HeartbeatInterval = std::chrono::seconds(10);
+
+/**
+ * Initialises this api service.
+ * @param world         The game world.
+ * @param transferTtl   The time a session transfer waits for its client before it expires.
+ */
+WorldApiService::WorldApiService(const GameWorldService& world, std::chrono::milliseconds transferTtl)
+    : world_(world), transfers_(transferTtl)
+{
+}
+
 /**
  * Starts this api service and listens for connections on a specified port.
  * @param port  The port to listen on.
@@ -40,7 +59,38 @@ void WorldApiService::start(uint16_t port)
  */
 Status WorldApiService::GetWorldStatus(ServerContext* context, const Void* request, WorldStatus* response)
 {
-    response->set_players(5);
+    populateStatus(*response);
+    return Status::OK;
+}
+
+/**
+ * Streams the status of this game world. A status is pushed whenever it changes, and at a regular interval otherwise,
+ * so the login server can tell the world is still alive. The stream ends when the client cancels it.
+ * @param context   The context of this server.
+ * @param request   The request, which for this case is just an empty message.
+ * @param writer    The writer for the stream of statuses.
+ * @return          The status of the request.
+ */
+Status WorldApiService::StreamWorldStatus(ServerContext* context, const Void* request, ServerWriter<WorldStatus>* writer)
+{
+    size_t version = 0;
+    while (!context->IsCancelled())
+    {
+        // Wait for the world to publish a new status, or for the heartbeat to be due
+        WorldStatus status;
+        {
+            std::unique_lock lock{ statusMutex_ };
+            statusChanged_.wait_for(lock, HeartbeatInterval, [&]() { return statusVersion_ != version; });
+            if (statusVersion_ == 0)
+                continue;
+
+            version = statusVersion_;
+            status  = status_;
+        }
+
+        if (context->IsCancelled() || !writer->Write(status))
+            break;
+    }
     return Status::OK;
 }
 
@@ -54,42 +104,114 @@ Status WorldApiService::GetWorldStatus(ServerContext* context, const Void* reque
 Status WorldApiService::SubmitSessionTransfer(ServerContext* context, const SessionTransferRequest* request,
                                               SessionTransferResponse* response)
 {
-    // Make a copy of the request and store it in our pending transfers
-    auto transfer = new SessionTransferRequest(*request);
-    pendingTransfers_.push_back(transfer);
+    // The identity must be the size of the one presented by the client
+    if (request->identity().size() != std::tuple_size_v<SessionTransferTable::Identity>)
+        return Status(StatusCode::INVALID_ARGUMENT, "Invalid session identity");
 
-    // Inform the login server that we accepted this transfer request.
-    response->set_status(SessionTransferStatus::Success);
+    // Store a copy of the request, and inform the login server if we accepted it
+    auto status = transfers_.submit(*request);
+    if (status == SessionTransferStatus::AlreadyLoggedIn)
+        LOG(INFO) << "Rejected session transfer for user id " << request->userid() << ", who is already logged in.";
+
+    response->set_status(status);
     return Status::OK;
 }
 
 /**
- * Gets a transfer request for a given identity
- * @param identity  The identity
- * @return          The transfer request.
+ * Handles a player that another zone is handing off to this one. The player's session is expected like a session
+ * transfer from the login server, and their character data is held until their client selects them.
+ * @param context   The context of this server.
+ * @param request   The handoff request.
+ * @param response  The handoff response, which is used to tell the other zone if we accepted it or not.
+ * @return          The status of the request.
  */
-std::unique_ptr<gameapi::SessionTransferRequest> WorldApiService::getTransferForIdentity(std::array<char, 16> identity)
+Status WorldApiService::HandoffPlayer(ServerContext* context, const PlayerHandoffRequest* request,
+                                      SessionTransferResponse* response)
 {
-    std::unique_ptr<gameapi::SessionTransferRequest> request = nullptr;
-    for (auto&& transfer: pendingTransfers_)
-    {
-        // Get the transfer identity
-        auto transferIdentity = transfer->identity();
-        if (std::memcmp(identity.data(), transferIdentity.data(), identity.size()) == 0)
-        {
-            request.reset(transfer);
-            break;
-        }
-    }
+    auto& session = request->session();
+    if (session.identity().size() != std::tuple_size_v<SessionTransferTable::Identity>)
+        return Status(StatusCode::INVALID_ARGUMENT, "Invalid session identity");
+
+    // The character must be intact, and on a map that this zone owns
+    shaiya::game::CharacterData data;
+    auto& character = request->character();
+    if (!CharacterData::decode(character.data(), character.size(), data))
+        return Status(StatusCode::INVALID_ARGUMENT, "Invalid character data");
+    if (!world_.zones().owns(data.map))
+        return Status(StatusCode::FAILED_PRECONDITION, "Map is not owned by this zone");
 
-    // If a request was found, remove it from the pending vector
-    if (request)
+    // The character may still be in this zone, if it is bouncing straight back
+    if (world_.directory().snapshot()->forId(request->characterid()))
     {
-        auto pos = std::find(pendingTransfers_.begin(), pendingTransfers_.end(), request.get());
-        if (pos != pendingTransfers_.end())
-        {
-            pendingTransfers_.erase(pos);
-        }
+        response->set_status(SessionTransferStatus::AlreadyLoggedIn);
+        return Status::OK;
     }
-    return request;
-}
\ No newline at end of file
+
+    // Expect the client, and hold its character until it is selected
+    auto status = transfers_.submit(session);
+    if (status == SessionTransferStatus::Success)
+        world_.zones().accept(request->characterid(), std::move(data));
+    else
+        LOG(INFO) << "Rejected handoff of character " << request->characterid() << ", whose account is already logged in.";
+
+    response->set_status(status);
+    return Status::OK;
+}
+
+/**
+ * Publishes the current status of the game world, and wakes the status streams if it has changed. This is called on
+ * the world thread, once per tick.
+ */
+void WorldApiService::publishStatus()
+{
+    WorldStatus status;
+    populateStatus(status);
+
+    std::lock_guard lock{ statusMutex_ };
+    if (statusVersion_ != 0 && status.SerializeAsString() == status_.SerializeAsString())
+        return;
+
+    status_ = std::move(status);
+    statusVersion_++;
+    statusChanged_.notify_all();
+}
+
+/**
+ * Populates the status of this game world.
+ * @param status    The status to populate.
+ */
+void WorldApiService::populateStatus(WorldStatus& status) const
+{
+    // Tick times are reported in milliseconds, so the status doesn't change with every tick
+    auto tickTime = [&](double percentile) {
+        auto time = world_.load().tickTime(percentile);
+        return static_cast<int32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(time).count());
+    };
+
+    status.set_players(static_cast<int32_t>(world_.playerCount()));
+    status.set_capacity(static_cast<int32_t>(world_.capacity()));
+    status.set_loadlevel(static_cast<int32_t>(world_.load().level()));
+    status.set_ticktimep50(tickTime(0.5));
+    status.set_ticktimep99(tickTime(0.99));
+    status.set_pendingtransfers(static_cast<int32_t>(transfers_.pending()));
+    status.set_pendingsaves(static_cast<int32_t>(world_.pendingSaves()));
+}
+
+/**
+ * Takes the transfer request for a given identity, and marks its account as logged in.
+ * @param identity  The identity
+ * @return          The transfer request, or null if there is no pending transfer for the identity.
+ */
+std::unique_ptr<SessionTransferRequest> WorldApiService::getTransferForIdentity(const std::array<char, 16>& identity)
+{
+    return transfers_.take(identity);
+}
+
+/**
+ * Releases an account that has logged out, so it can be transferred to this world again.
+ * @param userId    The id of the account.
+ */
+void WorldApiService::releaseTransfer(uint32_t userId)
+{
+    transfers_.release(userId);
+}
@@ -0,0 +1,148 @@
+#include <shaiya/common/util/Async.hpp>
+#include <shaiya/game/service/ZoneDirectory.hpp>
+
+#include <glog/logging.h>
+#include <grpc++/grpc++.h>
+
+#include <sstream>
+
+using namespace shaiya::game;
+using namespace gameapi;
+
+/**
+ * Initialises this directory.
+ * @param maps      The ids of the maps that this zone owns, or an empty set if it owns every map.
+ * @param deadline  The time another zone has to accept a handoff.
+ * @param ttl       The time a character that was handed off to this zone waits for its client.
+ */
+ZoneDirectory::ZoneDirectory(std::set<uint16_t> maps, std::chrono::milliseconds deadline, std::chrono::milliseconds ttl)
+    : maps_(std::move(maps)), deadline_(deadline), ttl_(ttl)
+{
+}
+
+/**
+ * Adds a zone that owns some of the maps that this zone doesn't.
+ * @param name      The name of the zone.
+ * @param endpoint  The endpoint of the zone's world api.
+ * @param maps      The ids of the maps that the zone owns.
+ */
+void ZoneDirectory::addZone(std::string name, std::string endpoint, std::set<uint16_t> maps)
+{
+    auto channel = grpc::CreateChannel(endpoint, grpc::InsecureChannelCredentials());
+
+    auto& zone    = zones_.emplace_back();
+    zone.name     = std::move(name);
+    zone.endpoint = std::move(endpoint);
+    zone.maps     = std::move(maps);
+    zone.stub     = GameService::NewStub(channel);
+    LOG(INFO) << "Zone " << zone.name << " at " << zone.endpoint << " owns " << zone.maps.size() << " maps.";
+}
+
+/**
+ * Checks if this zone owns a map.
+ * @param map   The id of the map.
+ * @return      If this zone owns the map.
+ */
+bool ZoneDirectory::owns(uint16_t map) const
+{
+    return maps_.empty() || maps_.count(map);
+}
+
+/**
+ * Gets the zone that owns a map which this zone doesn't.
+ * @param map   The id of the map.
+ * @return      The owning zone, or null if this zone owns the map, or no zone does.
+ */
+const Zone* ZoneDirectory::ownerOf(uint16_t map) const
+{
+    if (owns(map))
+        return nullptr;
+
+    for (auto&& zone: zones_)
+    {
+        if (zone.maps.count(map))
+            return &zone;
+    }
+    return nullptr;
+}
+
+/**
+ * Hands a character off to another zone, without blocking.
+ * @param zone      The zone.
+ * @param request   The handoff request.
+ * @param callback  The callback that receives the outcome, which is invoked on another thread.
+ */
+void ZoneDirectory::handoff(const Zone& zone, PlayerHandoffRequest request, HandoffCallback callback)
+{
+    auto task = [this, &zone, request = std::move(request), callback = std::move(callback)]() {
+        grpc::ClientContext context;
+        context.set_deadline(std::chrono::system_clock::now() + deadline_);
+
+        SessionTransferResponse response;
+        auto status   = zone.stub->HandoffPlayer(&context, request, &response);
+        auto accepted = status.ok() && response.status() == SessionTransferStatus::Success;
+        if (!status.ok())
+            LOG(INFO) << "Failed to hand character " << request.characterid() << " off to zone " << zone.name << ": "
+                      << status.error_message();
+
+        accepted ? sent_++ : failed_++;
+        callback(accepted);
+    };
+    ASYNC(task)
+}
+
+/**
+ * Holds the data of a character that another zone has handed off to this one.
+ * @param id    The id of the character.
+ * @param data  The character data.
+ */
+void ZoneDirectory::accept(size_t id, CharacterData data)
+{
+    std::lock_guard lock{ mutex_ };
+    expire();
+
+    Arrival arrival;
+    arrival.data      = std::move(data);
+    arrival.expiresAt = std::chrono::steady_clock::now() + ttl_;
+    arrivals_.insert_or_assign(id, std::move(arrival));
+    received_++;
+}
+
+/**
+ * Claims the data of a character that was handed off to this zone.
+ * @param id    The id of the character.
+ * @return      The character data, or an empty optional if the character wasn't handed off, or has expired.
+ */
+std::optional<CharacterData> ZoneDirectory::claim(size_t id)
+{
+    std::lock_guard lock{ mutex_ };
+    expire();
+
+    auto pos = arrivals_.find(id);
+    if (pos == arrivals_.end())
+        return std::nullopt;
+
+    auto data = std::move(pos->second.data);
+    arrivals_.erase(pos);
+    return data;
+}
+
+/**
+ * Summarises the handoffs that this zone sent, and the ones it received.
+ * @return  The summary
+ */
+std::string ZoneDirectory::report() const
+{
+    std::stringstream stream;
+    stream << "Zone handoffs: " << sent_ << " sent, " << failed_ << " failed, " << received_ << " received.";
+    return stream.str();
+}
+
+/**
+ * Forgets the characters whose client didn't select them in time. This must be called while holding the mutex.
+ */
+void ZoneDirectory::expire()
+{
+    auto now = std::chrono::steady_clock::now();
+    std::erase_if(arrivals_, [&](auto& element) { return element.second.expiresAt <= now; });
+}
@@ -4,8 +4,11 @@
 #include <shaiya/game/model/item/GroundItem.hpp>
 #include <shaiya/game/model/map/Map.hpp>
 #include <shaiya/game/model/map/MapCell.hpp>
+#include <shaiya/game/model/map/SpatialQuery.hpp>
+#include <shaiya/game/scheduling/LoadController.hpp>
 #include <shaiya/game/service/GameWorldService.hpp>
 #include <shaiya/game/sync/ParallelClientSynchronizer.hpp>
+#include <shaiya/game/sync/SyncBudget.hpp>
 #include <shaiya/game/sync/task/CharacterSynchronizationTask.hpp>
 #include <shaiya/game/sync/task/MapSynchronizationTask.hpp>
 #include <shaiya/game/sync/task/MobSynchronizationTask.hpp>
@@ -15,6 +18,16 @@
 
 using namespace shaiya::game;
 
+/**
+ * Initialises this synchronizer.
+ * @param policy    The level-of-detail policy.
+ * @param load      The load controller, which may reduce the frequency of far entity updates.
+ */
+ParallelClientSynchronizer::ParallelClientSynchronizer(SyncPolicy policy, const LoadController& load)
+    : policy_(policy), load_(load)
+{
+}
+
 /**
  * Synchronizes the state of the clients with the stat of the server.
  * @param players   The vector containing the player characters.
@@ -24,9 +37,14 @@ using namespace shaiya::game;
 void ParallelClientSynchronizer::synchronize(std::vector<std::shared_ptr<Player>> players, const EntityContainer<Npc>& npcs,
                                              const EntityContainer<Mob>& mobs)
 {
+    // The policy for this tick, which updates far entities less frequently while the world is overloaded
+    auto policy = policy_;
+    policy.farInterval *= load_.syncIntervalScale();
+
     // Run the synchroniser for each character, in parallel.
-    std::for_each(std::execution::par_unseq, players.begin(), players.end(),
-                  [&](std::shared_ptr<Player>& character) { syncCharacter(*character); });
+    std::for_each(std::execution::par, players.begin(), players.end(), [&](const std::shared_ptr<Player>& character) {
+        syncCharacter(*character, policy);
+    });
 
     // Finalise the update sequence for each character.
     for (auto&& character: players)
@@ -49,34 +67,63 @@ void ParallelClientSynchronizer::synchronize(std::vector<std::shared_ptr<Player>
     for (auto&& npc: npcs)
         if (npc)
             npc->resetUpdateFlags();
+
+    tick_++;
 }
 
 /**
  * Synchronizes a character.
  * @param player     The character to synchronize
+ * @param policy     The level-of-detail policy for this tick.
  */
-void ParallelClientSynchronizer::syncCharacter(Player& player)
+void ParallelClientSynchronizer::syncCharacter(Player& player, const SyncPolicy& policy)
 {
     if (!player.active())
         return;
 
     // Prepare the synchronization tasks
+    SyncBudget budget(player, policy, tick_);
     MapSynchronizationTask mapTask(player);
-    CharacterSynchronizationTask charsTask(player);
-    NpcSynchronizationTask npcTask(player);
-    MobSynchronizationTask mobTask(player);
+    CharacterSynchronizationTask charsTask(player, budget);
+    NpcSynchronizationTask npcTask(player, budget);
+    MobSynchronizationTask mobTask(player, budget);
 
     // The vector of entities that are currently being observed
     auto& observed = player.observedEntities();
 
+    // The viewport of the character
+    auto& pos     = player.position();
+    auto viewport = SpatialQuery::viewport(pos);
+
+    // Test the observed entities against the viewport in a single batch, with buffers that are reused between the
+    // characters that are synchronized on the same thread
+    static thread_local std::vector<float> xs;
+    static thread_local std::vector<float> zs;
+    static thread_local std::vector<uint32_t> selected;
+    static thread_local std::vector<bool> inside;
+    xs.clear();
+    zs.clear();
+    for (auto&& entity: observed)
+    {
+        xs.push_back(entity->position().x());
+        zs.push_back(entity->position().z());
+    }
+    selected.resize(observed.size());
+    inside.assign(observed.size(), false);
+    auto count = viewport.select(xs.data(), zs.data(), observed.size(), selected.data());
+    for (size_t i = 0; i < count; i++)
+        inside[selected[i]] = true;
+
     // Loop over the currently observed entities
-    auto itr = observed.begin();
+    size_t index = 0;
+    auto itr     = observed.begin();
     while (itr != observed.end())
     {
         auto entity = *itr;  // The current observed entity
 
         // If the entity is not active, or this character can't observe them, remove them.
-        if (!entity->active() || !entity->observable(player))
+        auto visible = inside[index++] && entity->position().map() == pos.map();
+        if (!entity->active() || !visible)
         {
             if (entity->type() == EntityType::Player)
                 charsTask.removeCharacter(dynamic_cast<Player&>(*entity));
@@ -86,6 +133,7 @@ void ParallelClientSynchronizer::syncCharacter(Player& player)
                 npcTask.removeNpc(dynamic_cast<Npc&>(*entity));
             else if (entity->type() == EntityType::Mob)
                 mobTask.removeMob(dynamic_cast<Mob&>(*entity));
+            player.pendingMovement().erase(entity.get());
             itr = observed.erase(itr);
             continue;
         }
@@ -94,47 +142,43 @@ void ParallelClientSynchronizer::syncCharacter(Player& player)
     }
 
     // Get the neighbouring cells of the character.
-    auto& pos   = player.position();
     auto& world = player.world();
     auto map    = world.maps().forId(pos.map());
     auto cells  = map->getNeighbouringCells(pos);
 
-    // Loop through all the nearby cells
+    // Collect the entities in the nearby cells that are within the viewport of the character
+    std::vector<std::shared_ptr<Entity>> visible;
     for (auto&& cell: cells)
-    {
-        // Loop through the entities in each cell.
-        for (auto&& entity: cell->entities())
-        {
-            // If the entity is not yet active, do nothing
-            if (!entity->active())
-                continue;
+        cell->query(viewport, visible);
 
-            // Skip ourselves
-            if (&player == entity.get())
-                continue;
-
-            // If we can't see the other entity, skip them.
-            if (!entity->observable(player))
-                continue;
+    // Loop through the visible entities
+    for (auto&& entity: visible)
+    {
+        // If the entity is not yet active, do nothing
+        if (!entity->active())
+            continue;
 
-            // If the entity is already being observed, skip them
-            auto pred = [&](const std::shared_ptr<Entity>& other) { return other.get() == entity.get(); };
-            if (std::find_if(observed.begin(), observed.end(), pred) != observed.end())
-                continue;
+        // Skip ourselves
+        if (&player == entity.get())
+            continue;
 
-            // Add the entity to the list of observed entities
-            observed.push_back(entity);
+        // If the entity is already being observed, skip them
+        auto pred = [&](const std::shared_ptr<Entity>& other) { return other.get() == entity.get(); };
+        if (std::find_if(observed.begin(), observed.end(), pred) != observed.end())
+            continue;
 
-            // Inform the relevant task
-            if (entity->type() == EntityType::Player)
-                charsTask.addCharacter(dynamic_cast<Player&>(*entity));
-            else if (entity->type() == EntityType::Item)
-                mapTask.addItem(dynamic_cast<GroundItem&>(*entity));
-            else if (entity->type() == EntityType::Npc)
-                npcTask.addNpc(dynamic_cast<Npc&>(*entity));
-            else if (entity->type() == EntityType::Mob)
-                mobTask.addMob(dynamic_cast<Mob&>(*entity));
-        }
+        // Add the entity to the list of observed entities
+        observed.push_back(entity);
+
+        // Inform the relevant task
+        if (entity->type() == EntityType::Player)
+            charsTask.addCharacter(dynamic_cast<Player&>(*entity));
+        else if (entity->type() == EntityType::Item)
+            mapTask.addItem(dynamic_cast<GroundItem&>(*entity));
+        else if (entity->type() == EntityType::Npc)
+            npcTask.addNpc(dynamic_cast<Npc&>(*entity));
+        else if (entity->type() == EntityType::Mob)
+            mobTask.addMob(dynamic_cast<Mob&>(*entity));
     }
 
     // Synchronise the actively observed entities
@@ -142,4 +186,7 @@ void ParallelClientSynchronizer::syncCharacter(Player& player)
     charsTask.sync();
     npcTask.sync();
     mobTask.sync();
+
+    // Send the movement updates that fit in this tick's budget
+    budget.flush();
 }
@@ -0,0 +1,113 @@
+#include <shaiya/game/model/actor/player/Player.hpp>
+#include <shaiya/game/net/GameSession.hpp>
+#include <shaiya/game/sync/SyncBudget.hpp>
+#include <shaiya/game/sync/SyncPolicy.hpp>
+
+#include <algorithm>
+
+using namespace shaiya::game;
+
+/**
+ * The priority weight of a character's movement. Lower weights are sent first at the same distance.
+ */
+constexpr auto PLAYER_WEIGHT = 1.0f;
+
+/**
+ * The priority weight of a mob's movement.
+ */
+constexpr auto MOB_WEIGHT = 1.5f;
+
+/**
+ * The priority weight of any other entity's movement.
+ */
+constexpr auto DEFAULT_WEIGHT = 2.0f;
+
+/**
+ * Initialises the budget for a character.
+ * @param character The character being synchronized.
+ * @param policy    The synchronization policy.
+ * @param tick      The current tick.
+ */
+SyncBudget::SyncBudget(Player& character, const SyncPolicy& policy, size_t tick)
+    : character_(character), policy_(policy), tick_(tick)
+{
+    startBytes_ = character_.session().bytesWritten();
+}
+
+/**
+ * Checks if an entity has a movement update that was deferred from a previous tick.
+ * @param other The entity.
+ * @return      If the entity has a pending movement update.
+ */
+bool SyncBudget::hasPendingMovement(const Entity& other) const
+{
+    return character_.pendingMovement().contains(&other);
+}
+
+/**
+ * Submits a movement update for an entity.
+ * @param other     The entity that moved.
+ * @param length    The expected length of the movement packet, which decides if it fits in the budget.
+ * @param send      The function that sends the latest movement of the entity.
+ */
+void SyncBudget::submitMovement(const Entity& other, size_t length, std::function<void()> send)
+{
+    // If the entity moved again before its deferred update was sent, the previous state is never seen by the client.
+    if (hasPendingMovement(other) && other.hasUpdateFlag(UpdateFlag::Movement))
+        character_.session().recordDroppedUpdate();
+
+    // Far away entities are only updated every few ticks. The ticks are staggered by the entity id, so that the updates of
+    // a crowd are spread out evenly.
+    auto distance = character_.position().getDistance(other.position());
+    if (distance > policy_.nearDistance && policy_.farInterval > 1 && (tick_ + other.id()) % policy_.farInterval != 0)
+    {
+        defer(other);
+        return;
+    }
+
+    auto weight = DEFAULT_WEIGHT;
+    if (other.type() == EntityType::Player)
+        weight = PLAYER_WEIGHT;
+    else if (other.type() == EntityType::Mob)
+        weight = MOB_WEIGHT;
+
+    updates_.push_back(Update{ .priority = distance * weight, .entity = &other, .length = length, .send = std::move(send) });
+}
+
+/**
+ * Sends the submitted movement updates in order of priority, deferring any that exceed the byte budget.
+ */
+void SyncBudget::flush()
+{
+    std::stable_sort(updates_.begin(), updates_.end(), [](auto& a, auto& b) { return a.priority < b.priority; });
+
+    // The bytes already spent on updates that must always be sent
+    auto& session = character_.session();
+    auto spent    = session.bytesWritten() - startBytes_;
+
+    for (auto&& update: updates_)
+    {
+        if (policy_.byteBudget && spent + update.length > policy_.byteBudget)
+        {
+            defer(*update.entity);
+            continue;
+        }
+
+        // Charge the bytes that the update actually wrote, rather than the expected length of its packet
+        auto before = session.bytesWritten();
+        update.send();
+        spent += session.bytesWritten() - before;
+        character_.pendingMovement().erase(update.entity);
+    }
+    updates_.clear();
+}
+
+/**
+ * Defers the movement update of an entity to a later tick.
+ * @param other The entity.
+ */
+void SyncBudget::defer(const Entity& other)
+{
+    character_.pendingMovement().insert(&other);
+    character_.session().recordDeferredUpdate();
+}
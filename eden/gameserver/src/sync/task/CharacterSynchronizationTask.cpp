@@ -8,6 +8,7 @@
 #include <shaiya/game/model/EntityType.hpp>
 #include <shaiya/game/model/actor/player/Player.hpp>
 #include <shaiya/game/model/item/Item.hpp>
+#include <shaiya/game/sync/SyncBudget.hpp>
 #include <shaiya/game/sync/task/CharacterSynchronizationTask.hpp>
 
 using namespace shaiya::game;
@@ -16,8 +17,10 @@ using namespace shaiya::net;
 /**
  * Initialise the synchronization task.
  * @param character The character we're currently synchronizing.
+ * @param budget    The budget for the character's movement updates.
  */
-CharacterSynchronizationTask::CharacterSynchronizationTask(Player& character): character_(character)
+CharacterSynchronizationTask::CharacterSynchronizationTask(Player& character, SyncBudget& budget)
+    : character_(character), budget_(budget)
 {
 }
 
@@ -95,8 +98,9 @@ void CharacterSynchronizationTask::processUpdateFlags(const Player& other)
         updateChat(other);
 
     // Update movement for other characters (no reason to update for the current character).
-    if (other.hasUpdateFlag(UpdateFlag::Movement) && other.id() != character_.id())
-        updateMovement(other);
+    auto moved = other.hasUpdateFlag(UpdateFlag::Movement) || budget_.hasPendingMovement(other);
+    if (moved && other.id() != character_.id())
+        budget_.submitMovement(other, sizeof(CharacterMovementUpdate), [&] { updateMovement(other); });
 }
 
 /**
@@ -5,6 +5,7 @@
 #include <shaiya/game/model/actor/mob/Mob.hpp>
 #include <shaiya/game/model/actor/player/Player.hpp>
 #include <shaiya/game/net/GameSession.hpp>
+#include <shaiya/game/sync/SyncBudget.hpp>
 #include <shaiya/game/sync/task/MobSynchronizationTask.hpp>
 
 using namespace shaiya::game;
@@ -13,8 +14,10 @@ using namespace shaiya::net;
 /**
  * Initialise the synchronization task.
  * @param character The character we're currently synchronizing.
+ * @param budget    The budget for the character's movement updates.
  */
-MobSynchronizationTask::MobSynchronizationTask(Player& character): character_(character)
+MobSynchronizationTask::MobSynchronizationTask(Player& character, SyncBudget& budget)
+    : character_(character), budget_(budget)
 {
 }
 
@@ -66,8 +69,8 @@ void MobSynchronizationTask::removeMob(const Mob& other)
 void MobSynchronizationTask::processUpdateFlags(const Mob& other)
 {
     // Update movement
-    if (other.hasUpdateFlag(UpdateFlag::Movement))
-        updateMovement(other);
+    if (other.hasUpdateFlag(UpdateFlag::Movement) || budget_.hasPendingMovement(other))
+        budget_.submitMovement(other, sizeof(MobMovement), [&] { updateMovement(other); });
 }
 
 /**
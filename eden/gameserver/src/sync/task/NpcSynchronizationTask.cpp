@@ -5,6 +5,7 @@
 #include <shaiya/game/net/GameSession.hpp>
 #include <shaiya/game/model/actor/npc/Npc.hpp>
 #include <shaiya/game/model/actor/player/Player.hpp>
+#include <shaiya/game/sync/SyncBudget.hpp>
 #include <shaiya/game/sync/task/NpcSynchronizationTask.hpp>
 
 using namespace shaiya::game;
@@ -13,8 +14,10 @@ using namespace shaiya::net;
 /**
  * Initialise the synchronization task.
  * @param character The character we're currently synchronizing.
+ * @param budget    The budget for the character's movement updates.
  */
-NpcSynchronizationTask::NpcSynchronizationTask(Player& character): character_(character)
+NpcSynchronizationTask::NpcSynchronizationTask(Player& character, SyncBudget& budget)
+    : character_(character), budget_(budget)
 {
 }
 
@@ -72,8 +75,8 @@ void NpcSynchronizationTask::removeNpc(const Npc& other)
 void NpcSynchronizationTask::processUpdateFlags(const Npc& other)
 {
     // Update movement
-    if (other.hasUpdateFlag(UpdateFlag::Movement))
-        updateMovement(other);
+    if (other.hasUpdateFlag(UpdateFlag::Movement) || budget_.hasPendingMovement(other))
+        budget_.submitMovement(other, sizeof(NpcMovement), [&] { updateMovement(other); });
 }
 
 /**
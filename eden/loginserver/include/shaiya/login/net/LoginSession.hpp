@@ -9,6 +9,7 @@
 #include <array>
 #include <crypto++/aes.h>
 #include <crypto++/modes.h>
+#include <vector>
 
 namespace shaiya::net
 {
@@ -43,6 +44,14 @@ namespace shaiya::net
             return *this;
         }
 
+        /**
+         * Writes a pre-encoded packet to this session's socket. The packet is copied before it is encrypted, so the
+         * same encoded bytes can be shared by every session.
+         * @param packet    The encoded packet.
+         * @return          This session.
+         */
+        LoginSession& writeEncoded(const std::vector<char>& packet);
+
         /**
          * This gets executed when the login session is accepted and connected to the server. This is used
          * to request a login handshake from the client.
@@ -13,10 +13,12 @@ namespace shaiya::net
     public:
         /**
          * Initialises this login server to listen on a specific port.
-         * @param port  The port for the login server to listen on.
-         * @param ctx   The service context to provide to sessions.
+         * @param port      The port for the login server to listen on.
+         * @param ctx       The service context to provide to sessions.
+         * @param options   The options of the listening sockets.
          */
-        explicit LoginTcpServer(uint16_t port, shaiya::login::ServiceContext& ctx): TcpServer(port), ctx_(ctx)
+        LoginTcpServer(uint16_t port, shaiya::login::ServiceContext& ctx, ListenerOptions options = {})
+            : TcpServer(port, options), ctx_(ctx)
         {
         }
 
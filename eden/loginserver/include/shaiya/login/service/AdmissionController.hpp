@@ -0,0 +1,254 @@
+#pragma once
+#include <shaiya/common/util/Coroutine.hpp>
+#include <shaiya/common/util/LatencyHistogram.hpp>
+
+#include <boost/asio/steady_timer.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace shaiya::login
+{
+    /**
+     * The options of the login admission controller.
+     */
+    struct AdmissionOptions
+    {
+        /**
+         * The maximum number of logins that may be authenticated at once.
+         */
+        size_t maxInFlight{ 32 };
+
+        /**
+         * The maximum number of logins that may wait for admission.
+         */
+        size_t maxQueued{ 1024 };
+
+        /**
+         * The maximum number of logins from a single address that may wait for admission.
+         */
+        size_t maxQueuedPerAddress{ 8 };
+
+        /**
+         * The maximum time a login may wait for admission.
+         */
+        std::chrono::milliseconds queueTimeout{ 5000 };
+    };
+
+    /**
+     * Caps the number of logins that are authenticated at once, so a login storm doesn't pile onto the database. Logins
+     * above the cap wait in a queue for up to a timeout. Each address waits in its own FIFO queue, and admission takes
+     * turns between the addresses, so a single address with many clients can't starve everyone else.
+     */
+    class AdmissionController
+    {
+    public:
+        /**
+         * Admits a login while it is alive, and frees its slot when it is destroyed.
+         */
+        class Ticket
+        {
+        public:
+            /**
+             * Initialises a ticket that admits nothing.
+             */
+            Ticket() = default;
+
+            /**
+             * Initialises a ticket that holds a slot of a controller.
+             * @param controller    The controller.
+             */
+            explicit Ticket(AdmissionController* controller): controller_(controller)
+            {
+            }
+
+            /**
+             * Moves a ticket.
+             * @param other The ticket to move.
+             */
+            Ticket(Ticket&& other) noexcept: controller_(std::exchange(other.controller_, nullptr))
+            {
+            }
+
+            /**
+             * Frees the slot held by this ticket.
+             */
+            ~Ticket()
+            {
+                if (controller_)
+                    controller_->release();
+            }
+
+            Ticket(const Ticket&)            = delete;
+            Ticket& operator=(const Ticket&) = delete;
+            Ticket& operator=(Ticket&&)      = delete;
+
+            /**
+             * Checks if this ticket admits a login.
+             * @return  If the login was admitted.
+             */
+            explicit operator bool() const
+            {
+                return controller_ != nullptr;
+            }
+
+        private:
+            /**
+             * The controller that this ticket holds a slot of.
+             */
+            AdmissionController* controller_{ nullptr };
+        };
+
+        /**
+         * Initialises this controller.
+         * @param options   The admission options.
+         */
+        explicit AdmissionController(AdmissionOptions options);
+
+        /**
+         * Waits for a login to be admitted.
+         * @param address   The address of the client.
+         * @return          The ticket of the login, which admits nothing if the queue was full or the wait timed out.
+         */
+        boost::asio::awaitable<Ticket> admit(std::string address);
+
+        /**
+         * Gets the number of logins that are being authenticated.
+         * @return  The number of admitted logins.
+         */
+        [[nodiscard]] size_t inFlight() const
+        {
+            return inFlight_;
+        }
+
+        /**
+         * Gets the number of logins that are waiting for admission.
+         * @return  The queue depth.
+         */
+        [[nodiscard]] size_t queued() const
+        {
+            return queued_;
+        }
+
+        /**
+         * Gets the number of logins that were rejected because the queue was full.
+         * @return  The number of rejected logins.
+         */
+        [[nodiscard]] size_t rejected() const
+        {
+            return rejected_;
+        }
+
+        /**
+         * Gets the number of logins that timed out while waiting for admission.
+         * @return  The number of timed out logins.
+         */
+        [[nodiscard]] size_t timedOut() const
+        {
+            return timedOut_;
+        }
+
+        /**
+         * Gets the time that admitted logins spent waiting in the queue.
+         * @return  The wait times.
+         */
+        [[nodiscard]] const LatencyHistogram& waitTime() const
+        {
+            return waitTime_;
+        }
+
+        /**
+         * Summarises the admitted and waiting logins, the logins that were turned away, and the time spent waiting.
+         * @return  The summary
+         */
+        [[nodiscard]] std::string report() const;
+
+    private:
+        /**
+         * A login that is waiting for admission.
+         */
+        struct Waiter
+        {
+            /**
+             * Initialises a waiter.
+             * @param executor  The executor of the waiting coroutine.
+             */
+            explicit Waiter(const boost::asio::any_io_executor& executor): timer(executor)
+            {
+            }
+
+            /**
+             * The timer that the login waits on. It is cancelled when the login is admitted.
+             */
+            boost::asio::steady_timer timer;
+
+            /**
+             * If the login was admitted.
+             */
+            bool admitted{ false };
+        };
+
+        /**
+         * Frees the slot of an admitted login, and admits the next waiting login.
+         */
+        void release();
+
+        /**
+         * Removes a waiter from the queue of its address. This must be called while holding the mutex.
+         * @param address   The address of the waiter.
+         * @param waiter    The waiter.
+         */
+        void remove(const std::string& address, const std::shared_ptr<Waiter>& waiter);
+
+        /**
+         * The admission options.
+         */
+        AdmissionOptions options_;
+
+        /**
+         * The waiting logins, in a FIFO queue for each address.
+         */
+        std::unordered_map<std::string, std::deque<std::shared_ptr<Waiter>>> queues_;
+
+        /**
+         * The addresses that have waiting logins, in the order they take turns to be admitted.
+         */
+        std::deque<std::string> turns_;
+
+        /**
+         * The number of logins that are being authenticated.
+         */
+        std::atomic<size_t> inFlight_{ 0 };
+
+        /**
+         * The number of logins that are waiting for admission.
+         */
+        std::atomic<size_t> queued_{ 0 };
+
+        /**
+         * The number of logins that were rejected because the queue was full.
+         */
+        std::atomic<size_t> rejected_{ 0 };
+
+        /**
+         * The number of logins that timed out while waiting for admission.
+         */
+        std::atomic<size_t> timedOut_{ 0 };
+
+        /**
+         * The time that admitted logins spent waiting in the queue.
+         */
+        LatencyHistogram waitTime_;
+
+        /**
+         * The mutex used for locking access to the queues.
+         */
+        std::mutex mutex_;
+    };
+}
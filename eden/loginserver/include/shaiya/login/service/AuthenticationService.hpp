@@ -1,5 +1,9 @@
 #pragma once
-#include <shaiya/common/db/DatabaseService.hpp>
+#include <shaiya/common/db/AsyncDatabaseService.hpp>
+#include <shaiya/common/util/Coroutine.hpp>
+#include <shaiya/login/service/AdmissionController.hpp>
+
+#include <string>
 
 // Forward declaration of the login session
 namespace shaiya::net
@@ -10,29 +14,46 @@ namespace shaiya::net
 namespace shaiya::login
 {
     /**
-     * Handles the authentication of login requests.
+     * Handles the authentication of login requests. Logins are admitted by an admission controller before they query
+     * the database.
      */
     class AuthenticationService
     {
     public:
         /**
          * Initialises this service, and prepares the queries to use in the database.
-         * @param db    The database service.
+         * @param db        The asynchronous database service.
+         * @param admission The login admission options.
          */
-        explicit AuthenticationService(shaiya::database::DatabaseService& db);
+        AuthenticationService(shaiya::database::AsyncDatabaseService& db, AdmissionOptions admission);
 
         /**
-         * Processes a login request.
+         * Processes a login request. The credentials are checked without blocking the calling thread, and the response
+         * is sent once the database has replied.
          * @param session   The session that is sending the login request.
          * @param username  The provided username.
          * @param password  The provided password.
          */
-        void login(shaiya::net::LoginSession& session, const std::string& username, const std::string& password);
+        boost::asio::awaitable<void> login(shaiya::net::LoginSession& session, std::string username, std::string password);
+
+        /**
+         * Gets the login admission controller.
+         * @return  The admission controller.
+         */
+        [[nodiscard]] const AdmissionController& admission() const
+        {
+            return admission_;
+        }
 
     private:
         /**
-         * The database service instance.
+         * The asynchronous database service instance.
+         */
+        shaiya::database::AsyncDatabaseService& db_;
+
+        /**
+         * The login admission controller.
          */
-        shaiya::database::DatabaseService& db_;
+        AdmissionController admission_;
     };
 }
\ No newline at end of file
@@ -1,29 +1,45 @@
 #pragma once
+#include <shaiya/common/util/Coroutine.hpp>
+#include <shaiya/common/util/LatencyHistogram.hpp>
+
+#include <boost/asio/thread_pool.hpp>
 
 #include <crypto++/files.h>
 #include <crypto++/integer.h>
-#include <crypto++/osrng.h>
 #include <crypto++/rsa.h>
 
+#include <atomic>
+#include <optional>
+#include <string>
+
 namespace shaiya::login
 {
     /**
-     * Handles the loading of a PEM-encoded RSA certificate, and the decryption of RSA-encoded messages.
+     * Handles the loading of a PEM-encoded RSA certificate, and the decryption of RSA-encoded messages. Decryption runs
+     * on a dedicated, bounded pool of crypto threads, so a burst of logins can't starve the other blocking work.
      */
     class EncryptionService
     {
     public:
         /**
          * Initialises this encryption service.
+         * @param threads       The number of crypto threads.
+         * @param queueLimit    The maximum number of decryptions that may be queued or running at once.
+         */
+        EncryptionService(size_t threads, size_t queueLimit);
+
+        /**
+         * Stops the crypto threads.
          */
-        EncryptionService();
+        ~EncryptionService();
 
         /**
-         * Decrypts a message with the RSA private key.
+         * Decrypts a message with the RSA private key on the crypto pool.
          * @param encrypted The encrypted message.
-         * @return          The decrypted message.
+         * @return          The decrypted message, or an empty optional if the message isn't a valid ciphertext for the
+         *                  key, or the crypto pool is full.
          */
-        CryptoPP::Integer decrypt(CryptoPP::Integer& encrypted);
+        boost::asio::awaitable<std::optional<CryptoPP::Integer>> decrypt(CryptoPP::Integer encrypted);
 
         /**
          * Gets the RSA public key.
@@ -34,6 +50,48 @@ namespace shaiya::login
             return publicKey_;
         }
 
+        /**
+         * Gets the number of decryptions that are queued or running.
+         * @return  The number of decryptions.
+         */
+        [[nodiscard]] size_t queued() const
+        {
+            return queued_;
+        }
+
+        /**
+         * Gets the number of decryptions that were rejected, because the crypto pool was full.
+         * @return  The number of rejected decryptions.
+         */
+        [[nodiscard]] size_t rejected() const
+        {
+            return rejected_;
+        }
+
+        /**
+         * Gets the time that decryptions spent queued before a crypto thread picked them up.
+         * @return  The queue wait times.
+         */
+        [[nodiscard]] const LatencyHistogram& queueWait() const
+        {
+            return queueWait_;
+        }
+
+        /**
+         * Gets the time that decryptions spent on a crypto thread.
+         * @return  The decryption times.
+         */
+        [[nodiscard]] const LatencyHistogram& decryptTime() const
+        {
+            return decryptTime_;
+        }
+
+        /**
+         * Summarises the load on the crypto pool, and the time decryptions spent queued and running.
+         * @return  The summary
+         */
+        [[nodiscard]] std::string report() const;
+
     private:
         /**
          * Reads a PEM-encoded certificate.
@@ -52,8 +110,33 @@ namespace shaiya::login
         CryptoPP::RSA::PublicKey publicKey_;
 
         /**
-         * The random number generator to use when decrypting messages.
+         * The crypto threads.
+         */
+        boost::asio::thread_pool pool_;
+
+        /**
+         * The maximum number of decryptions that may be queued or running at once.
+         */
+        size_t queueLimit_{ 0 };
+
+        /**
+         * The number of decryptions that are queued or running.
+         */
+        std::atomic<size_t> queued_{ 0 };
+
+        /**
+         * The number of decryptions that were rejected, because the crypto pool was full.
+         */
+        std::atomic<size_t> rejected_{ 0 };
+
+        /**
+         * The time that decryptions spent queued before a crypto thread picked them up.
+         */
+        LatencyHistogram queueWait_;
+
+        /**
+         * The time that decryptions spent on a crypto thread.
          */
-        CryptoPP::AutoSeededRandomPool prng_;
+        LatencyHistogram decryptTime_;
     };
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #pragma once
+#include <shaiya/common/db/AsyncDatabaseService.hpp>
 #include <shaiya/common/db/DatabaseService.hpp>
 #include <shaiya/login/service/AuthenticationService.hpp>
 #include <shaiya/login/service/EncryptionService.hpp>
@@ -40,6 +41,11 @@ namespace shaiya::login
         AuthenticationService& getAuthService();
 
     private:
+        /**
+         * Logs a summary of the services.
+         */
+        void report();
+
         /**
          * The encryption service instance.
          */
@@ -59,5 +65,10 @@ namespace shaiya::login
          * The database service instance.
          */
         shaiya::database::DatabaseService* dbService_;
+
+        /**
+         * The asynchronous database service.
+         */
+        shaiya::database::AsyncDatabaseService* asyncDbService_;
     };
 }
\ No newline at end of file
@@ -3,6 +3,11 @@
 #include <shaiya/common/db/DatabaseService.hpp>
 #include <shaiya/login/service/world/WorldServer.hpp>
 
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <thread>
 #include <vector>
 
@@ -15,17 +20,18 @@ namespace shaiya::net
 namespace shaiya::login
 {
     /**
-     * A service that handles the query of world server statuses.
+     * A service that keeps track of the world servers' statuses, which are streamed from the world servers.
      */
     class WorldService
     {
     public:
         /**
          * Initialises this world service.
-         * @param db            The database service.
-         * @param worldApiPort  The port that the world api services are listening on.
+         * @param db                The database service.
+         * @param worldApiPort      The port that the world api services are listening on.
+         * @param transferOptions   The options of the session transfer requests.
          */
-        WorldService(shaiya::database::DatabaseService& db, uint16_t worldApiPort);
+        WorldService(shaiya::database::DatabaseService& db, uint16_t worldApiPort, TransferOptions transferOptions);
 
         /**
          * Gets a world with a specified id. Returns a null pointer in the event that no world
@@ -41,11 +47,58 @@ namespace shaiya::login
          */
         void sendWorldList(shaiya::net::LoginSession& session);
 
+        /**
+         * Summarises the transfer requests to each world server.
+         * @return  The summary
+         */
+        [[nodiscard]] std::string report() const;
+
     private:
         /**
-         * The vector of world servers to operate on.
+         * An encoded world list packet, which is immutable once it has been published.
+         */
+        struct WorldList
+        {
+            /**
+             * The version of the world list, which is incremented whenever it changes.
+             */
+            size_t version{ 0 };
+
+            /**
+             * The encoded packet.
+             */
+            std::vector<char> packet;
+        };
+
+        /**
+         * Encodes the world list from the current state of the world servers, and publishes it if it has changed.
+         */
+        void publishWorldList();
+
+        /**
+         * The world servers to operate on. A deque is used as the servers can't be moved once they are watched.
+         */
+        std::deque<WorldServer> worlds_;
+
+        /**
+         * The current world list, which is replaced as a whole whenever a world's status changes.
+         */
+        std::atomic<std::shared_ptr<const WorldList>> worldList_;
+
+        /**
+         * The mutex used for serializing the publishers of the world list.
+         */
+        std::mutex publishMutex_;
+
+        /**
+         * The completion queue that completes the session transfer requests.
+         */
+        grpc::CompletionQueue queue_;
+
+        /**
+         * The worker thread that drains the completion queue.
          */
-        std::vector<WorldServer> worlds_;
+        std::thread queueThread_;
 
         /**
          * If this service is operating.
@@ -53,8 +106,8 @@ namespace shaiya::login
         bool running_{ true };
 
         /**
-         * The worker thread for running ping requests.
+         * The worker threads that watch the status streams of the world servers.
          */
-        std::thread thread_;
+        std::vector<std::thread> threads_;
     };
 }
\ No newline at end of file
@@ -1,11 +1,20 @@
 #pragma once
 
+#include <shaiya/common/util/LatencyHistogram.hpp>
+
 #include <proto/GameApi.grpc.pb.h>
 
+#include <boost/asio/associated_executor.hpp>
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/post.hpp>
 #include <boost/format.hpp>
 
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <grpc++/grpc++.h>
+#include <memory>
 #include <string>
 
 namespace shaiya::net
@@ -16,7 +25,35 @@ namespace shaiya::net
 namespace shaiya::login
 {
     /**
-     * Represents an external world server.
+     * The result of a session transfer request.
+     */
+    enum class TransferResult
+    {
+        Accepted,         // The world server accepted the transfer.
+        AlreadyLoggedIn,  // The account is already logged in to the world server.
+        Busy,             // Too many transfers to the world server are already in flight.
+        Failed            // The world server couldn't be reached, or didn't respond before the deadline.
+    };
+
+    /**
+     * The options of the session transfer requests sent to the world servers.
+     */
+    struct TransferOptions
+    {
+        /**
+         * The time a world server has to respond to a transfer request.
+         */
+        std::chrono::milliseconds deadline{ 3000 };
+
+        /**
+         * The maximum number of transfer requests to a single world server that may be in flight at once.
+         */
+        size_t maxInFlight{ 64 };
+    };
+
+    /**
+     * Represents an external world server. The world's status is pushed by the world server over a stream, which is
+     * watched by the world service.
      */
     class WorldServer
     {
@@ -29,21 +66,49 @@ namespace shaiya::login
          * @param apiPort           The port that the world server's api is listening on.
          * @param revision          The client revision to accept.
          * @param playerCapacity    The maximum capacity of online players.
+         * @param queue             The completion queue that completes the transfer requests.
+         * @param options           The options of the transfer requests.
          */
-        WorldServer(uint8_t id, std::string name, std::string ipAddress, uint16_t apiPort, uint32_t revision, uint16_t playerCapacity);
+        WorldServer(uint8_t id, std::string name, std::string ipAddress, uint16_t apiPort, uint32_t revision,
+                    uint16_t playerCapacity, grpc::CompletionQueue& queue, TransferOptions options);
 
         /**
-         * Submits a transfer request for a given session. This is sent just before the session disconnects from
-         * this login server, and should connect to this world server.
+         * Submits a transfer request for a given session, without blocking. This is sent just before the session
+         * disconnects from this login server, and should connect to this world server.
          * @param session   The session that is being transferred
-         * @return          If the transfer request was accepted
+         * @param token     The completion token, such as a callback or boost::asio::use_awaitable
+         * @return          The result of initiating the operation, as determined by the completion token
+         */
+        template<typename CompletionToken>
+        auto submitTransferRequest(shaiya::net::LoginSession& session, CompletionToken&& token)
+        {
+            auto initiation = [this, &session](auto handler) {
+                // The result is delivered on the executor associated with the handler, such as the executor of the
+                // session's coroutine.
+                auto executor = boost::asio::get_associated_executor(handler);
+                auto shared   = std::make_shared<decltype(handler)>(std::move(handler));
+                auto complete = [shared, executor](TransferResult result) {
+                    boost::asio::post(executor, [shared, result]() { (*shared)(result); });
+                };
+                submit(session, std::move(complete));
+            };
+            return boost::asio::async_initiate<CompletionToken, void(TransferResult)>(initiation, token);
+        }
+
+        /**
+         * Completes a transfer request that has been finished by the completion queue.
+         * @param tag   The tag of the request.
+         * @param ok    If the request was finished successfully.
          */
-        bool submitTransferRequest(shaiya::net::LoginSession& session);
+        static void complete(void* tag, bool ok);
 
         /**
-         * Queries the remote world server, and updates our internal data.
+         * Watches the status stream of the remote world server, and updates our internal data whenever a status is
+         * pushed. This blocks until the stream ends, or goes silent for longer than the heartbeat allows, after which
+         * the world is considered offline.
+         * @param onChange  The function to call after the internal data has been updated.
          */
-        void update();
+        void watch(const std::function<void()>& onChange);
 
         /**
          * If this world server is online.
@@ -55,13 +120,10 @@ namespace shaiya::login
         }
 
         /**
-         * If the world is full with players, and no longer accepting new players.
+         * If the world is full with players, or saturated by its load, and no longer accepting new players.
          * @return  If the world is full.
          */
-        [[nodiscard]] bool isFull() const
-        {
-            return playerCount_ >= playerCapacity_;
-        }
+        [[nodiscard]] bool isFull() const;
 
         /**
          * Gets the world's id.
@@ -82,12 +144,14 @@ namespace shaiya::login
         }
 
         /**
-         * Gets the maximum number of players this server will hold.
+         * Gets the maximum number of players this server will hold. The capacity reported by the world server takes
+         * precedence over the configured one.
          * @return  The capacity of online players.
          */
         [[nodiscard]] uint16_t playerCapacity() const
         {
-            return playerCapacity_;
+            auto reported = reportedCapacity_.load();
+            return reported ? reported : playerCapacity_;
         }
 
         /**
@@ -117,7 +181,93 @@ namespace shaiya::login
             return ipAddressBytes_;
         }
 
+        /**
+         * Gets the number of transfer requests to this world that are in flight.
+         * @return  The number of in-flight requests.
+         */
+        [[nodiscard]] size_t transfersInFlight() const
+        {
+            return inFlight_;
+        }
+
+        /**
+         * Gets the number of transfer requests that failed, or didn't complete before their deadline.
+         * @return  The number of failed requests.
+         */
+        [[nodiscard]] size_t failedTransfers() const
+        {
+            return failed_;
+        }
+
+        /**
+         * Gets the latencies of the transfer requests to this world.
+         * @return  The transfer latencies.
+         */
+        [[nodiscard]] const LatencyHistogram& transferLatency() const
+        {
+            return transferLatency_;
+        }
+
+        /**
+         * Summarises the transfer requests to this world, and their latency.
+         * @return  The summary
+         */
+        [[nodiscard]] std::string report() const;
+
     private:
+        /**
+         * A transfer request that is in flight.
+         */
+        struct TransferCall
+        {
+            /**
+             * The world server that the request was sent to.
+             */
+            WorldServer* world{ nullptr };
+
+            /**
+             * The context of the request.
+             */
+            grpc::ClientContext context;
+
+            /**
+             * The request.
+             */
+            gameapi::SessionTransferRequest request;
+
+            /**
+             * The response.
+             */
+            gameapi::SessionTransferResponse response;
+
+            /**
+             * The status of the request.
+             */
+            grpc::Status status;
+
+            /**
+             * The reader of the response.
+             */
+            std::unique_ptr<grpc::ClientAsyncResponseReader<gameapi::SessionTransferResponse>> reader;
+
+            /**
+             * The time at which the request was sent.
+             */
+            std::chrono::steady_clock::time_point sentAt;
+
+            /**
+             * The function that delivers the result of the request.
+             */
+            std::function<void(TransferResult)> complete;
+        };
+
+        /**
+         * Sends a transfer request for a given session.
+         * @param session   The session that is being transferred.
+         * @param complete  The function that delivers the result of the request.
+         */
+        void submit(shaiya::net::LoginSession& session, std::function<void(TransferResult)> complete);
+
         /**
          * The id of this server.
          */
@@ -126,13 +276,23 @@ namespace shaiya::login
         /**
          * The number of currently online players.
          */
-        uint16_t playerCount_{ 0 };
+        std::atomic<uint16_t> playerCount_{ 0 };
 
         /**
          * The maximum number of players that can be connected to this world.
          */
         uint16_t playerCapacity_{ 0 };
 
+        /**
+         * The maximum number of players reported by the world server, or 0 if it didn't report one.
+         */
+        std::atomic<uint16_t> reportedCapacity_{ 0 };
+
+        /**
+         * The load level reported by the world server.
+         */
+        std::atomic<int32_t> loadLevel_{ 0 };
+
         /**
          * The client revision to accept
          */
@@ -141,7 +301,7 @@ namespace shaiya::login
         /**
          * If this world server is online.
          */
-        bool online_{ false };
+        std::atomic<bool> online_{ false };
 
         /**
          * The name of the server.
@@ -167,5 +327,30 @@ namespace shaiya::login
          * A client to this world's handshake service
          */
         std::unique_ptr<gameapi::GameService::Stub> client_;
+
+        /**
+         * The completion queue that completes the transfer requests.
+         */
+        grpc::CompletionQueue& queue_;
+
+        /**
+         * The options of the transfer requests.
+         */
+        TransferOptions options_;
+
+        /**
+         * The number of transfer requests that are in flight.
+         */
+        std::atomic<size_t> inFlight_{ 0 };
+
+        /**
+         * The number of transfer requests that failed, or didn't complete before their deadline.
+         */
+        std::atomic<size_t> failed_{ 0 };
+
+        /**
+         * The latencies of the transfer requests.
+         */
+        LatencyHistogram transferLatency_;
     };
 }
\ No newline at end of file
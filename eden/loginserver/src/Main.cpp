@@ -17,9 +17,15 @@ int main(int argc, char** argv)
     // The service context
     shaiya::login::ServiceContext ctx(config);
 
+    // The listener options. Login handling is almost stateless, so the server may run several acceptors in this
+    // process, or several processes may share the port.
+    shaiya::net::ListenerOptions listener;
+    listener.acceptors = config.get<size_t>("Network.Acceptors", listener.acceptors);
+    listener.reusePort = config.get<bool>("Network.ReusePort", listener.reusePort);
+
     // Initialise the tcp server to listen on a specific port with the service context.
     auto port = config.get<uint16_t>("Network.Port");
-    shaiya::net::LoginTcpServer server(port, ctx);
+    shaiya::net::LoginTcpServer server(port, ctx, listener);
     server.start();
     return 0;
 }
\ No newline at end of file
@@ -1,3 +1,4 @@
+#include <shaiya/common/crypto/SecureRandom.hpp>
 #include <shaiya/common/net/packet/PacketRegistry.hpp>
 #include <shaiya/common/net/packet/login/LoginHandshake.hpp>
 #include <shaiya/login/net/LoginSession.hpp>
@@ -13,8 +14,25 @@ LoginSession::LoginSession(boost::asio::io_context& ioContext, shaiya::login::Se
     : Session(ioContext), ctx_(ctx)
 {
     // Generate this session's identity
-    CryptoPP::AutoSeededRandomPool prng;
-    prng.GenerateBlock((byte*)identity_.data(), identity_.size());
+    shaiya::crypto::SecureRandom::the().GenerateBlock((byte*)identity_.data(), identity_.size());
+}
+
+/**
+ * Writes a pre-encoded packet to this session's socket. The packet is copied before it is encrypted, so the same
+ * encoded bytes can be shared by every session.
+ * @param packet    The encoded packet.
+ * @return          This session.
+ */
+LoginSession& LoginSession::writeEncoded(const std::vector<char>& packet)
+{
+    auto bytes = packet;
+    if (encryptionMode_ == EncryptionMode::Encrypted)
+    {
+        encryption_.processData((byte*)bytes.data(), bytes.size());
+    }
+
+    Session::write(bytes.data(), bytes.size());
+    return *this;
 }
 
 /**
@@ -9,13 +9,13 @@ using namespace shaiya::net;
  * @param session   The session instance.
  * @param request   The inbound login request.
  */
-void handleLogin(Session& session, const AccountLoginRequest& request)
+boost::asio::awaitable<void> handleLogin(Session& session, const AccountLoginRequest& request)
 {
     auto& login = dynamic_cast<LoginSession&>(session);
     auto& auth  = login.context().getAuthService();
 
     // Process the login request
-    auth.login(login, request.username.str(), request.password.str());
+    co_await auth.login(login, request.username.str(), request.password.str());
 }
 
 /**
@@ -24,5 +24,5 @@ void handleLogin(Session& session, const AccountLoginRequest& request)
 template<>
 void PacketRegistry::registerPacketHandler<LoginRequestOpcode>()
 {
-    registerHandler<LoginRequestOpcode, AccountLoginRequest>(&handleLogin, ExecutionType::Asynchronous);
+    registerCoroutineHandler<LoginRequestOpcode, AccountLoginRequest>(&handleLogin);
 }
\ No newline at end of file
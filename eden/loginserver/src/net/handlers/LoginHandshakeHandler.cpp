@@ -12,7 +12,7 @@ using namespace shaiya::net;
  * @param session   The session instance
  * @param request   The handshake response.
  */
-void handleHandshakeResponse(Session& session, const LoginHandshakeResponse& response)
+boost::asio::awaitable<void> handleHandshakeResponse(Session& session, const LoginHandshakeResponse& response)
 {
     using namespace CryptoPP;
     auto& login      = dynamic_cast<LoginSession&>(session);  // The login session instance.
@@ -22,11 +22,20 @@ void handleHandshakeResponse(Session& session, const LoginHandshakeResponse& res
     assert(response.messageLength == ModulusLength);
     Integer encrypted((byte*)response.message.data(), ModulusLength, CryptoPP::Integer::UNSIGNED, LITTLE_ENDIAN_ORDER);
 
-    // Decrypt the response
+    // Decrypt the response. The private-key operation is expensive, so it runs on the crypto pool. If the pool is
+    // full, or the response isn't a valid ciphertext, the session is disconnected rather than queued behind the burst.
+    auto d = co_await encryption.decrypt(std::move(encrypted));
+    if (!d)
+    {
+        LOG(INFO) << "Couldn't decrypt the handshake response, disconnecting session from " << login.remoteAddress()
+                  << ".";
+        login.close();
+        co_return;
+    }
+
     std::vector<byte> decrypted;
-    auto d = encryption.decrypt(encrypted);
-    decrypted.resize(d.MinEncodedSize(CryptoPP::Integer::SIGNED));
-    d.Encode(decrypted.data(), decrypted.size());
+    decrypted.resize(d->MinEncodedSize(CryptoPP::Integer::SIGNED));
+    d->Encode(decrypted.data(), decrypted.size());
     std::reverse(decrypted.begin(), decrypted.end());
 
     // Get the modulus
@@ -59,5 +68,5 @@ void handleHandshakeResponse(Session& session, const LoginHandshakeResponse& res
 template<>
 void PacketRegistry::registerPacketHandler<LoginHandshakeOpcode>()
 {
-    registerHandler<LoginHandshakeOpcode, LoginHandshakeResponse>(&handleHandshakeResponse, ExecutionType::Asynchronous);
+    registerCoroutineHandler<LoginHandshakeOpcode, LoginHandshakeResponse>(&handleHandshakeResponse);
 }
\ No newline at end of file
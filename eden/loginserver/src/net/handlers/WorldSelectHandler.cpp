@@ -2,6 +2,7 @@
 #include <shaiya/common/net/packet/login/WorldSelectPacket.hpp>
 #include <shaiya/login/net/LoginSession.hpp>
 
+using namespace shaiya::login;
 using namespace shaiya::net;
 
 /**
@@ -9,7 +10,7 @@ using namespace shaiya::net;
  * @param session   The session instance.
  * @param request   The inbound world select request.
  */
-void handleWorldSelect(Session& session, const WorldSelectRequest& request)
+boost::asio::awaitable<void> handleWorldSelect(Session& session, const WorldSelectRequest& request)
 {
     auto& login        = dynamic_cast<LoginSession&>(session);
     auto& worldService = login.context().getWorldService();
@@ -25,22 +26,26 @@ void handleWorldSelect(Session& session, const WorldSelectRequest& request)
     if (!login.userId())
     {
         session.close();
-        return;
+        co_return;
     }
 
     auto* world = worldService.getWorld(request.id);  // Get the world with the specified id.
     if (!world)
-        return sendError(WorldSelectStatus::CannotConnect);
+        co_return sendError(WorldSelectStatus::CannotConnect);
     if (!world->isOnline())
-        return sendError(WorldSelectStatus::CannotConnect);
+        co_return sendError(WorldSelectStatus::CannotConnect);
     if (world->isFull())
-        return sendError(WorldSelectStatus::ServerSaturated);
+        co_return sendError(WorldSelectStatus::ServerSaturated);
     if (request.version != world->revision())
-        return sendError(WorldSelectStatus::VersionDoesntMatch);
+        co_return sendError(WorldSelectStatus::VersionDoesntMatch);
 
-    // Request that the world accepts this session as a transfer
-    if (!world->submitTransferRequest(login))
-        return sendError(WorldSelectStatus::TryAgainLater);
+    // Request that the world accepts this session as a transfer. The session resumes once the world responds, or the
+    // request reaches its deadline.
+    auto result = co_await world->submitTransferRequest(login, boost::asio::use_awaitable);
+    if (result == TransferResult::Busy)
+        co_return sendError(WorldSelectStatus::ServerSaturated);
+    if (result != TransferResult::Accepted)
+        co_return sendError(WorldSelectStatus::TryAgainLater);
 
     // Send the successful connection response
     WorldSelectResponse response;
@@ -55,5 +60,5 @@ void handleWorldSelect(Session& session, const WorldSelectRequest& request)
 template<>
 void PacketRegistry::registerPacketHandler<WorldSelectOpcode>()
 {
-    registerHandler<WorldSelectOpcode, WorldSelectRequest>(&handleWorldSelect, ExecutionType::Asynchronous);
+    registerCoroutineHandler<WorldSelectOpcode, WorldSelectRequest>(&handleWorldSelect);
 }
\ No newline at end of file
@@ -0,0 +1,136 @@
+#include <shaiya/login/service/AdmissionController.hpp>
+
+#include <boost/asio/post.hpp>
+#include <boost/asio/redirect_error.hpp>
+
+#include <algorithm>
+#include <sstream>
+
+using namespace shaiya::login;
+
+/**
+ * Initialises this controller.
+ * @param options   The admission options.
+ */
+AdmissionController::AdmissionController(AdmissionOptions options): options_(options)
+{
+}
+
+/**
+ * Waits for a login to be admitted.
+ * @param address   The address of the client.
+ * @return          The ticket of the login, which admits nothing if the queue was full or the wait timed out.
+ */
+boost::asio::awaitable<AdmissionController::Ticket> AdmissionController::admit(std::string address)
+{
+    auto executor = co_await boost::asio::this_coro::executor;
+    auto waiter   = std::make_shared<Waiter>(executor);
+    {
+        std::lock_guard lock{ mutex_ };
+
+        // Admit the login straight away if there is a free slot, and nobody is waiting ahead of it
+        if (turns_.empty() && inFlight_ < options_.maxInFlight)
+        {
+            inFlight_++;
+            co_return Ticket(this);
+        }
+
+        // Reject the login if the queue, or the address's share of it, is full
+        auto& queue = queues_[address];
+        if (queued_ >= options_.maxQueued || queue.size() >= options_.maxQueuedPerAddress)
+        {
+            if (queue.empty())
+                queues_.erase(address);
+            rejected_++;
+            co_return Ticket();
+        }
+
+        if (queue.empty())
+            turns_.push_back(address);
+        queue.push_back(waiter);
+        queued_++;
+    }
+
+    // Wait until the login is admitted, or the timeout elapses
+    auto start = std::chrono::steady_clock::now();
+    boost::system::error_code ec;
+    waiter->timer.expires_after(options_.queueTimeout);
+    co_await waiter->timer.async_wait(boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+
+    std::lock_guard lock{ mutex_ };
+    if (waiter->admitted)
+    {
+        waitTime_.record(std::chrono::steady_clock::now() - start);
+        co_return Ticket(this);
+    }
+
+    remove(address, waiter);
+    timedOut_++;
+    co_return Ticket();
+}
+
+/**
+ * Summarises the admitted and waiting logins, the logins that were turned away, and the time spent waiting.
+ * @return  The summary
+ */
+std::string AdmissionController::report() const
+{
+    std::stringstream stream;
+    stream << "Login admission: " << inFlight_ << "/" << options_.maxInFlight << " in flight, " << queued_ << "/"
+           << options_.maxQueued << " queued, " << rejected_ << " rejected, " << timedOut_
+           << " timed out. Wait: " << waitTime_.describe() << ".";
+    return stream.str();
+}
+
+/**
+ * Frees the slot of an admitted login, and admits the next waiting login.
+ */
+void AdmissionController::release()
+{
+    std::lock_guard lock{ mutex_ };
+    if (turns_.empty())
+    {
+        inFlight_--;
+        return;
+    }
+
+    // Hand the slot to the front login of the address whose turn it is
+    auto address = std::move(turns_.front());
+    turns_.pop_front();
+
+    auto pos    = queues_.find(address);
+    auto waiter = std::move(pos->second.front());
+    pos->second.pop_front();
+    queued_--;
+
+    if (pos->second.empty())
+        queues_.erase(pos);
+    else
+        turns_.push_back(std::move(address));
+
+    // The timer may only be touched on its own executor
+    waiter->admitted = true;
+    boost::asio::post(waiter->timer.get_executor(), [waiter]() { waiter->timer.cancel(); });
+}
+
+/**
+ * Removes a waiter from the queue of its address. This must be called while holding the mutex.
+ * @param address   The address of the waiter.
+ * @param waiter    The waiter.
+ */
+void AdmissionController::remove(const std::string& address, const std::shared_ptr<Waiter>& waiter)
+{
+    auto pos = queues_.find(address);
+    if (pos == queues_.end())
+        return;
+
+    auto& queue = pos->second;
+    queue.erase(std::remove(queue.begin(), queue.end(), waiter), queue.end());
+    queued_--;
+
+    if (queue.empty())
+    {
+        queues_.erase(pos);
+        turns_.erase(std::remove(turns_.begin(), turns_.end(), address), turns_.end());
+    }
+}
@@ -13,21 +13,26 @@ constexpr auto LOGIN_AUTH_STATEMENT = "login_auth";
 
 /**
  * Initialises this service, and prepares the queries to use in the database.
- * @param db    The database service.
+ * @param db        The asynchronous database service.
+ * @param admission The login admission options.
  */
-AuthenticationService::AuthenticationService(shaiya::database::DatabaseService& db): db_(db)
+AuthenticationService::AuthenticationService(shaiya::database::AsyncDatabaseService& db, AdmissionOptions admission)
+    : db_(db), admission_(admission)
 {
     db.prepare(LOGIN_AUTH_STATEMENT, "SELECT userid, status, privilege FROM userdata.login($1, $2, $3);");
 }
 
 /**
- * Processes a login request.
+ * Processes a login request. The credentials are checked without blocking the calling thread, and the response
+ * is sent once the database has replied.
  * @param session   The session that is sending the login request.
  * @param username  The provided username.
  * @param password  The provided password.
  */
-void AuthenticationService::login(LoginSession& session, const std::string& username, const std::string& password)
+boost::asio::awaitable<void> AuthenticationService::login(LoginSession& session, std::string username, std::string password)
 {
+    using namespace shaiya::database;
+
     // A helper function used to send an error to a session.
     auto sendError = [&](LoginStatus status) {
         LoginResponse response;
@@ -35,26 +40,27 @@ void AuthenticationService::login(LoginSession& session, const std::string& user
         session.write(response, 3);
     };
 
+    // Wait for the login to be admitted. If the queue is full or the wait times out, the client is told to retry.
+    auto ticket = co_await admission_.admit(session.remoteAddress());
+    if (!ticket)
+        co_return sendError(LoginStatus::CannotConnect);
+
     // Attempt to submit a login request to the database
     try
     {
-        auto connection = db_.connection();
-        pqxx::work tx(*connection);
-
-        // Execute the login authentication function
-        auto rows = tx.exec_prepared(LOGIN_AUTH_STATEMENT, username, password, session.remoteAddress());
+        auto params = AsyncDatabaseService::params(username, password, session.remoteAddress());
+        auto rows   = co_await db_.execute(LOGIN_AUTH_STATEMENT, std::move(params), boost::asio::use_awaitable);
         if (rows.empty())
-            return sendError(LoginStatus::InvalidCredentials);
+            co_return sendError(LoginStatus::InvalidCredentials);
 
         // Get the data returned from the login function
-        auto row       = rows.front();
-        auto userId    = row["userid"].as<uint32_t>();
-        auto status    = static_cast<LoginStatus>(row["status"].as<uint32_t>());
-        auto privilege = row["privilege"].as<uint32_t>();
+        auto userId    = rows.get<uint32_t>(0, "userid");
+        auto status    = static_cast<LoginStatus>(rows.get<uint32_t>(0, "status"));
+        auto privilege = rows.get<uint32_t>(0, "privilege");
 
         // If the status wasn't successful, send it as an error
         if (status != LoginStatus::Success)
-            return sendError(status);
+            co_return sendError(status);
 
         // Send the world list
         auto& worldService = session.context().getWorldService();
@@ -73,6 +79,7 @@ void AuthenticationService::login(LoginSession& session, const std::string& user
     }
     catch (const std::exception& e)
     {
+        LOG(INFO) << "Exception occurred while processing login for " << session.remoteAddress() << ": " << e.what();
         sendError(LoginStatus::CannotConnect);  // Cannot connect to the login server
     }
-}
\ No newline at end of file
+}
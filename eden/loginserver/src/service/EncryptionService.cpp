@@ -1,3 +1,4 @@
+#include <shaiya/common/crypto/SecureRandom.hpp>
 #include <shaiya/login/service/EncryptionService.hpp>
 
 #include <boost/filesystem.hpp>
@@ -5,14 +6,17 @@
 
 #include <crypto++/base64.h>
 #include <numeric>
+#include <sstream>
 #include <vector>
 
 using namespace shaiya::login;
 
 /**
  * Initialises this encryption service.
+ * @param threads       The number of crypto threads.
+ * @param queueLimit    The maximum number of decryptions that may be queued or running at once.
  */
-EncryptionService::EncryptionService()
+EncryptionService::EncryptionService(size_t threads, size_t queueLimit): pool_(threads), queueLimit_(queueLimit)
 {
     using namespace CryptoPP;
 
@@ -53,16 +57,86 @@ void EncryptionService::readPemKey(const std::string& path)
     // Initialise the private key
     privateKey_.BERDecodePrivateKey(queue, false, 128);
 
+    // The private-key operation uses the Chinese remainder theorem, which needs the primes and the exponents modulo
+    // each prime. If the key doesn't carry them, they are derived from the private exponent once, here.
+    if (privateKey_.GetPrime1().IsZero() || privateKey_.GetModPrime1PrivateExponent().IsZero() ||
+        privateKey_.GetMultiplicativeInverseOfPrime2ModPrime1().IsZero())
+    {
+        LOG(INFO) << "The RSA private key has no CRT parameters, deriving them from the private exponent.";
+        privateKey_.Initialize(privateKey_.GetModulus(), privateKey_.GetPublicExponent(),
+                               privateKey_.GetPrivateExponent());
+    }
+
+    if (!privateKey_.Validate(shaiya::crypto::SecureRandom::the(), 1))
+        LOG(ERROR) << "The RSA private key failed validation.";
+
     // Initialise public key
     publicKey_.Initialize(privateKey_.GetModulus(), privateKey_.GetPublicExponent());
 }
 
 /**
- * Decrypts a message with the RSA private key.
+ * Stops the crypto threads.
+ */
+EncryptionService::~EncryptionService()
+{
+    pool_.join();
+}
+
+/**
+ * Summarises the load on the crypto pool, and the time decryptions spent queued and running.
+ * @return  The summary
+ */
+std::string EncryptionService::report() const
+{
+    std::stringstream stream;
+    stream << "Crypto pool: " << queued_ << "/" << queueLimit_ << " queued, " << rejected_
+           << " rejected. Queue wait: " << queueWait_.describe() << ". Decryption: " << decryptTime_.describe() << ".";
+    return stream.str();
+}
+
+/**
+ * Decrypts a message with the RSA private key on the crypto pool.
  * @param encrypted The encrypted message.
- * @return          The decrypted message.
+ * @return          The decrypted message, or an empty optional if the message isn't a valid ciphertext for the key, or
+ *                  the crypto pool is full.
  */
-CryptoPP::Integer EncryptionService::decrypt(CryptoPP::Integer& encrypted)
+boost::asio::awaitable<std::optional<CryptoPP::Integer>> EncryptionService::decrypt(CryptoPP::Integer encrypted)
 {
-    return privateKey_.CalculateInverse(prng_, encrypted);
+    using namespace std::chrono;
+
+    // A ciphertext must be below the modulus, and the private-key operation throws for one that isn't
+    if (encrypted.IsNegative() || encrypted >= privateKey_.GetModulus())
+        co_return std::nullopt;
+
+    // Shed the decryption if the pool is already full
+    if (++queued_ > queueLimit_)
+    {
+        queued_--;
+        rejected_++;
+        co_return std::nullopt;
+    }
+
+    // The private key is read-only, and each crypto thread blinds the operation with its own generator
+    auto queuedAt = steady_clock::now();
+    std::optional<CryptoPP::Integer> decrypted;
+    try
+    {
+        decrypted = co_await shaiya::offload(pool_, [&]() {
+            auto start = steady_clock::now();
+            queueWait_.record(start - queuedAt);
+
+            auto result = privateKey_.CalculateInverse(shaiya::crypto::SecureRandom::the(), encrypted);
+            decryptTime_.record(steady_clock::now() - start);
+            return result;
+        });
+    }
+    catch (...)
+    {
+        // The decryption no longer occupies the pool, even though it failed
+        queued_--;
+        throw;
+    }
+
+    queued_--;
+    co_return decrypted;
 }
\ No newline at end of file
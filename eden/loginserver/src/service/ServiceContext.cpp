@@ -1,6 +1,10 @@
 #include <shaiya/login/service/ServiceContext.hpp>
 
+#include <glog/logging.h>
+
 #include <cassert>
+#include <chrono>
+#include <thread>
 
 using namespace shaiya::login;
 
@@ -16,14 +20,53 @@ ServiceContext::ServiceContext(boost::property_tree::ptree& config)
     auto dbPass = config.get<std::string>("Database.Pass");
     auto dbName = config.get<std::string>("Database.Database");
 
+    // The database connection pool options
+    shaiya::database::PoolOptions pool;
+    pool.minConnections  = config.get<size_t>("Database.MinConnections", pool.minConnections);
+    pool.maxConnections  = config.get<size_t>("Database.MaxConnections", pool.maxConnections);
+    pool.checkoutTimeout = std::chrono::milliseconds(config.get<size_t>("Database.CheckoutTimeout", 5000));
+
+    // The number of connections used for non-blocking queries
+    auto asyncConnections = config.get<size_t>("Database.AsyncConnections", 4);
+    auto queryTimeout     = std::chrono::milliseconds(config.get<size_t>("Database.QueryTimeout", 10000));
+
+    // The login admission options
+    AdmissionOptions admission;
+    admission.maxInFlight         = config.get<size_t>("Login.MaxInFlight", admission.maxInFlight);
+    admission.maxQueued           = config.get<size_t>("Login.MaxQueued", admission.maxQueued);
+    admission.maxQueuedPerAddress = config.get<size_t>("Login.MaxQueuedPerAddress", admission.maxQueuedPerAddress);
+    admission.queueTimeout        = std::chrono::milliseconds(config.get<size_t>("Login.QueueTimeout", 5000));
+
+    // The crypto pool options
+    auto cryptoThreads    = config.get<size_t>("Crypto.Threads", 2);
+    auto cryptoQueueLimit = config.get<size_t>("Crypto.QueueLimit", 256);
+
     // The world api port
     auto worldApiPort = config.get<uint16_t>("Network.WorldApiPort");
 
+    // The session transfer options
+    TransferOptions transfer;
+    transfer.deadline    = std::chrono::milliseconds(config.get<size_t>("Network.TransferDeadline", 3000));
+    transfer.maxInFlight = config.get<size_t>("Network.TransfersInFlight", transfer.maxInFlight);
+
     // Initialise the database service
-    dbService_         = new shaiya::database::DatabaseService(dbHost, dbName, dbUser, dbPass);
-    encryptionService_ = new EncryptionService();
-    authService_       = new AuthenticationService(*dbService_);
-    worldService_      = new WorldService(*dbService_, worldApiPort);
+    dbService_         = new shaiya::database::DatabaseService(dbHost, dbName, dbUser, dbPass, pool);
+    asyncDbService_    = new shaiya::database::AsyncDatabaseService(dbHost, dbName, dbUser, dbPass, asyncConnections,
+                                                                    queryTimeout);
+    encryptionService_ = new EncryptionService(cryptoThreads, cryptoQueueLimit);
+    authService_       = new AuthenticationService(*asyncDbService_, admission);
+    worldService_      = new WorldService(*dbService_, worldApiPort, transfer);
+
+    // Periodically log a summary of the services
+    auto reportInterval = std::chrono::milliseconds(config.get<size_t>("Login.ReportInterval", 60000));
+    std::thread reportThread([this, reportInterval] {
+        while (true)
+        {
+            std::this_thread::sleep_for(reportInterval);
+            report();
+        }
+    });
+    reportThread.detach();
 }
 
 /**
@@ -54,4 +97,15 @@ AuthenticationService& ServiceContext::getAuthService()
 {
     assert(authService_);
     return *authService_;
+}
+
+/**
+ * Logs a summary of the services.
+ */
+void ServiceContext::report()
+{
+    LOG(INFO) << dbService_->report();
+    LOG(INFO) << worldService_->report();
+    LOG(INFO) << encryptionService_->report();
+    LOG(INFO) << authService_->admission().report();
 }
\ No newline at end of file
@@ -2,26 +2,30 @@
 #include <shaiya/login/net/LoginSession.hpp>
 
 #include <chrono>
+#include <cstring>
+#include <limits>
+#include <sstream>
 #include <thread>
 
 using namespace shaiya::login;
 
 /**
- * The maximum number of worlds to display on the world list.
+ * The maximum number of worlds to display on the world list, as the count is encoded in a single byte.
  */
-constexpr size_t WorldListCapacity = 5;
+constexpr size_t WorldListCapacity = std::numeric_limits<uint8_t>::max();
 
 /**
- * The interval between world server pings.
+ * The delay before watching a world server's status stream again, after it ended.
  */
-constexpr auto PingInterval = 10;
+constexpr auto ReconnectDelay = std::chrono::seconds(1);
 
 /**
  * Initialises this world service.
- * @param db            The database service.
- * @param worldApiPort  The port that the world api services are listening on.
+ * @param db                The database service.
+ * @param worldApiPort      The port that the world api services are listening on.
+ * @param transferOptions   The options of the session transfer requests.
  */
-WorldService::WorldService(shaiya::database::DatabaseService& db, uint16_t worldApiPort)
+WorldService::WorldService(shaiya::database::DatabaseService& db, uint16_t worldApiPort, TransferOptions transferOptions)
 {
     // Get the world definitions from the database
     auto connection = db.connection();
@@ -37,19 +41,31 @@ WorldService::WorldService(shaiya::database::DatabaseService& db, uint16_t world
         auto name      = row["name"].as<std::string>();
         auto ipAddress = row["ipaddress"].as<std::string>();
 
-        worlds_.emplace_back(id, name, ipAddress, worldApiPort, version, capacity);
+        worlds_.emplace_back(id, name, ipAddress, worldApiPort, version, capacity, queue_, transferOptions);
     }
+    publishWorldList();
 
-    // Start a thread to periodically update the world servers' data.
-    thread_ = std::thread([this] {
-        while (running_)
-        {
-            for (auto&& world: worlds_)
-                world.update();
-            std::this_thread::sleep_for(std::chrono::seconds(PingInterval));
-        }
+    // Start a thread to complete the session transfer requests, so a slow world server never blocks a session.
+    queueThread_ = std::thread([this] {
+        void* tag = nullptr;
+        bool ok   = false;
+        while (queue_.Next(&tag, &ok))
+            WorldServer::complete(tag, ok);
     });
-    thread_.detach();
+    queueThread_.detach();
+
+    // Start a thread for each world server, which watches the statuses that it pushes.
+    for (auto&& world: worlds_)
+    {
+        auto& thread = threads_.emplace_back([this, &world] {
+            while (running_)
+            {
+                world.watch([this] { publishWorldList(); });
+                std::this_thread::sleep_for(ReconnectDelay);
+            }
+        });
+        thread.detach();
+    }
 }
 
 /**
@@ -73,17 +89,43 @@ WorldServer* WorldService::getWorld(uint8_t id)
  * @param session   The session.
  */
 void WorldService::sendWorldList(shaiya::net::LoginSession& session)
+{
+    auto worldList = worldList_.load();
+    session.writeEncoded(worldList->packet);
+}
+
+/**
+ * Summarises the transfer requests to each world server.
+ * @return  The summary
+ */
+std::string WorldService::report() const
+{
+    std::stringstream stream;
+    for (auto&& world: worlds_)
+        stream << (stream.tellp() > 0 ? " " : "") << world.report();
+    return stream.str();
+}
+
+/**
+ * Encodes the world list from the current state of the world servers, and publishes it if it has changed.
+ */
+void WorldService::publishWorldList()
 {
     using namespace shaiya::net;
-    WorldListPacket<WorldListCapacity> worldList;  // The world list packet
-    worldList.count = worlds_.size();
+    std::lock_guard lock{ publishMutex_ };
 
-    // Loop over the worlds
-    for (auto i = 0; i < std::min(WorldListCapacity, worlds_.size()); i++)
+    // The number of worlds to list
+    WorldListHeader header;
+    header.count = std::min(WorldListCapacity, worlds_.size());
+
+    // Encode the header, followed by an entry for each world
+    std::vector<char> packet(sizeof(header) + header.count * sizeof(WorldListEntry));
+    std::memcpy(packet.data(), &header, sizeof(header));
+    for (size_t i = 0; i < header.count; i++)
     {
         auto& world = worlds_.at(i);
-        auto& entry = worldList.servers.at(i);
 
+        WorldListEntry entry;
         entry.id             = world.getId();
         entry.name           = world.getName();
         entry.playerCount    = world.playerCount();
@@ -91,8 +133,17 @@ void WorldService::sendWorldList(shaiya::net::LoginSession& session)
 
         if (world.isOnline())
             entry.status = WorldStatus::Normal;
+
+        std::memcpy(packet.data() + sizeof(header) + i * sizeof(entry), &entry, sizeof(entry));
     }
 
-    // Send the world list to the session
-    session.write(worldList, 3 + (worldList.count * sizeof(WorldListEntry)));
-}
\ No newline at end of file
+    // Only publish a new version if the list has changed
+    auto current = worldList_.load();
+    if (current && current->packet == packet)
+        return;
+
+    auto next     = std::make_shared<WorldList>();
+    next->version = current ? current->version + 1 : 1;
+    next->packet  = std::move(packet);
+    worldList_.store(std::move(next));
+}
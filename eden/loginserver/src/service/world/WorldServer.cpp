@@ -1,8 +1,12 @@
 #include <shaiya/login/net/LoginSession.hpp>
 
 #include <boost/algorithm/string.hpp>
+#include <glog/logging.h>
 
+#include <condition_variable>
+#include <mutex>
 #include <sstream>
+#include <thread>
 #include <vector>
 
 using namespace shaiya::login;
@@ -12,6 +16,18 @@ using namespace shaiya::login;
  */
 constexpr auto MaxReconnectBackoff = 5000;
 
+/**
+ * The load level at which a world is saturated, and no longer accepts new players. This is the level at which the
+ * world starts capping the number of packets it processes per session.
+ */
+constexpr auto SaturatedLoadLevel = 3;
+
+/**
+ * The time the status stream may go without a message before the world is considered offline. The world server pushes
+ * a heartbeat every 10 seconds, so this allows for one missed heartbeat.
+ */
+constexpr auto StatusTimeout = std::chrono::seconds(20);
+
 /**
  * Initialises a representation of a remote world server.
  * @param id                The id of the server.
@@ -20,10 +36,13 @@ constexpr auto MaxReconnectBackoff = 5000;
  * @param apiPort           The port that the world server's api is listening on.
  * @param revision          The client revision to accept.
  * @param playerCapacity    The maximum capacity of online players.
+ * @param queue             The completion queue that completes the transfer requests.
+ * @param options           The options of the transfer requests.
  */
 WorldServer::WorldServer(uint8_t id, std::string name, std::string ipAddress, uint16_t apiPort, uint32_t revision,
-                         uint16_t playerCapacity)
-    : id_(id), name_(std::move(name)), ipAddress_(std::move(ipAddress)), revision_(revision), playerCapacity_(playerCapacity)
+                         uint16_t playerCapacity, grpc::CompletionQueue& queue, TransferOptions options)
+    : id_(id), name_(std::move(name)), ipAddress_(std::move(ipAddress)), revision_(revision), playerCapacity_(playerCapacity),
+      queue_(queue), options_(options)
 {
     // The individual bytes of the ip address string
     std::vector<std::string> bytes;
@@ -49,17 +68,25 @@ WorldServer::WorldServer(uint8_t id, std::string name, std::string ipAddress, ui
 }
 
 /**
- * Submits a transfer request for a given session. This is sent just before the session disconnects from
- * this login server, and should connect to this world server.
- * @param session   The session that is being transferred
- * @return          If the transfer request was accepted
+ * Sends a transfer request for a given session.
+ * @param session   The session that is being transferred.
+ * @param complete  The function that delivers the result of the request.
  */
-bool WorldServer::submitTransferRequest(shaiya::net::LoginSession& session)
+void WorldServer::submit(shaiya::net::LoginSession& session, std::function<void(TransferResult)> complete)
 {
-    using namespace grpc;
-    ClientContext context;
-    gameapi::SessionTransferRequest request;
-    gameapi::SessionTransferResponse response;
+    // Don't queue up behind a world server that isn't keeping up
+    if (++inFlight_ > options_.maxInFlight)
+    {
+        inFlight_--;
+        complete(TransferResult::Busy);
+        return;
+    }
+
+    auto call      = std::make_unique<TransferCall>();
+    call->world    = this;
+    call->sentAt   = std::chrono::steady_clock::now();
+    call->complete = std::move(complete);
+    call->context.set_deadline(std::chrono::system_clock::now() + options_.deadline);
 
     // The session's details
     auto identity  = session.identity();
@@ -68,35 +95,129 @@ bool WorldServer::submitTransferRequest(shaiya::net::LoginSession& session)
     auto ipAddress = session.remoteAddress();
 
     // Build the request
+    auto& request = call->request;
     request.set_userid(session.userId());
     request.set_identity(identity.data(), identity.size());
     request.set_ipaddress(ipAddress);
     request.set_key(aesKey.data(), aesKey.size());
     request.set_iv(aesIv.data(), aesIv.size());
 
-    // Send the request and return the response
-    auto status = client_->SubmitSessionTransfer(&context, request, &response);
-    return status.ok() && response.status() == gameapi::SessionTransferStatus::Success;
+    // Send the request, which is completed by the completion queue
+    call->reader = client_->PrepareAsyncSubmitSessionTransfer(&call->context, request, &queue_);
+    call->reader->StartCall();
+
+    auto* tag = call.release();
+    tag->reader->Finish(&tag->response, &tag->status, tag);
+}
+
+/**
+ * Completes a transfer request that has been finished by the completion queue.
+ * @param tag   The tag of the request.
+ * @param ok    If the request was finished successfully.
+ */
+void WorldServer::complete(void* tag, bool ok)
+{
+    std::unique_ptr<TransferCall> call(static_cast<TransferCall*>(tag));
+    auto& world = *call->world;
+    world.inFlight_--;
+    world.transferLatency_.record(std::chrono::steady_clock::now() - call->sentAt);
+
+    if (!ok || !call->status.ok())
+    {
+        world.failed_++;
+        LOG(INFO) << "Transfer request to world " << static_cast<int>(world.id_) << " failed: "
+                  << call->status.error_message();
+        call->complete(TransferResult::Failed);
+        return;
+    }
+
+    auto status = call->response.status();
+    call->complete(status == gameapi::SessionTransferStatus::Success ? TransferResult::Accepted
+                                                                      : TransferResult::AlreadyLoggedIn);
 }
 
 /**
- * Queries the remote world server, and updates our internal data.
+ * Watches the status stream of the remote world server, and updates our internal data whenever a status is pushed.
+ * This blocks until the stream ends, or goes silent for longer than the heartbeat allows, after which the world is
+ * considered offline.
+ * @param onChange  The function to call after the internal data has been updated.
  */
-void WorldServer::update()
+void WorldServer::watch(const std::function<void()>& onChange)
 {
     using namespace grpc;
+    using namespace std::chrono;
     ClientContext context;
     gameapi::Void empty;
     gameapi::WorldStatus worldStatus;
 
-    auto status = client_->GetWorldStatus(&context, empty, &worldStatus);
-    if (!status.ok())
+    // A world that hangs, or whose connection silently drops, would otherwise block the read forever, and be shown as
+    // online. The stream is cancelled if it goes silent for too long.
+    std::mutex mutex;
+    std::condition_variable condition;
+    auto lastRead = steady_clock::now();
+    auto finished = false;
+    std::thread watchdog([&]() {
+        std::unique_lock lock{ mutex };
+        while (!finished)
+        {
+            if (condition.wait_until(lock, lastRead + StatusTimeout, [&] { return finished; }))
+                return;
+            if (steady_clock::now() - lastRead < StatusTimeout)
+                continue;
+
+            LOG(INFO) << "World " << static_cast<int>(id_) << " hasn't sent a status in "
+                      << duration_cast<seconds>(StatusTimeout).count() << "s, considering it offline.";
+            context.TryCancel();
+            return;
+        }
+    });
+
+    auto reader = client_->StreamWorldStatus(&context, empty);
+    while (reader->Read(&worldStatus))
     {
-        online_      = false;
-        playerCount_ = 0;
-        return;
+        {
+            std::lock_guard lock{ mutex };
+            lastRead = steady_clock::now();
+        }
+
+        online_           = true;
+        playerCount_      = worldStatus.players();
+        reportedCapacity_ = worldStatus.capacity();
+        loadLevel_        = worldStatus.loadlevel();
+        onChange();
     }
+    reader->Finish();
+
+    {
+        std::lock_guard lock{ mutex };
+        finished = true;
+    }
+    condition.notify_all();
+    watchdog.join();
+
+    online_      = false;
+    playerCount_ = 0;
+    loadLevel_   = 0;
+    onChange();
+}
 
-    online_      = true;
-    playerCount_ = worldStatus.players();
-}
\ No newline at end of file
+/**
+ * Summarises the transfer requests to this world, and their latency.
+ * @return  The summary
+ */
+std::string WorldServer::report() const
+{
+    std::stringstream stream;
+    stream << "World " << static_cast<int>(id_) << " transfers: " << inFlight_ << " in flight, " << failed_
+           << " failed. Latency: " << transferLatency_.describe() << ".";
+    return stream.str();
+}
+
+/**
+ * If the world is full with players, or saturated by its load, and no longer accepting new players.
+ * @return  If the world is full.
+ */
+bool WorldServer::isFull() const
+{
+    return playerCount_ >= playerCapacity() || loadLevel_ >= SaturatedLoadLevel;
+}
@@ -0,0 +1,167 @@
+#include <shaiya/common/util/Prng.hpp>
+#include <shaiya/game/model/Position.hpp>
+#include <shaiya/game/model/map/index/GridSpatialIndex.hpp>
+#include <shaiya/game/model/map/index/SparseSpatialIndex.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+#include <boost/range/iterator_range.hpp>
+#include <glog/logging.h>
+
+#include <chrono>
+#include <iostream>
+#include <yaml-cpp/yaml.h>
+
+using namespace shaiya::game;
+
+/**
+ * Loads the positions of the npc and mob spawns of a map.
+ * @param directory The map directory.
+ * @param map       The map id.
+ * @return          The spawn positions.
+ */
+std::vector<Position> loadSpawns(const boost::filesystem::path& directory, uint16_t map);
+
+/**
+ * Benchmarks a spatial index, by populating it with the spawn positions and querying the neighbourhood of each spawn.
+ * @param name      The name of the index.
+ * @param index     The index.
+ * @param positions The spawn positions.
+ * @param queries   The number of neighbourhood queries to perform.
+ */
+void benchmark(const std::string& name, SpatialIndex& index, const std::vector<Position>& positions, size_t queries);
+
+/**
+ * The entry point for the spatial index benchmark.
+ * @param argc  The number of command-line arguments.
+ * @param argv  The command-line values.
+ * @return      The status code.
+ */
+int main(int argc, char** argv)
+{
+    using namespace boost::filesystem;
+    if (argc < 3)
+    {
+        LOG(ERROR) << "Please provide the number of queries, and the path to at least one map directory.";
+        return 1;
+    }
+
+    auto queries = std::stoul(argv[1]);
+    for (auto i = 2; i < argc; i++)
+    {
+        path directory(argv[i]);
+        auto metadata = YAML::LoadFile((directory / "map.yaml").string());
+        auto id       = metadata["id"].as<uint16_t>();
+        auto size     = metadata["size"].as<size_t>();
+
+        auto positions = loadSpawns(directory, id);
+        std::cout << boost::format("%1% (id %2%, size %3%, %4% spawns)") % metadata["name"].as<std::string>("") % id %
+                         size % positions.size()
+                  << std::endl;
+
+        if (positions.empty())
+            continue;
+
+        GridSpatialIndex grid(size);
+        benchmark("grid", grid, positions, queries);
+
+        SparseSpatialIndex sparse(size);
+        benchmark("sparse", sparse, positions, queries);
+    }
+    return 0;
+}
+
+/**
+ * Loads the positions of the npc and mob spawns of a map.
+ * @param directory The map directory.
+ * @param map       The map id.
+ * @return          The spawn positions.
+ */
+std::vector<Position> loadSpawns(const boost::filesystem::path& directory, uint16_t map)
+{
+    using namespace boost::filesystem;
+    std::vector<Position> positions;
+
+    // Gets the yaml files in a subdirectory of the map
+    auto files = [&](const std::string& name) {
+        std::vector<path> paths;
+        if (!exists(directory / name))
+            return paths;
+        for (auto& file: boost::make_iterator_range(recursive_directory_iterator(directory / name), {}))
+            if (is_regular_file(file) && file.path().extension() == ".yaml")
+                paths.push_back(file.path());
+        return paths;
+    };
+
+    // Npcs spawn at fixed positions
+    for (auto&& file: files("npcs"))
+    {
+        for (auto&& spawn: YAML::LoadFile(file.string())["npcs"])
+        {
+            for (auto&& position: spawn["npc"]["positions"])
+            {
+                auto x = position["x"].as<float>();
+                auto y = position["y"].as<float>();
+                auto z = position["z"].as<float>();
+                positions.emplace_back(map, x, y, z);
+            }
+        }
+    }
+
+    // Mobs spawn at a random point in their spawn area
+    auto& prng = shaiya::Prng::the();
+    for (auto&& file: files("mobs"))
+    {
+        for (auto&& entry: YAML::LoadFile(file.string())["mobs"])
+        {
+            auto spawn  = entry["spawn"];
+            auto first  = spawn["area"][0];
+            auto second = spawn["area"][1];
+
+            auto minX = std::min(first["x"].as<float>(), second["x"].as<float>());
+            auto maxX = std::max(first["x"].as<float>(), second["x"].as<float>());
+            auto minZ = std::min(first["z"].as<float>(), second["z"].as<float>());
+            auto maxZ = std::max(first["z"].as<float>(), second["z"].as<float>());
+            auto y    = first["y"].as<float>();
+
+            for (auto&& mob: spawn["spawns"])
+            {
+                auto quantity = mob["quantity"].as<int>();
+                for (auto i = 0; i < quantity; i++)
+                    positions.emplace_back(map, prng.random(minX, maxX), y, prng.random(minZ, maxZ));
+            }
+        }
+    }
+    return positions;
+}
+
+/**
+ * Benchmarks a spatial index, by populating it with the spawn positions and querying the neighbourhood of each spawn.
+ * @param name      The name of the index.
+ * @param index     The index.
+ * @param positions The spawn positions.
+ * @param queries   The number of neighbourhood queries to perform.
+ */
+void benchmark(const std::string& name, SpatialIndex& index, const std::vector<Position>& positions, size_t queries)
+{
+    using namespace std::chrono;
+
+    // Populate the index. The benchmark only measures the index, so the cells hold empty entity handles.
+    auto start = steady_clock::now();
+    for (auto&& position: positions)
+        index.add(nullptr, position);
+    auto populated = duration_cast<microseconds>(steady_clock::now() - start).count();
+
+    // Query the neighbourhood of each spawn, in turn
+    size_t visited = 0;
+    start          = steady_clock::now();
+    for (size_t i = 0; i < queries; i++)
+        visited += index.neighbours(positions.at(i % positions.size())).size();
+    auto elapsed = duration_cast<nanoseconds>(steady_clock::now() - start).count();
+
+    auto perQuery = queries ? static_cast<double>(elapsed) / queries : 0.0;
+    auto cells    = queries ? static_cast<double>(visited) / queries : 0.0;
+    std::cout << boost::format("  %-8s %8d cells %10.1f KiB %8d us populate %10.1f ns/query %6.1f cells/query") % name %
+                     index.cellCount() % (index.memoryUsage() / 1024.0) % populated % perQuery % cells
+              << std::endl;
+}
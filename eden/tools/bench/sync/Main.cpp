@@ -0,0 +1,222 @@
+#include <shaiya/common/util/Prng.hpp>
+#include <shaiya/game/model/Position.hpp>
+#include <shaiya/game/model/map/MapCell.hpp>
+#include <shaiya/game/model/map/SpatialQuery.hpp>
+#include <shaiya/game/model/map/index/GridSpatialIndex.hpp>
+
+#include <boost/format.hpp>
+#include <glog/logging.h>
+#include <tbb/global_control.h>
+
+#include <algorithm>
+#include <chrono>
+#include <execution>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <thread>
+
+using namespace shaiya::game;
+
+/**
+ * The size of the benchmarked map, which matches the faction war map.
+ */
+constexpr auto MAP_SIZE = 2048;
+
+/**
+ * The size of a map tile, which matches the default tile size of a map.
+ */
+constexpr auto TILE_SIZE = 512;
+
+/**
+ * The number of battle points that half of the players are gathered around.
+ */
+constexpr auto BATTLE_POINTS = 4;
+
+/**
+ * The distance from a battle point that its players are spread over.
+ */
+constexpr auto BATTLE_RADIUS = 64.0f;
+
+/**
+ * Generates the positions of the players, with half of them gathered around the battle points and the rest spread
+ * over the whole map.
+ * @param count The number of players.
+ * @return      The player positions.
+ */
+std::vector<Position> generatePlayers(size_t count);
+
+/**
+ * Synchronizes a player, by querying the cells around it for the entities that are inside its viewport.
+ * @param index     The spatial index.
+ * @param position  The position of the player.
+ * @return          The number of visible entities.
+ */
+size_t syncPlayer(const SpatialIndex& index, const Position& position);
+
+/**
+ * Benchmarks a schedule, by running it for a number of ticks.
+ * @param name      The name of the schedule.
+ * @param ticks     The number of ticks.
+ * @param tick      The function that runs a single tick.
+ * @return          The average duration of a tick, in microseconds.
+ */
+double benchmark(const std::string& name, size_t ticks, const std::function<void()>& tick);
+
+/**
+ * The entry point for the client synchronization benchmark.
+ * @param argc  The number of command-line arguments.
+ * @param argv  The command-line values.
+ * @return      The status code.
+ */
+int main(int argc, char** argv)
+{
+    if (argc < 4)
+    {
+        LOG(ERROR) << "Please provide the number of players, the number of ticks, and at least one thread count.";
+        return 1;
+    }
+
+    auto count = std::stoul(argv[1]);
+    auto ticks = std::stoul(argv[2]);
+
+    // Populate the index with the players. The benchmark only measures the spatial work, so the cells hold empty
+    // entity handles.
+    auto positions = generatePlayers(count);
+    GridSpatialIndex index(MAP_SIZE);
+    for (auto&& position: positions)
+        index.add(nullptr, position);
+
+    // The tile columns, split in the same way as a map without an explicit tile count
+    auto tiles       = std::max<size_t>(1, MAP_SIZE / TILE_SIZE);
+    auto minColumns  = (SpatialIndex::OBSERVABLE_CELL_RADIUS * 2) + 1;
+    auto tileColumns = std::max<size_t>(minColumns, (index.columnCount() + tiles - 1) / tiles);
+
+    std::cout << boost::format("%1% players, %2% ticks, %3% hardware threads") % count % ticks %
+                     std::thread::hardware_concurrency()
+              << std::endl;
+
+    // The number of entities visible to each player, which is kept so the work can't be optimised away
+    std::vector<size_t> visible(count);
+    std::vector<size_t> players(count);
+    for (size_t i = 0; i < count; i++)
+        players[i] = i;
+
+    // Synchronizes every player in a single parallel loop
+    auto flat = [&]() {
+        std::for_each(std::execution::par, players.begin(), players.end(), [&](size_t player) {
+            visible[player] = syncPlayer(index, positions[player]);
+        });
+    };
+
+    // Partitions the players by tile every tick, then synchronizes the tiles and their players in nested parallel loops
+    auto tiled = [&]() {
+        std::map<size_t, std::vector<size_t>> partition;
+        for (auto player: players)
+            partition[std::min(index.column(positions[player]) / tileColumns, tiles - 1)].push_back(player);
+
+        std::vector<std::vector<size_t>> members;
+        members.reserve(partition.size());
+        for (auto&& [tile, tilePlayers]: partition)
+        {
+            std::sort(tilePlayers.begin(), tilePlayers.end());
+            members.push_back(std::move(tilePlayers));
+        }
+
+        std::for_each(std::execution::par, members.begin(), members.end(), [&](const std::vector<size_t>& tile) {
+            std::for_each(std::execution::par, tile.begin(), tile.end(), [&](size_t player) {
+                visible[player] = syncPlayer(index, positions[player]);
+            });
+        });
+    };
+
+    for (auto i = 3; i < argc; i++)
+    {
+        auto threads = std::stoul(argv[i]);
+        tbb::global_control control(tbb::global_control::max_allowed_parallelism, threads);
+
+        std::cout << boost::format("%1% threads") % threads << std::endl;
+        auto flatTime  = benchmark("flat", ticks, flat);
+        auto tiledTime = benchmark("tiled", ticks, tiled);
+        std::cout << boost::format("  %-8s %10.2fx") % "tiled" % (flatTime ? tiledTime / flatTime : 0.0) << std::endl;
+    }
+
+    size_t total = 0;
+    for (auto entities: visible)
+        total += entities;
+    std::cout << boost::format("%1% entities visible per tick") % total << std::endl;
+    return 0;
+}
+
+/**
+ * Generates the positions of the players, with half of them gathered around the battle points and the rest spread
+ * over the whole map.
+ * @param count The number of players.
+ * @return      The player positions.
+ */
+std::vector<Position> generatePlayers(size_t count)
+{
+    auto& prng = shaiya::Prng::the();
+    std::vector<Position> positions;
+    positions.reserve(count);
+
+    // The battle points are spread along the diagonal of the map, so they fall in different tiles
+    std::vector<std::pair<float, float>> points;
+    for (auto i = 0; i < BATTLE_POINTS; i++)
+    {
+        auto offset = (MAP_SIZE / BATTLE_POINTS) * (i + 0.5f);
+        points.emplace_back(offset, offset);
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (i % 2 == 0)
+        {
+            auto [x, z] = points.at((i / 2) % points.size());
+            positions.emplace_back(0, prng.random(x - BATTLE_RADIUS, x + BATTLE_RADIUS), 0,
+                                   prng.random(z - BATTLE_RADIUS, z + BATTLE_RADIUS));
+            continue;
+        }
+        positions.emplace_back(0, prng.random(0.0f, MAP_SIZE - 1.0f), 0, prng.random(0.0f, MAP_SIZE - 1.0f));
+    }
+    return positions;
+}
+
+/**
+ * Synchronizes a player, by querying the cells around it for the entities that are inside its viewport.
+ * @param index     The spatial index.
+ * @param position  The position of the player.
+ * @return          The number of visible entities.
+ */
+size_t syncPlayer(const SpatialIndex& index, const Position& position)
+{
+    // The visible entities, reused between the players that are synchronized on the same thread
+    static thread_local std::vector<std::shared_ptr<Entity>> visible;
+    visible.clear();
+
+    auto viewport = SpatialQuery::viewport(position);
+    for (auto&& cell: index.neighbours(position))
+        cell->query(viewport, visible);
+    return visible.size();
+}
+
+/**
+ * Benchmarks a schedule, by running it for a number of ticks.
+ * @param name      The name of the schedule.
+ * @param ticks     The number of ticks.
+ * @param tick      The function that runs a single tick.
+ * @return          The average duration of a tick, in microseconds.
+ */
+double benchmark(const std::string& name, size_t ticks, const std::function<void()>& tick)
+{
+    using namespace std::chrono;
+
+    auto start = steady_clock::now();
+    for (size_t i = 0; i < ticks; i++)
+        tick();
+    auto elapsed = duration_cast<microseconds>(steady_clock::now() - start).count();
+
+    auto perTick = ticks ? static_cast<double>(elapsed) / ticks : 0.0;
+    std::cout << boost::format("  %-8s %10.1f us/tick") % name % perTick << std::endl;
+    return perTick;
+}